@@ -6,7 +6,18 @@
 #include <fstream>
 #include <iostream>
 #include <sstream>
-#include <map>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include "Histogram.h"
+#include "MappedFile.h"
 
 using namespace std;
 
@@ -23,8 +34,9 @@ double extractValue(const string& line, const string& keyword) {
 }
 
 // Helper function to save results to a file
-void saveResults(int serverId, double avgDelay, double avgWaiting, double avgQueueLength) {
-    ofstream resultsFile("analyzer_results.txt", ios::app);
+void saveResults(int serverId, double avgDelay, double avgWaiting, double avgQueueLength,
+                 const string& resultsPath = "analyzer_results.txt") {
+    ofstream resultsFile(resultsPath, ios::app);
     if (!resultsFile.is_open()) {
         cerr << "Failed to open log file!" << endl;
         return;
@@ -37,105 +49,274 @@ void saveResults(int serverId, double avgDelay, double avgWaiting, double avgQue
     resultsFile.close();
 }
 
-inline void analyzer(vector<string> serverLogFiles, string taskGeneratorLogFile) {
-    int serverId = 0;
+// Same line followed by the p50, p99 and p99.9 of the delay, waiting and service time histograms
+void saveResults(int serverId, double avgDelay, double avgWaiting, double avgQueueLength,
+                 const LatencyHistogram& delay, const LatencyHistogram& waiting, const LatencyHistogram& service,
+                 const string& resultsPath = "analyzer_results.txt") {
+    ofstream resultsFile(resultsPath, ios::app);
+    if (!resultsFile.is_open()) {
+        cerr << "Failed to open log file!" << endl;
+        return;
+    }
+    resultsFile << "Server ID: " << serverId
+                << ", Average Delay time: " << avgDelay
+                << ", Average Waiting time: " << avgWaiting
+                << ", Average Queue length: " << avgQueueLength;
+    const pair<const char*, const LatencyHistogram*> histograms[] = {{"Delay", &delay}, {"Waiting", &waiting}, {"Service", &service}};
+    for (const auto& [name, histogram] : histograms) {
+        resultsFile << ", " << name << " p50: " << histogram->percentile(50)
+                    << ", " << name << " p99: " << histogram->percentile(99)
+                    << ", " << name << " p99.9: " << histogram->percentile(99.9);
+    }
+    resultsFile << "\n";
+    resultsFile.close();
+}
+
+// One task class across every server: "Class: name" instead of "Server ID", then completed tasks and missed
+// deadlines, then the same fields as saveResults
+void saveClassResults(const string& className, long long completed, long long missedDeadlines, double avgDelay,
+                      double avgWaiting, double avgQueueLength, const LatencyHistogram& delay, const LatencyHistogram& waiting,
+                      const LatencyHistogram& service, const string& resultsPath = "analyzer_results.txt") {
+    ofstream resultsFile(resultsPath, ios::app);
+    if (!resultsFile.is_open()) {
+        cerr << "Failed to open log file!" << endl;
+        return;
+    }
+    resultsFile << "Class: " << className
+                << ", Completed: " << completed
+                << ", Missed deadlines: " << missedDeadlines
+                << ", Average Delay time: " << avgDelay
+                << ", Average Waiting time: " << avgWaiting
+                << ", Average Queue length: " << avgQueueLength;
+    const pair<const char*, const LatencyHistogram*> histograms[] = {{"Delay", &delay}, {"Waiting", &waiting}, {"Service", &service}};
+    for (const auto& [name, histogram] : histograms) {
+        resultsFile << ", " << name << " p50: " << histogram->percentile(50)
+                    << ", " << name << " p99: " << histogram->percentile(99)
+                    << ", " << name << " p99.9: " << histogram->percentile(99.9);
+    }
+    resultsFile << "\n";
+    resultsFile.close();
+}
+
+// Parse the number that follows keyword in line (skipping spaces), like extractValue without the copies
+template <typename T>
+inline bool parseAfter(string_view line, string_view keyword, T& value) {
+    size_t pos = line.find(keyword);
+    if (pos == string_view::npos) return false;
+    const char* first = line.data() + pos + keyword.size();
+    const char* last = line.data() + line.size();
+    while (first < last && (*first == ' ' || *first == '\t')) ++first;
+    return from_chars(first, last, value).ec == errc();
+}
+
+// Split text into about `parts` chunks that end on line boundaries
+inline vector<string_view> splitLines(string_view text, size_t parts) {
+    vector<string_view> chunks;
+    size_t begin = 0;
+    size_t target = max<size_t>(1, text.size() / max<size_t>(1, parts));
+    while (begin < text.size()) {
+        size_t end = min(text.size(), begin + target);
+        size_t newline = text.find('\n', end);
+        end = (newline == string_view::npos) ? text.size() : newline + 1;
+        chunks.push_back(text.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Call handler for every line (without the newline); memchr does the scanning
+template <typename Handler>
+inline void forEachLine(string_view text, Handler handler) {
+    const char* cursor = text.data();
+    const char* last = cursor + text.size();
+    while (cursor < last) {
+        const char* newline = static_cast<const char*>(memchr(cursor, '\n', last - cursor));
+        const char* lineEnd = newline ? newline : last;
+        string_view line(cursor, lineEnd - cursor);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        handler(line);
+        cursor = lineEnd + 1;
+    }
+}
+
+// Run jobs 0..count-1 on up to `workers` threads
+template <typename Job>
+inline void parallelFor(size_t count, size_t workers, Job job) {
+    workers = min(count, max<size_t>(1, workers));
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        for (size_t i = next++; i < count; i = next++) job(i);
+    };
+    vector<thread> threads;
+    for (size_t t = 1; t < workers; ++t) threads.emplace_back(worker);
+    worker();
+    for (auto& t : threads) t.join();
+}
+
+// Run jobs 0..count-1 on all hardware threads
+template <typename Job>
+inline void parallelFor(size_t count, Job job) {
+    parallelFor(count, max(1u, thread::hardware_concurrency()), job);
+}
+
+struct ServerLogStats {
+    double totalDelay = 0.0;
+    int taskCount = 0;
+    double avgWaiting = 0.0;
+    bool hasWaiting = false;
+    double avgQueueLength = 0.0;
+    bool hasQueueLength = false;
+    LatencyHistogram delay;
+    LatencyHistogram waiting;
+    vector<pair<int, double>> starts;    // Task ID, service start time
+    vector<pair<int, double>> finishes;  // Task ID, finish time
+    vector<pair<int, double>> pauses;    // Task ID, -suspend time or +resume time; a task's sum is its time suspended
+};
+
+inline void analyzer(vector<string> serverLogFiles, string taskGeneratorLogFile,
+                     const string& resultsPath = "analyzer_results.txt") {
+    const size_t chunksPerFile = max(1u, thread::hardware_concurrency());
 
-    // Map to store task generation times from TaskGeneratorLogFile
-    map<int, double> taskGenTimes;
-    
-    // Read Task Generator Log to populate taskGenTimes
-    ifstream generatorLog(taskGeneratorLogFile);
-    if (!generatorLog.is_open()) {
+    MappedFile generatorLog(taskGeneratorLogFile);
+    if (!generatorLog.isOpen()) {
         cerr << "Failed to open Task Generator Log: " << taskGeneratorLogFile << endl;
         return;
     }
 
-    string line;
-    while (getline(generatorLog, line)) {
-        if (line.find("Task ID:") != string::npos && line.find("Time:") != string::npos) {
+    // Parse the generator log in parallel chunks, then scatter into a dense Task ID -> generation time table
+    vector<string_view> generatorChunks = splitLines(generatorLog.view(), chunksPerFile);
+    vector<vector<pair<int, double>>> generated(generatorChunks.size());
+    parallelFor(generatorChunks.size(), [&](size_t c) {
+        forEachLine(generatorChunks[c], [&](string_view line) {
             int taskId;
             double genTime;
-            size_t timePos = line.find("Time: ");
-            size_t idPos = line.find("Task ID: ");
-            
-            // Extract Task Generation Time
-            if (timePos != string::npos) {
-                stringstream ss(line.substr(timePos + 6));
-                ss >> genTime;
+            if (parseAfter(line, "Time: ", genTime) && parseAfter(line, "Task ID: ", taskId) && taskId >= 0) {
+                generated[c].emplace_back(taskId, genTime);
             }
+        });
+    });
 
-            // Extract Task ID
-            if (idPos != string::npos) {
-                stringstream ss(line.substr(idPos + 8));
-                ss >> taskId;
-            }
-
-            taskGenTimes[taskId] = genTime;  // Store Task ID and Generation Time
-        }
+    int maxTaskId = -1;
+    for (const auto& chunk : generated) {
+        for (const auto& entry : chunk) maxTaskId = max(maxTaskId, entry.first);
+    }
+    const double missing = numeric_limits<double>::quiet_NaN();
+    vector<double> taskGenTimes(maxTaskId + 1, missing);
+    for (const auto& chunk : generated) {
+        for (const auto& [taskId, genTime] : chunk) taskGenTimes[taskId] = genTime;  // Later lines win, like the map
     }
-    generatorLog.close();
 
-    // Process each server log file
+    // Map every server log, then analyze all chunks of all files in parallel
+    vector<unique_ptr<MappedFile>> serverLogs;
     for (const auto& file : serverLogFiles) {
-        ifstream serverLogFile(file);
-        if (!serverLogFile.is_open()) {
+        auto mapped = make_unique<MappedFile>(file);
+        if (!mapped->isOpen()) {
             cerr << "Failed to open server log file: " << file << endl;
             continue;
         }
+        serverLogs.push_back(std::move(mapped));
+    }
+
+    struct Job {
+        size_t server;
+        string_view text;
+    };
+    vector<Job> jobs;
+    for (size_t s = 0; s < serverLogs.size(); ++s) {
+        for (string_view chunk : splitLines(serverLogs[s]->view(), chunksPerFile)) {
+            jobs.push_back(Job{s, chunk});
+        }
+    }
 
-        double totalDelay = 0.0;
-        int taskCount = 0;
-        double avgWaiting = 0.0;
-        int avgQueueLength = 0;
+    vector<ServerLogStats> jobStats(jobs.size());
+    parallelFor(jobs.size(), [&](size_t j) {
+        ServerLogStats& stats = jobStats[j];
+        forEachLine(jobs[j].text, [&](string_view line) {
+            if (parseAfter(line, "Average Waiting Time:", stats.avgWaiting)) stats.hasWaiting = true;
+            if (parseAfter(line, "Average Queue Length:", stats.avgQueueLength)) stats.hasQueueLength = true;
 
-        // Read and analyze the server log
-        while (getline(serverLogFile, line)) {
-            // Extract Average Waiting Time
-            if (line.find("Average Waiting Time") != string::npos) {
-                avgWaiting = extractValue(line, "Average Waiting Time:");
+            if (line.find("is processing task") != string_view::npos) {
+                int taskId;
+                double waited, startTime;
+                if (parseAfter(line, "waited: ", waited)) stats.waiting.record(waited);
+                if (parseAfter(line, "processing task ", taskId) && parseAfter(line, "at time: ", startTime)) {
+                    stats.starts.emplace_back(taskId, startTime);
+                }
             }
 
-            // Extract Average Queue Length
-            if (line.find("Average Queue Length") != string::npos) {
-                avgQueueLength = static_cast<int>(extractValue(line, "Average Queue Length:"));
+            // ShortestRemainingTime: a suspended task is out of service until it resumes
+            int pausedId;
+            double pauseTime;
+            if (parseAfter(line, "suspended task ", pausedId) && parseAfter(line, "at time: ", pauseTime)) {
+                stats.pauses.emplace_back(pausedId, -pauseTime);
+            } else if (parseAfter(line, "resumed task ", pausedId) && parseAfter(line, "at time: ", pauseTime)) {
+                stats.pauses.emplace_back(pausedId, pauseTime);
             }
 
-            // Match Task ID and Calculate Delay
-            if (line.find("Task ID:") != string::npos && line.find("Task Finished Time") != string::npos) {
+            if (line.find("Task Finished Time") != string_view::npos) {
                 int taskId;
                 double finishTime;
-                size_t timePos = line.find("Time: ");
-                size_t idPos = line.find("Task ID: ");
-                
-                // Extract Finished Time
-                if (timePos != string::npos) {
-                    stringstream ss(line.substr(timePos + 6));
-                    ss >> finishTime;
+                if (parseAfter(line, "Time: ", finishTime) && parseAfter(line, "Task ID: ", taskId) &&
+                    taskId >= 0 && taskId <= maxTaskId && !std::isnan(taskGenTimes[taskId])) {
+                    stats.totalDelay += finishTime - taskGenTimes[taskId];
+                    stats.taskCount++;
+                    stats.delay.record(finishTime - taskGenTimes[taskId]);
                 }
-
-                // Extract Task ID
-                if (idPos != string::npos) {
-                    stringstream ss(line.substr(idPos + 8));
-                    ss >> taskId;
-                }
-
-                // Calculate delay if task ID exists in generator log
-                if (taskGenTimes.find(taskId) != taskGenTimes.end()) {
-                    double startTime = taskGenTimes[taskId];
-                    totalDelay += (finishTime - startTime);
-                    taskCount++;
+                if (parseAfter(line, "Time: ", finishTime) && parseAfter(line, "Task ID: ", taskId) && taskId >= 0) {
+                    stats.finishes.emplace_back(taskId, finishTime);
                 }
             }
-        }
+        });
+    });
 
-        serverLogFile.close();
+    // Merge chunks in file order; the last reported average in a file wins
+    vector<ServerLogStats> servers(serverLogs.size());
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        ServerLogStats& server = servers[jobs[j].server];
+        const ServerLogStats& chunk = jobStats[j];
+        server.totalDelay += chunk.totalDelay;
+        server.taskCount += chunk.taskCount;
+        if (chunk.hasWaiting) server.avgWaiting = chunk.avgWaiting;
+        if (chunk.hasQueueLength) server.avgQueueLength = chunk.avgQueueLength;
+        server.delay.merge(chunk.delay);
+        server.waiting.merge(chunk.waiting);
+    }
 
-        // Calculate average delay
-        double avgDelay = (taskCount > 0) ? (totalDelay / taskCount) : 0.0;
+    // Service time = finish - start - time suspended; a task's lines may sit in different chunks, so join by
+    // (server, Task ID). A hedged copy keeps its task's ID, so the same ID can start on two servers.
+    vector<vector<double>> startTimes(servers.size());  // Server -> Task ID -> service start time
+    vector<vector<double>> suspended(servers.size());   // Server -> Task ID -> time out of service after it started
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        vector<double>& serverStarts = startTimes[jobs[j].server];
+        for (const auto& [taskId, startTime] : jobStats[j].starts) {
+            if (taskId < 0) continue;
+            if (static_cast<size_t>(taskId) >= serverStarts.size()) serverStarts.resize(taskId + 1, missing);
+            serverStarts[taskId] = startTime;
+        }
+        vector<double>& serverSuspended = suspended[jobs[j].server];
+        for (const auto& [taskId, time] : jobStats[j].pauses) {
+            if (taskId < 0) continue;
+            if (static_cast<size_t>(taskId) >= serverSuspended.size()) serverSuspended.resize(taskId + 1, 0.0);
+            serverSuspended[taskId] += time;
+        }
+    }
+    vector<LatencyHistogram> service(servers.size());
+    for (size_t j = 0; j < jobs.size(); ++j) {
+        const vector<double>& serverStarts = startTimes[jobs[j].server];
+        const vector<double>& serverSuspended = suspended[jobs[j].server];
+        for (const auto& [taskId, finishTime] : jobStats[j].finishes) {
+            if (static_cast<size_t>(taskId) < serverStarts.size() && !std::isnan(serverStarts[taskId])) {
+                double pausedTime = static_cast<size_t>(taskId) < serverSuspended.size() ? serverSuspended[taskId] : 0.0;
+                service[jobs[j].server].record(finishTime - serverStarts[taskId] - pausedTime);
+            }
+        }
+    }
 
-        // Save results
-        saveResults(serverId, avgDelay, avgWaiting, avgQueueLength);
-        serverId++;
+    for (size_t serverId = 0; serverId < servers.size(); ++serverId) {
+        const ServerLogStats& stats = servers[serverId];
+        double avgDelay = (stats.taskCount > 0) ? (stats.totalDelay / stats.taskCount) : 0.0;
+        saveResults(static_cast<int>(serverId), avgDelay, stats.avgWaiting, static_cast<int>(stats.avgQueueLength),
+                    stats.delay, stats.waiting, service[serverId], resultsPath);
     }
 }
 
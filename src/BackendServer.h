@@ -0,0 +1,282 @@
+#ifndef BACKEND_SERVER_H
+#define BACKEND_SERVER_H
+
+#if defined(__linux__)
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <chrono>
+#include <unordered_map>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+
+// Real TCP stand-in for a ServerQueue, to put behind TcpProxy (Linux only).
+// The protocol is line based: every line a client sends is one task, answered with the same line once
+// served, or with "BUSY" when the queue is full. A task takes an exponential service time with mean
+// averageServiceTime / processingPower simulated seconds, slept in real time as that times timeScale.
+// `cores` threads serve tasks; up to queueSize more wait. Clients should keep one task in flight per
+// connection: tasks of one connection may be served by different cores and answered out of order.
+
+struct BackendParameters {
+    double processingPower = 15.0;
+    int queueSize = 10;
+    int cores = 1;
+    double averageServiceTime = 40.0;  // Simulated seconds at power 1, as TaskGenerator draws them
+    double timeScale = 0.001;          // Real seconds per simulated second
+    unsigned seed = std::random_device{}();
+};
+
+class BackendServer {
+public:
+    explicit BackendServer(const BackendParameters& parameters)
+        : parameters(parameters), rng(parameters.seed),
+          serviceTime(1.0 / std::max(parameters.averageServiceTime, 1e-9)) {}
+
+    ~BackendServer() {
+        stop();
+    }
+
+    BackendServer(const BackendServer&) = delete;
+    BackendServer& operator=(const BackendServer&) = delete;
+
+    // Listen on port (0 picks a free one, see getPort); false when the socket cannot be set up
+    bool start(uint16_t port, const std::string& bindAddress = "127.0.0.1") {
+        epoll = epoll_create1(EPOLL_CLOEXEC);
+        wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (epoll < 0 || wake < 0 || listener < 0) return false;
+        int on = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1 ||
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(listener, SOMAXCONN) != 0) {
+            return false;
+        }
+        socklen_t length = sizeof(address);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+        listenPort = ntohs(address.sin_port);
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = listener;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event);
+        event.data.fd = wake;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, wake, &event);
+        running = true;
+        ioThread = std::thread([this]() { runIo(); });
+        for (int i = 0; i < std::max(1, parameters.cores); ++i) {
+            coreThreads.emplace_back([this]() { runCore(); });
+        }
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        uint64_t one = 1;
+        (void)!write(wake, &one, sizeof(one));
+        queueReady.notify_all();
+        if (ioThread.joinable()) ioThread.join();
+        for (auto& core : coreThreads) core.join();
+        coreThreads.clear();
+        for (auto& entry : clients) {
+            std::lock_guard<std::mutex> lock(entry.second->mutex);
+            closeClient(*entry.second);
+        }
+        clients.clear();
+        for (Task& task : queue) {
+            std::lock_guard<std::mutex> lock(task.client->mutex);
+            closeClient(*task.client);  // Disconnected clients still waiting for a core
+        }
+        queue.clear();
+        for (int fd : {listener, wake, epoll}) {
+            if (fd >= 0) close(fd);
+        }
+        listener = wake = epoll = -1;
+    }
+
+    uint16_t getPort() const {
+        return listenPort;
+    }
+
+    long long getServed() const {
+        return served.load();
+    }
+
+    long long getRejected() const {
+        return rejected.load();
+    }
+
+private:
+    struct Client {
+        int fd = -1;
+        std::mutex mutex;     // Guards fd, writes and the fields below
+        int pending = 0;      // Tasks queued or in service
+        bool closed = false;  // Peer is gone; the last task to finish closes fd
+        std::string partial;  // Bytes of an unfinished line (IO thread only)
+    };
+
+    struct Task {
+        std::shared_ptr<Client> client;
+        std::string line;
+        double delay;  // Real seconds
+    };
+
+    BackendParameters parameters;
+    std::mt19937 rng;  // IO thread only
+    std::exponential_distribution<double> serviceTime;
+    int epoll = -1;
+    int wake = -1;
+    int listener = -1;
+    uint16_t listenPort = 0;
+    std::atomic<bool> running{false};
+    std::thread ioThread;
+    std::vector<std::thread> coreThreads;
+    std::unordered_map<int, std::shared_ptr<Client>> clients;  // IO thread only
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<Task> queue;
+    std::atomic<long long> served{0};
+    std::atomic<long long> rejected{0};
+
+    void runIo() {
+        epoll_event events[64];
+        while (running.load()) {
+            int count = epoll_wait(epoll, events, 64, -1);
+            for (int i = 0; i < count; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake) continue;
+                if (fd == listener) {
+                    acceptAll();
+                    continue;
+                }
+                auto found = clients.find(fd);
+                if (found != clients.end()) readClient(std::shared_ptr<Client>(found->second));  // Outlives its map entry
+            }
+        }
+    }
+
+    void acceptAll() {
+        int fd;
+        while ((fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            auto client = std::make_shared<Client>();
+            client->fd = fd;
+            clients[fd] = client;
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event);
+        }
+    }
+
+    void readClient(std::shared_ptr<Client> client) {
+        char buffer[16384];
+        while (true) {
+            ssize_t received = recv(client->fd, buffer, sizeof(buffer), 0);
+            if (received < 0 && errno == EAGAIN) return;
+            if (received <= 0) {
+                disconnect(client);
+                return;
+            }
+            client->partial.append(buffer, static_cast<size_t>(received));
+            size_t start = 0, newline;
+            while ((newline = client->partial.find('\n', start)) != std::string::npos) {
+                submit(client, client->partial.substr(start, newline - start));
+                start = newline + 1;
+            }
+            client->partial.erase(0, start);
+        }
+    }
+
+    void submit(const std::shared_ptr<Client>& client, std::string line) {
+        double delay = serviceTime(rng) / parameters.processingPower * parameters.timeScale;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (static_cast<int>(queue.size()) < parameters.queueSize) {
+                {
+                    std::lock_guard<std::mutex> clientLock(client->mutex);
+                    ++client->pending;
+                }
+                queue.push_back({client, std::move(line), delay});
+                queueReady.notify_one();
+                return;
+            }
+        }
+        ++rejected;
+        std::lock_guard<std::mutex> lock(client->mutex);
+        sendAll(*client, "BUSY\n");
+    }
+
+    void runCore() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueReady.wait(lock, [this]() { return !queue.empty() || !running.load(); });
+                if (!running.load()) return;
+                task = std::move(queue.front());
+                queue.pop_front();
+            }
+            std::this_thread::sleep_for(std::chrono::duration<double>(task.delay));
+            ++served;
+            std::lock_guard<std::mutex> lock(task.client->mutex);
+            task.line += '\n';
+            sendAll(*task.client, task.line);
+            if (--task.client->pending == 0 && task.client->closed) closeClient(*task.client);
+        }
+    }
+
+    // Caller holds client.mutex
+    static void sendAll(Client& client, const std::string& data) {
+        size_t sent = 0;
+        while (!client.closed && sent < data.size()) {
+            ssize_t written = send(client.fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (written > 0) {
+                sent += static_cast<size_t>(written);
+            } else if (written < 0 && errno == EAGAIN) {
+                pollfd wait{client.fd, POLLOUT, 0};
+                if (poll(&wait, 1, 1000) <= 0) return;  // Client stopped reading: drop the answer
+            } else {
+                return;
+            }
+        }
+    }
+
+    // Caller holds client.mutex
+    static void closeClient(Client& client) {
+        if (client.fd >= 0) close(client.fd);
+        client.fd = -1;
+        client.closed = true;
+    }
+
+    // The fd stays open while tasks of this client are queued, so it cannot be reused under them
+    void disconnect(const std::shared_ptr<Client>& client) {
+        clients.erase(client->fd);
+        std::lock_guard<std::mutex> lock(client->mutex);
+        epoll_ctl(epoll, EPOLL_CTL_DEL, client->fd, nullptr);
+        client->closed = true;
+        if (client->pending == 0) closeClient(*client);
+    }
+};
+
+#endif // __linux__
+
+#endif // BACKEND_SERVER_H
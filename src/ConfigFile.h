@@ -0,0 +1,437 @@
+#ifndef CONFIG_FILE_H
+#define CONFIG_FILE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cmath>
+#include <cerrno>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+#include "Simulation.h"
+
+// Reads a SimulationConfig from an INI-style file and "key=value" command-line overrides.
+//
+//   # comment
+//   [simulation]
+//   simulationDuration = 7200
+//   [pool]            ; one section per group of identical servers, repeatable
+//   count = 2
+//   power = 30
+//   [class]           ; one section per task class, repeatable
+//   name = interactive
+//   share = 0.9
+//
+// Sections group the keys but every key outside [pool] and [class] has one home section, so an override
+// only needs the key name. Problems are collected, not thrown, so one pass reports all of them.
+class ConfigLoader {
+public:
+    explicit ConfigLoader(SimulationConfig& target) : config(target) {}
+
+    bool loadFile(const std::string& path) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            errors.push_back(path + ": cannot open config file");
+            return false;
+        }
+        std::string line, section;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            std::string where = path + ":" + std::to_string(lineNumber);
+            size_t comment = line.find_first_of("#;");
+            if (comment != std::string::npos) line.erase(comment);
+            line = trim(line);
+            if (line.empty()) continue;
+
+            if (line.front() == '[') {
+                if (line.back() != ']') {
+                    errors.push_back(where + ": missing ']' in section header");
+                    continue;
+                }
+                section = trim(line.substr(1, line.size() - 2));
+                if (section == "pool") {
+                    config.serverPools.push_back(ServerPool{});
+                } else if (section == "class") {
+                    config.taskClasses.push_back(TaskClass{"class" + std::to_string(config.taskClasses.size())});
+                } else if (!isSection(section)) {
+                    errors.push_back(where + ": unknown section [" + section + "]");
+                }
+                continue;
+            }
+            size_t equals = line.find('=');
+            if (equals == std::string::npos) {
+                errors.push_back(where + ": expected key = value");
+                continue;
+            }
+            setOption(where, section, trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+        }
+        return true;
+    }
+
+    // "key=value"; pool and class keys are not accepted here, they live in the config file
+    void applyOverride(const std::string& argument) {
+        std::string where = "command line '" + argument + "'";
+        size_t equals = argument.find('=');
+        if (equals == std::string::npos) {
+            errors.push_back(where + ": expected key=value");
+            return;
+        }
+        std::string key = trim(argument.substr(0, equals));
+        const char* section = homeSection(key);
+        if (!section) {
+            errors.push_back(where + ": unknown key '" + key + "'");
+            return;
+        }
+        setOption(where, section, key, trim(argument.substr(equals + 1)));
+    }
+
+    // Range checks that need the whole config
+    void validate() {
+        const std::string where = "config";
+        if (config.speed <= 0.0) errors.push_back(where + ": speed must be > 0");
+        if (config.averageServiceTime <= 0.0) errors.push_back(where + ": averageServiceTime must be > 0");
+        if (config.interArrivalTime <= 0.0) errors.push_back(where + ": interArrivalTime must be > 0");
+        if (config.simulationDuration <= 0.0) errors.push_back(where + ": simulationDuration must be > 0");
+        if (config.tick.count() <= 0) errors.push_back(where + ": tick must be at least 1 microsecond");
+        if (config.deterministic && config.seed == 0) errors.push_back(where + ": deterministic needs a non-zero seed");
+        if (config.deterministic && !config.virtualTime) {
+            errors.push_back(where + ": deterministic needs virtualTime (real-time runs depend on thread scheduling)");
+        }
+        if (config.utilizationThreshold < 0.0 || config.utilizationThreshold > 1.0) {
+            errors.push_back(where + ": utilizationThreshold must be between 0 and 1");
+        }
+        if (config.maxBacklogWait < 0.0) errors.push_back(where + ": maxBacklogWait must be >= 0");
+        if (config.burstFactor <= 0.0) errors.push_back(where + ": burstFactor must be > 0");
+        if (config.burstDuration <= 0.0 || config.normalDuration <= 0.0) {
+            errors.push_back(where + ": burstDuration and normalDuration must be > 0");
+        }
+        if (config.diurnalPeriod <= 0.0) errors.push_back(where + ": diurnalPeriod must be > 0");
+        bool anyTraffic = false;
+        for (const auto& [time, multiplier] : config.diurnalProfile) {
+            if (time < 0.0 || time >= config.diurnalPeriod) {
+                errors.push_back(where + ": diurnalProfile time " + formatNumber(time) + " is outside [0, diurnalPeriod)");
+            }
+            anyTraffic = anyTraffic || multiplier > 0.0;
+        }
+        if (config.arrivalProcess == ArrivalProcessType::Diurnal && !anyTraffic) {
+            errors.push_back(where + ": diurnalProfile needs at least one rate multiplier above 0");
+        }
+        if (config.paretoShape <= 1.0) errors.push_back(where + ": paretoShape must be > 1 (the mean is infinite otherwise)");
+        if (config.logNormalSigma <= 0.0) errors.push_back(where + ": logNormalSigma must be > 0");
+        if (config.replayTimeScale <= 0.0) errors.push_back(where + ": replayTimeScale must be > 0");
+        if (!config.replayFile.empty()) checkReplayFile(where);
+        if (config.serverPools.empty()) {
+            if (config.numberOfServers < 1) errors.push_back(where + ": numberOfServers must be >= 1");
+            if (config.coresPerServer < 1) errors.push_back(where + ": coresPerServer must be >= 1");
+        }
+        if (config.serverThreads < 0) errors.push_back(where + ": serverThreads must be >= 0");
+        if (config.partitions < 0) errors.push_back(where + ": partitions must be >= 0");
+        if (config.partitions > 0) {
+            if (!config.virtualTime) errors.push_back(where + ": partitions needs virtualTime");
+            if (config.workStealing) errors.push_back(where + ": partitions cannot be combined with workStealing");
+            if (config.reportDelay <= 0.0) errors.push_back(where + ": reportDelay must be > 0");
+        }
+        if (config.hedging != HedgingPolicy::None) {
+            if (!config.virtualTime) errors.push_back(where + ": hedging needs virtualTime");
+            if (config.partitions > 0) errors.push_back(where + ": hedging cannot be combined with partitions");
+            if (config.workStealing) errors.push_back(where + ": hedging cannot be combined with workStealing");
+        }
+        if (config.hedgeDelay < 0.0) errors.push_back(where + ": hedgeDelay must be >= 0");
+        if (config.keySkew < 0.0) errors.push_back(where + ": keySkew must be >= 0");
+        if (config.loadBound != 0.0 && config.loadBound < 1.0) errors.push_back(where + ": loadBound must be 0 (off) or >= 1");
+        if (config.scheduling != SchedulingDiscipline::Fifo && !config.virtualTime) {
+            errors.push_back(where + ": scheduling other than Fifo needs virtualTime");
+        }
+        if (config.taskClasses.size() > 255) errors.push_back(where + ": at most 255 [class] sections");
+        for (size_t i = 0; i < config.taskClasses.size(); ++i) {
+            const TaskClass& taskClass = config.taskClasses[i];
+            std::string name = "[class] " + taskClass.name;
+            if (taskClass.share <= 0.0) errors.push_back(name + ": share must be > 0");
+            if (taskClass.serviceScale <= 0.0) errors.push_back(name + ": serviceScale must be > 0");
+            if (taskClass.priority < 0 || taskClass.priority >= TaskScheduler<int>::PriorityLevels) {
+                errors.push_back(name + ": priority must be between 0 and " + std::to_string(TaskScheduler<int>::PriorityLevels - 1));
+            }
+            if (taskClass.deadline < 0.0) errors.push_back(name + ": deadline must be >= 0");
+        }
+        for (size_t i = 0; i < config.serverPools.size(); ++i) {
+            const ServerPool& pool = config.serverPools[i];
+            std::string name = "[pool] " + std::to_string(i + 1);
+            if (pool.count < 1) errors.push_back(name + ": count must be >= 1");
+            if (pool.cores < 1) errors.push_back(name + ": cores must be >= 1");
+            if (pool.queueSize < 1) errors.push_back(name + ": queueSize must be >= 1");
+        }
+        // ServerQueue clamps power to [1, 100] and needs a queue slot; say so instead of silently changing it
+        std::vector<ServerPool> servers = serverList(config);
+        for (size_t i = 0; i < servers.size(); ++i) {
+            std::ostringstream problem;
+            if (servers[i].power < 1.0 || servers[i].power > 100.0) {
+                problem << where << ": server " << i + 1 << " power " << servers[i].power << " is outside [1, 100]";
+            } else if (servers[i].queueSize < 1) {
+                problem << where << ": server " << i + 1 << " queue size " << servers[i].queueSize << " is below 1";
+            } else {
+                continue;
+            }
+            errors.push_back(problem.str());
+            break;
+        }
+    }
+
+    bool ok() const {
+        return errors.empty();
+    }
+
+    const std::vector<std::string>& getErrors() const {
+        return errors;
+    }
+
+private:
+    SimulationConfig& config;
+    std::vector<std::string> errors;
+
+    static std::string trim(const std::string& text) {
+        size_t first = text.find_first_not_of(" \t\r");
+        if (first == std::string::npos) return "";
+        size_t last = text.find_last_not_of(" \t\r");
+        return text.substr(first, last - first + 1);
+    }
+
+    static bool isSection(const std::string& section) {
+        return section == "simulation" || section == "workload" || section == "servers" || section == "loadBalancer";
+    }
+
+    // Section a key belongs to, nullptr when unknown ([pool] and [class] keys are not listed)
+    static const char* homeSection(const std::string& key) {
+        static const std::vector<std::pair<const char*, const char*>> keys = {
+            {"speed", "simulation"}, {"simulationDuration", "simulation"}, {"virtualTime", "simulation"},
+            {"tick", "simulation"}, {"seed", "simulation"}, {"deterministic", "simulation"}, {"outputDir", "simulation"},
+            {"binaryTrace", "simulation"}, {"logAnalyzer", "simulation"}, {"consoleEcho", "simulation"},
+            {"partitions", "simulation"}, {"reportDelay", "simulation"},
+            {"averageServiceTime", "workload"}, {"interArrivalTime", "workload"},
+            {"arrivalProcess", "workload"}, {"burstFactor", "workload"}, {"burstDuration", "workload"},
+            {"normalDuration", "workload"}, {"diurnalPeriod", "workload"}, {"diurnalProfile", "workload"},
+            {"serviceDistribution", "workload"}, {"paretoShape", "workload"}, {"logNormalSigma", "workload"},
+            {"replayFile", "workload"}, {"replayTimeScale", "workload"}, {"replayLoop", "workload"},
+            {"keySpace", "workload"}, {"keySkew", "workload"},
+            {"numberOfServers", "servers"}, {"coresPerServer", "servers"}, {"basePower", "servers"},
+            {"powerStep", "servers"}, {"baseQueueSize", "servers"}, {"queueSizeStep", "servers"},
+            {"workStealing", "servers"}, {"serverThreads", "servers"}, {"scheduling", "servers"},
+            {"routingPolicy", "loadBalancer"}, {"backlogCapacity", "loadBalancer"}, {"overflowPolicy", "loadBalancer"},
+            {"maxBacklogWait", "loadBalancer"}, {"utilizationThreshold", "loadBalancer"},
+            {"hedging", "loadBalancer"}, {"hedgeDelay", "loadBalancer"}, {"loadBound", "loadBalancer"},
+        };
+        for (const auto& [name, section] : keys) {
+            if (key == name) return section;
+        }
+        return nullptr;
+    }
+
+    void setOption(const std::string& where, const std::string& section, const std::string& key, const std::string& value) {
+        if (section == "pool") {
+            setPoolOption(where, key, value);
+            return;
+        }
+        if (section == "class") {
+            setClassOption(where, key, value);
+            return;
+        }
+        const char* home = homeSection(key);
+        if (!home) {
+            errors.push_back(where + ": unknown key '" + key + "'" + (section.empty() ? "" : " in [" + section + "]"));
+            return;
+        }
+        if (section != home) {
+            errors.push_back(where + ": '" + key + "' belongs in [" + home + "]");
+            return;
+        }
+
+        if (key == "outputDir") {
+            config.outputDir = value;
+        } else if (key == "replayFile") {
+            config.replayFile = value;
+        } else if (key == "routingPolicy") {
+            parseChoice(where, key, value, config.routingPolicy, {
+                {"LowestUtilization", RoutingPolicyType::LowestUtilization}, {"RoundRobin", RoutingPolicyType::RoundRobin},
+                {"WeightedRoundRobin", RoutingPolicyType::WeightedRoundRobin},
+                {"JoinShortestQueue", RoutingPolicyType::JoinShortestQueue},
+                {"PowerOfDChoices", RoutingPolicyType::PowerOfDChoices},
+                {"LeastExpectedWork", RoutingPolicyType::LeastExpectedWork}, {"Maglev", RoutingPolicyType::Maglev}});
+        } else if (key == "overflowPolicy") {
+            parseChoice(where, key, value, config.overflowPolicy, {
+                {"RejectNew", OverflowPolicy::RejectNew}, {"DropOldest", OverflowPolicy::DropOldest}});
+        } else if (key == "hedging") {
+            parseChoice(where, key, value, config.hedging, {
+                {"None", HedgingPolicy::None}, {"Delayed", HedgingPolicy::Delayed}, {"Immediate", HedgingPolicy::Immediate}});
+        } else if (key == "scheduling") {
+            parseChoice(where, key, value, config.scheduling, {
+                {"Fifo", SchedulingDiscipline::Fifo}, {"Priority", SchedulingDiscipline::Priority},
+                {"ShortestJobFirst", SchedulingDiscipline::ShortestJobFirst},
+                {"ShortestRemainingTime", SchedulingDiscipline::ShortestRemainingTime},
+                {"EarliestDeadlineFirst", SchedulingDiscipline::EarliestDeadlineFirst}});
+        } else if (key == "arrivalProcess") {
+            parseChoice(where, key, value, config.arrivalProcess, {
+                {"Deterministic", ArrivalProcessType::Deterministic}, {"Poisson", ArrivalProcessType::Poisson},
+                {"MMPP", ArrivalProcessType::MMPP}, {"Diurnal", ArrivalProcessType::Diurnal}});
+        } else if (key == "serviceDistribution") {
+            parseChoice(where, key, value, config.serviceDistribution, {
+                {"Exponential", ServiceDistributionType::Exponential}, {"Deterministic", ServiceDistributionType::Deterministic},
+                {"Pareto", ServiceDistributionType::Pareto}, {"LogNormal", ServiceDistributionType::LogNormal}});
+        } else if (key == "diurnalProfile") {
+            parseProfile(where, value);
+        } else if (key == "virtualTime" || key == "binaryTrace" || key == "logAnalyzer" || key == "consoleEcho" ||
+                   key == "workStealing" || key == "replayLoop" || key == "deterministic") {
+            bool flag;
+            if (!parseBool(value, flag)) {
+                errors.push_back(where + ": " + key + " must be true or false, got '" + value + "'");
+            } else if (key == "consoleEcho") {
+                config.consoleEcho = flag;
+            } else {
+                setConfigValue(config, key, flag ? 1.0 : 0.0);
+            }
+        } else if (key == "tick") {
+            double seconds;
+            if (parseNumber(where, key, value, false, seconds)) {
+                config.tick = std::chrono::microseconds(static_cast<long long>(std::llround(seconds * 1e6)));
+            }
+        } else if (key == "seed") {
+            double seed;
+            if (parseNumber(where, key, value, true, seed)) {
+                if (seed < 0.0 || seed > 4294967295.0) errors.push_back(where + ": seed must be between 0 and 4294967295");
+                else config.seed = static_cast<unsigned>(seed);
+            }
+        } else {
+            bool integer = key == "numberOfServers" || key == "coresPerServer" || key == "baseQueueSize" ||
+                           key == "queueSizeStep" || key == "backlogCapacity" || key == "serverThreads" ||
+                           key == "partitions" || key == "keySpace";
+            double number;
+            if (!parseNumber(where, key, value, integer, number)) return;
+            if ((key == "backlogCapacity" || key == "keySpace") && number < 0.0) {
+                errors.push_back(where + ": " + key + " must be >= 0");
+                return;
+            }
+            setConfigValue(config, key, number);
+        }
+    }
+
+    void setPoolOption(const std::string& where, const std::string& key, const std::string& value) {
+        ServerPool& pool = config.serverPools.back();
+        double number;
+        if (key == "count" || key == "queueSize" || key == "cores") {
+            if (!parseNumber(where, key, value, true, number)) return;
+            int& field = key == "count" ? pool.count : key == "queueSize" ? pool.queueSize : pool.cores;
+            field = static_cast<int>(number);
+        } else if (key == "power") {
+            if (parseNumber(where, key, value, false, number)) pool.power = number;
+        } else {
+            errors.push_back(where + ": unknown key '" + key + "' in [pool] (expected count, power, queueSize, cores)");
+        }
+    }
+
+    void setClassOption(const std::string& where, const std::string& key, const std::string& value) {
+        TaskClass& taskClass = config.taskClasses.back();
+        double number;
+        if (key == "name") {
+            taskClass.name = value;
+        } else if (key == "priority") {
+            if (parseNumber(where, key, value, true, number)) taskClass.priority = static_cast<int>(number);
+        } else if (key == "share" || key == "serviceScale" || key == "deadline") {
+            if (!parseNumber(where, key, value, false, number)) return;
+            double& field = key == "share" ? taskClass.share : key == "serviceScale" ? taskClass.serviceScale : taskClass.deadline;
+            field = number;
+        } else {
+            errors.push_back(where + ": unknown key '" + key + "' in [class] (expected name, share, serviceScale, priority, deadline)");
+        }
+    }
+
+    bool parseNumber(const std::string& where, const std::string& key, const std::string& value, bool integer, double& number) {
+        const char* text = value.c_str();
+        char* end = nullptr;
+        errno = 0;
+        number = std::strtod(text, &end);
+        if (value.empty() || end != text + value.size() || errno == ERANGE || !std::isfinite(number)) {
+            errors.push_back(where + ": " + key + " must be a number, got '" + value + "'");
+            return false;
+        }
+        if (integer && (number != std::floor(number) || std::fabs(number) > 2147483647.0)) {
+            errors.push_back(where + ": " + key + " must be a whole number, got '" + value + "'");
+            return false;
+        }
+        return true;
+    }
+
+    // "time:multiplier, time:multiplier, ..."
+    void parseProfile(const std::string& where, const std::string& value) {
+        std::vector<std::pair<double, double>> profile;
+        std::stringstream list(value);
+        std::string item;
+        while (std::getline(list, item, ',')) {
+            item = trim(item);
+            size_t colon = item.find(':');
+            double time, multiplier;
+            if (colon == std::string::npos ||
+                !parseNumber(where, "diurnalProfile time", trim(item.substr(0, colon)), false, time) ||
+                !parseNumber(where, "diurnalProfile multiplier", trim(item.substr(colon + 1)), false, multiplier)) {
+                if (colon == std::string::npos) errors.push_back(where + ": diurnalProfile entries are time:multiplier, got '" + item + "'");
+                return;
+            }
+            if (multiplier < 0.0) {
+                errors.push_back(where + ": diurnalProfile multiplier must be >= 0, got '" + item + "'");
+                return;
+            }
+            profile.emplace_back(time, multiplier);
+        }
+        if (profile.empty()) {
+            errors.push_back(where + ": diurnalProfile needs at least one time:multiplier entry");
+            return;
+        }
+        config.diurnalProfile = profile;
+    }
+
+    // The trace must be readable and must not be one of the files this run is about to overwrite
+    void checkReplayFile(const std::string& where) {
+        if (!TraceReplay(config.replayFile).isOpen()) {
+            errors.push_back(where + ": cannot read replayFile '" + config.replayFile + "'");
+            return;
+        }
+        for (const char* output : {"task_log.txt", "simulation_trace.bin"}) {
+            std::error_code error;
+            if (std::filesystem::equivalent(config.replayFile, outputPath(config, output), error)) {
+                errors.push_back(where + ": replayFile '" + config.replayFile + "' is this run's own " + output +
+                                 "; copy it or set outputDir");
+            }
+        }
+    }
+
+    static std::string formatNumber(double value) {
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+
+    static bool parseBool(std::string value, bool& flag) {
+        std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return std::tolower(c); });
+        if (value == "true" || value == "1" || value == "yes" || value == "on") flag = true;
+        else if (value == "false" || value == "0" || value == "no" || value == "off") flag = false;
+        else return false;
+        return true;
+    }
+
+    template <typename Enum>
+    void parseChoice(const std::string& where, const std::string& key, const std::string& value, Enum& field,
+                     const std::vector<std::pair<const char*, Enum>>& choices) {
+        std::string expected;
+        for (const auto& [name, choice] : choices) {
+            if (value == name) {
+                field = choice;
+                return;
+            }
+            expected += (expected.empty() ? "" : ", ") + std::string(name);
+        }
+        errors.push_back(where + ": unknown " + key + " '" + value + "' (expected " + expected + ")");
+    }
+};
+
+#endif // CONFIG_FILE_H
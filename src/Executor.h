@@ -0,0 +1,141 @@
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <algorithm>
+
+// Fixed pool of worker threads running short, non-blocking jobs, such as the service steps of servers
+// that share it. Each worker has its own deque: jobs posted from a worker stay on it (newest first,
+// while its data is still in cache) and idle workers steal the oldest jobs of the others.
+// Jobs posted from other threads are spread round robin. Workers with nothing to run or steal sleep.
+class Executor {
+public:
+    // 0 threads = one per hardware thread
+    explicit Executor(size_t threads = 0) {
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workerThreads.emplace_back(&Executor::run, this, i);
+        }
+    }
+
+    // Stops the workers; jobs that have not started are dropped
+    ~Executor() {
+        running = false;
+        {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            jobAvailable.notify_all();
+        }
+        for (auto& thread : workerThreads) {
+            thread.join();
+        }
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void post(std::function<void()> job) {
+        size_t target = currentWorker().first == this ? currentWorker().second
+                                                      : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        {
+            std::lock_guard<std::mutex> lock(workers[target]->mutex);
+            workers[target]->jobs.push_back(std::move(job));
+        }
+        ++pendingJobs;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parkedWorkers.load() > 0) {
+            std::lock_guard<std::mutex> lock(parkMutex);
+            jobAvailable.notify_one();
+        }
+    }
+
+    size_t getThreadCount() const {
+        return workers.size();
+    }
+
+    uint64_t getExecutedJobs() const {
+        return executedJobs.load();
+    }
+
+    // Jobs a worker took from another worker's deque
+    uint64_t getStolenJobs() const {
+        return stolenJobs.load();
+    }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> workerThreads;
+    std::atomic<bool> running{true};
+    std::atomic<size_t> nextWorker{0};
+    std::atomic<long long> pendingJobs{0};  // Posted and not yet taken
+    std::atomic<int> parkedWorkers{0};
+    std::mutex parkMutex;  // Only used to park idle workers
+    std::condition_variable jobAvailable;
+    std::atomic<uint64_t> executedJobs{0};
+    std::atomic<uint64_t> stolenJobs{0};
+
+    // The executor and worker index of the calling thread, so jobs posted by a job stay local
+    static std::pair<const Executor*, size_t>& currentWorker() {
+        static thread_local std::pair<const Executor*, size_t> current{nullptr, 0};
+        return current;
+    }
+
+    bool takeOwn(size_t index, std::function<void()>& job) {
+        Worker& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.jobs.empty()) return false;
+        job = std::move(worker.jobs.back());
+        worker.jobs.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, std::function<void()>& job) {
+        for (size_t offset = 1; offset < workers.size(); ++offset) {
+            Worker& victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (victim.jobs.empty()) continue;
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            ++stolenJobs;
+            return true;
+        }
+        return false;
+    }
+
+    void run(size_t index) {
+        currentWorker() = {this, index};
+        std::function<void()> job;
+        while (running) {
+            if (takeOwn(index, job) || steal(index, job)) {
+                --pendingJobs;
+                job();
+                job = nullptr;  // Release what the job captured before looking for the next one
+                ++executedJobs;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(parkMutex);
+            ++parkedWorkers;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            jobAvailable.wait(lock, [this]() { return pendingJobs.load() > 0 || !running; });
+            --parkedWorkers;
+        }
+        currentWorker() = {nullptr, 0};
+    }
+};
+
+#endif // EXECUTOR_H
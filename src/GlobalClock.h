@@ -5,17 +5,41 @@
 #include <thread>
 #include <atomic>
 #include <iostream>
+#include <queue>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <limits>
 
 using namespace std;
 
+// RealTime ticks on its own thread, Virtual jumps straight to the next scheduled event
+enum class ClockMode { RealTime, Virtual };
+
 class GlobalClock {
 public:
-    // Constructor with adjustable time increment
-    GlobalClock(double increment = 1.0) 
-        : currentTime(0), running(true), timeIncrement(increment), clockThread(&GlobalClock::run, this) {}
+    // Kinds of events handled by the virtual-time event queue
+    enum class EventType { TaskArrival, ServiceStart, ServiceCompletion, UtilizationUpdate, Timer };
+
+    // Constructor with adjustable time increment (simulation seconds per real second) and real-time tick length
+    GlobalClock(double increment = 1.0, ClockMode clockMode = ClockMode::RealTime,
+                chrono::microseconds tick = chrono::seconds(1))
+        : currentTime(0), running(true), timeIncrement(increment), mode(clockMode), tickInterval(tick) {
+        if (tickInterval.count() <= 0) {
+            tickInterval = chrono::microseconds(1);
+        }
+        startTime = chrono::steady_clock::now();
+        if (mode == ClockMode::RealTime) {
+            clockThread = thread(&GlobalClock::run, this);
+        }
+    }
 
     ~GlobalClock() {
         running = false;
+        wakeWaiters();
         if (clockThread.joinable()) {
             clockThread.join();
         }
@@ -46,17 +70,130 @@ public:
         }
     }
 
+    bool isVirtual() const {
+        return mode == ClockMode::Virtual;
+    }
+
+    // Schedule an action at a simulation time (virtual mode only, not thread safe)
+    void scheduleEvent(double time, EventType type, function<void()> action) {
+        if (time < currentTime) {
+            time = currentTime;  // Never schedule into the past
+        }
+        events.push(Event{time, nextSequence++, type, std::move(action)});
+    }
+
+    // Process events in time order until the queue is empty or endTime is reached
+    void runUntil(double endTime) {
+        while (running && !events.empty() && events.top().time <= endTime) {
+            Event event = events.top();
+            events.pop();
+            currentTime = event.time;  // Jump straight to the next event
+            ++processedEvents;
+            event.action();
+        }
+        if (currentTime < endTime) {
+            currentTime = endTime;
+        }
+    }
+
+    // Run an action on the clock thread once the simulation time reaches simTime.
+    // Actions must be short; in virtual mode this is an ordinary Timer event.
+    void addTimer(double simTime, function<void()> action) {
+        if (isVirtual()) {
+            scheduleEvent(simTime, EventType::Timer, std::move(action));
+            return;
+        }
+        lock_guard<mutex> lock(waitMutex);
+        timers.push(Event{simTime, nextSequence++, EventType::Timer, std::move(action)});
+    }
+
+    // Block the calling thread until the simulation time reaches simTime (real-time mode only).
+    // Returns false if the clock stopped or interrupted() became true first.
+    bool waitUntil(double simTime, const function<bool()>& interrupted = nullptr) {
+        unique_lock<mutex> lock(waitMutex);
+        auto deadline = waitDeadlines.insert(simTime);
+        deadlineReached.wait(lock, [&]() {
+            return currentTime >= simTime || !running || (interrupted && interrupted());
+        });
+        waitDeadlines.erase(deadline);
+        return currentTime >= simTime;
+    }
+
+    // Wake every waiter so it can re-check its interrupt condition
+    void wakeWaiters() {
+        { lock_guard<mutex> lock(waitMutex); }
+        deadlineReached.notify_all();
+    }
+
+    size_t getPendingEvents() const {
+        return events.size();
+    }
+
+    // Time of the earliest scheduled event (virtual mode), infinity when there is none
+    double getNextEventTime() const {
+        return events.empty() ? numeric_limits<double>::infinity() : events.top().time;
+    }
+
+    uint64_t getProcessedEvents() const {
+        return processedEvents;
+    }
+
 private:
+    struct Event {
+        double time;
+        uint64_t sequence;  // Keeps events at the same time in scheduling order
+        EventType type;
+        function<void()> action;
+    };
+
+    struct EventLater {
+        bool operator()(const Event& a, const Event& b) const {
+            if (a.time != b.time) return a.time > b.time;
+            return a.sequence > b.sequence;
+        }
+    };
+
     atomic<double> currentTime;  // Simulation time
     chrono::steady_clock::time_point startTime;  // Start time of the simulation
     atomic<bool> running;
-    atomic<double> timeIncrement;  // How much time to add per tick
+    atomic<double> timeIncrement;  // Simulation seconds added per real second of ticking
+    ClockMode mode;
+    chrono::microseconds tickInterval;  // Real time between ticks
+    priority_queue<Event, vector<Event>, EventLater> events;  // Virtual-time event queue
+    uint64_t nextSequence = 0;
+    uint64_t processedEvents = 0;
+    mutex waitMutex;  // Guards timers and waitDeadlines in real-time mode
+    condition_variable deadlineReached;
+    multiset<double> waitDeadlines;  // Deadlines of threads blocked in waitUntil
+    priority_queue<Event, vector<Event>, EventLater> timers;  // Real-time timers fired by the clock thread
     thread clockThread;
 
     void run() {
+        auto nextTick = chrono::steady_clock::now();
+        double tickSeconds = chrono::duration<double>(tickInterval).count();
+        vector<function<void()>> dueTimers;
         while (running) {
-            this_thread::sleep_for(chrono::milliseconds(1000));  // Tick every 1 ms
-            currentTime = currentTime + timeIncrement;  // Adjust simulation time by timeIncrement
+            nextTick += tickInterval;
+            this_thread::sleep_until(nextTick);  // Absolute deadlines so short ticks do not drift
+            currentTime = currentTime + timeIncrement * tickSeconds;  // Adjust simulation time by timeIncrement
+
+            bool wakeup = false;
+            {
+                lock_guard<mutex> lock(waitMutex);
+                while (!timers.empty() && timers.top().time <= currentTime) {
+                    dueTimers.push_back(timers.top().action);
+                    timers.pop();
+                }
+                wakeup = !waitDeadlines.empty() && *waitDeadlines.begin() <= currentTime;
+            }
+            // Only wake waiters when one of their deadlines has actually passed
+            if (wakeup) {
+                deadlineReached.notify_all();
+            }
+            for (auto& action : dueTimers) {
+                action();
+            }
+            dueTimers.clear();
         }
     }
 };
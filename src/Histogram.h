@@ -0,0 +1,110 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+// HDR-style latency histogram: values in seconds are counted at microsecond resolution
+// in log-bucketed sub-buckets (128 per power of two, so any value is within 0.8%).
+// Memory is fixed (about 33 KB, allocated on the first sample) whatever the number of samples,
+// and histograms merge by adding counts.
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 7;
+    static constexpr int MaxExponent = 38;  // Largest tracked value is about 2^39 us (6 days); larger values saturate
+    static constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+    static constexpr size_t BucketCount = size_t(MaxExponent - SubBucketBits + 2) << SubBucketBits;
+
+    static size_t bucketIndex(double seconds) {
+        if (!(seconds > 0.0)) return 0;
+        double micros = seconds * 1e6;
+        if (micros >= std::ldexp(1.0, MaxExponent + 1)) return BucketCount - 1;
+        uint64_t value = static_cast<uint64_t>(micros);
+        if (value < SubBucketCount) return static_cast<size_t>(value);
+        int exponent = 63 - countLeadingZeros(value);
+        int shift = exponent - SubBucketBits;
+        return static_cast<size_t>(shift) * SubBucketCount + static_cast<size_t>(value >> shift);
+    }
+
+    // Midpoint of a bucket, in seconds
+    static double bucketValue(size_t index) {
+        if (index < SubBucketCount) return index * 1e-6;
+        size_t shift = index / SubBucketCount - 1;
+        uint64_t low = static_cast<uint64_t>(index - shift * SubBucketCount) << shift;
+        uint64_t width = uint64_t(1) << shift;
+        return (low + (width - 1) / 2.0) * 1e-6;
+    }
+
+    void record(double seconds) {
+        allocate();
+        ++counts[bucketIndex(seconds)];
+        ++total;
+    }
+
+    void addToBucket(size_t index, uint64_t count) {
+        allocate();
+        counts[index] += count;
+        total += count;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        if (other.total == 0) return;
+        allocate();
+        for (size_t i = 0; i < BucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    // Smallest recorded bucket value with at least percent% of the samples at or below it
+    double percentile(double percent) const {
+        if (total == 0) return 0.0;
+        uint64_t rank = static_cast<uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * total));
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return bucketValue(i);
+        }
+        return bucketValue(BucketCount - 1);
+    }
+
+    // One "<label> <value> <cumulative fraction>" line per non-empty bucket
+    void writeCdf(std::ostream& out, const std::string& label) const {
+        if (total == 0) return;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            if (counts[i] == 0) continue;
+            seen += counts[i];
+            out << label << " " << bucketValue(i) << " " << static_cast<double>(seen) / total << "\n";
+        }
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t total = 0;
+
+    void allocate() {
+        if (counts.empty()) counts.assign(BucketCount, 0);
+    }
+
+    static int countLeadingZeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(value);
+#else
+        int zeros = 0;
+        for (uint64_t bit = uint64_t(1) << 63; bit && !(value & bit); bit >>= 1) ++zeros;
+        return zeros;
+#endif
+    }
+};
+
+#endif // HISTOGRAM_H
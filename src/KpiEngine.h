@@ -0,0 +1,564 @@
+#ifndef KPI_ENGINE_H
+#define KPI_ENGINE_H
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include "Histogram.h"
+
+// Running count, mean, variance (Welford), min and max; mergeable across threads
+struct RunningStat {
+    long long count = 0;
+    double mean = 0.0;
+    double m2 = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    void add(double value) {
+        ++count;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    // Chan et al. parallel combination
+    void merge(const RunningStat& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        long long total = count + other.count;
+        double delta = other.mean - mean;
+        mean += delta * other.count / total;
+        m2 += other.m2 + delta * delta * static_cast<double>(count) * other.count / total;
+        count = total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    double variance() const {
+        return count > 1 ? m2 / (count - 1) : 0.0;
+    }
+
+    double stddev() const {
+        return std::sqrt(variance());
+    }
+};
+
+struct ServerKpi {
+    int serverId = 0;
+    RunningStat waitTime;     // Queue arrival -> service start
+    RunningStat serviceTime;  // Service start -> finish (after processing power)
+    RunningStat delay;        // Generation -> finish (end to end)
+    LatencyHistogram waitHistogram, serviceHistogram, delayHistogram;
+    long long arrived = 0;
+    long long completed = 0;
+    long long rejected = 0;
+    long long stolenIn = 0;   // Queued tasks this server took from peers
+    long long stolenOut = 0;  // Queued tasks peers took from this server
+    long long cancelled = 0;  // Queued tasks withdrawn (hedging)
+    long long preempted = 0;  // Tasks stopped in service (hedging)
+    long long suspended = 0;  // Tasks put back in the queue by a shorter arrival (ShortestRemainingTime)
+    long long missedDeadlines = 0;  // Completed after their deadline
+    int cores = 1;
+    double averageQueueLength = 0.0;  // Time-weighted
+    double averageBusyCores = 0.0;    // Busy time / elapsed time
+    double utilization = 0.0;         // Busy time / (elapsed time * cores)
+    double throughput = 0.0;          // Completed tasks per simulated second
+};
+
+struct KpiSnapshot {
+    double simTime = 0.0;
+    std::vector<ServerKpi> servers;
+    ServerKpi global;  // serverId 0; queue length and throughput summed, utilization averaged
+    // One per task class, serverId holding the class index; utilization is the class's share of every core
+    std::vector<ServerKpi> classes;
+    std::vector<std::string> classNames;
+};
+
+// Online KPI engine. Components push events while the simulation runs; each thread
+// accumulates into its own slots (single writer, no locks) and snapshot() merges them.
+//
+// Time-weighted queue length and utilization need no shared state: the area under the
+// queue-length curve is the sum of finished waits plus (now - arrival) of tasks still
+// queued, and busy time is the sum of finished services plus (now - start) of tasks in service.
+//
+// With task classes, every event that names a class also updates that class's slot, so a class gets the
+// same KPIs as a server: its tasks' waits and delays, and how many of them wait or run across all servers.
+class KpiEngine {
+public:
+    explicit KpiEngine(int maxServerId, std::vector<std::string> taskClassNames = {})
+        : serverSlots(std::max(0, maxServerId) + 1), classNames(std::move(taskClassNames)), engineId(nextEngineId()),
+          serverCores(serverSlots) {
+        for (auto& cores : serverCores) cores = 1;
+    }
+
+    KpiEngine(const KpiEngine&) = delete;
+    KpiEngine& operator=(const KpiEngine&) = delete;
+
+    // Number of service slots, so utilization is the busy fraction of all of them
+    void setCores(int serverId, int cores) {
+        if (serverId >= 0 && static_cast<size_t>(serverId) < serverSlots) {
+            serverCores[serverId] = std::max(1, cores);
+        }
+    }
+
+    // taskClass (from 0) also counts the event for that class; -1 for none
+    void taskArrived(int serverId, double arrivalTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.arrived, 1);
+            bump(slot.queued, 1);
+            bump(slot.queuedArrivalSum, arrivalTime);
+        });
+    }
+
+    void taskRejected(int serverId, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) { bump(slot.rejected, 1); });
+    }
+
+    // A queued task moved from victim to thief: the victim's queue held it until stealTime, the thief's from then on
+    void taskStolen(int victimId, int thiefId, double arrivalTime, double stealTime) {
+        update(victimId, -1, [&](Slot& slot) {
+            bump(slot.queued, -1);
+            bump(slot.queuedArrivalSum, -arrivalTime);
+            bump(slot.queueAreaAdjust, stealTime - arrivalTime);
+            bump(slot.stolenOut, 1);
+        });
+        update(thiefId, -1, [&](Slot& slot) {
+            bump(slot.queued, 1);
+            bump(slot.queuedArrivalSum, arrivalTime);
+            bump(slot.queueAreaAdjust, arrivalTime - stealTime);
+            bump(slot.stolenIn, 1);
+        });
+    }
+
+    // A queued task was withdrawn: it counted towards the queue length until cancelTime
+    void taskCancelled(int serverId, double arrivalTime, double cancelTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.queued, -1);
+            bump(slot.queuedArrivalSum, -arrivalTime);
+            bump(slot.queueAreaAdjust, cancelTime - arrivalTime);
+            bump(slot.cancelled, 1);
+        });
+    }
+
+    // A task was stopped in service: the core was busy until stopTime, but nothing completed
+    void servicePreempted(int serverId, double startTime, double stopTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.busy, -1);
+            bump(slot.busyStartSum, -startTime);
+            bump(slot.busyTime, stopTime - startTime);
+            bump(slot.preempted, 1);
+        });
+    }
+
+    // A task in service went back to the queue (ShortestRemainingTime): busy until then, queued from then on
+    void serviceSuspended(int serverId, double startTime, double suspendTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.busy, -1);
+            bump(slot.busyStartSum, -startTime);
+            bump(slot.busyTime, suspendTime - startTime);
+            bump(slot.queued, 1);
+            bump(slot.queuedArrivalSum, suspendTime);
+            bump(slot.suspended, 1);
+        });
+    }
+
+    // A suspended task is served again; its wait was sampled when it first started, so this wait only adds queue length
+    void serviceResumed(int serverId, double suspendTime, double resumeTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.queued, -1);
+            bump(slot.queuedArrivalSum, -suspendTime);
+            bump(slot.queueAreaAdjust, resumeTime - suspendTime);
+            bump(slot.busy, 1);
+            bump(slot.busyStartSum, resumeTime);
+        });
+    }
+
+    void serviceStarted(int serverId, double arrivalTime, double startTime, int taskClass = -1) {
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.queued, -1);
+            bump(slot.queuedArrivalSum, -arrivalTime);
+            slot.waitTime.add(startTime - arrivalTime);
+            slot.waitHistogram.record(startTime - arrivalTime);
+            bump(slot.busy, 1);
+            bump(slot.busyStartSum, startTime);
+        });
+    }
+
+    // startTime is when the last stretch of service began; servedTime is the service over every stretch
+    // (negative: finishTime - startTime). A task finishing after its deadline counts as a miss.
+    void serviceFinished(int serverId, double generationTime, double startTime, double finishTime, int taskClass = -1,
+                         double servedTime = -1.0, double deadline = std::numeric_limits<double>::infinity()) {
+        double service = servedTime < 0.0 ? finishTime - startTime : servedTime;
+        update(serverId, taskClass, [&](Slot& slot) {
+            bump(slot.busy, -1);
+            bump(slot.busyStartSum, -startTime);
+            bump(slot.busyTime, finishTime - startTime);
+            bump(slot.completed, 1);
+            if (finishTime > deadline) bump(slot.missedDeadlines, 1);
+            slot.serviceTime.add(service);
+            slot.serviceHistogram.record(service);
+            slot.delay.add(finishTime - generationTime);
+            slot.delayHistogram.record(finishTime - generationTime);
+        });
+    }
+
+    // Merge every thread's accumulators; elapsed time is measured from simulation time 0
+    KpiSnapshot snapshot(double simTime) const {
+        size_t count = serverSlots + classNames.size();
+        std::vector<Totals> totals(count);
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (const auto& accumulator : accumulators) {
+                accumulator->readInto(totals);
+            }
+        }
+
+        KpiSnapshot result;
+        result.simTime = simTime;
+        result.global.cores = 0;
+        int activeServers = 0;
+        for (size_t id = 0; id < serverSlots; ++id) {
+            const Totals& t = totals[id];
+            if (t.arrived == 0 && t.rejected == 0 && t.stolenIn == 0) continue;
+            ServerKpi kpi = makeKpi(static_cast<int>(id), t, simTime, serverCores[id].load());
+            result.servers.push_back(kpi);
+
+            ServerKpi& global = result.global;
+            global.waitTime.merge(kpi.waitTime);
+            global.serviceTime.merge(kpi.serviceTime);
+            global.delay.merge(kpi.delay);
+            global.waitHistogram.merge(kpi.waitHistogram);
+            global.serviceHistogram.merge(kpi.serviceHistogram);
+            global.delayHistogram.merge(kpi.delayHistogram);
+            global.arrived += kpi.arrived;
+            global.completed += kpi.completed;
+            global.rejected += kpi.rejected;
+            global.stolenIn += kpi.stolenIn;
+            global.stolenOut += kpi.stolenOut;
+            global.cancelled += kpi.cancelled;
+            global.preempted += kpi.preempted;
+            global.suspended += kpi.suspended;
+            global.missedDeadlines += kpi.missedDeadlines;
+            global.averageQueueLength += kpi.averageQueueLength;
+            global.utilization += kpi.utilization;
+            global.cores += kpi.cores;
+            global.averageBusyCores += kpi.averageBusyCores;
+            global.throughput += kpi.throughput;
+            ++activeServers;
+        }
+        if (activeServers > 0) {
+            result.global.utilization /= activeServers;
+        }
+        result.classNames = classNames;
+        for (size_t index = 0; index < classNames.size(); ++index) {
+            result.classes.push_back(makeKpi(static_cast<int>(index), totals[serverSlots + index], simTime,
+                                             std::max(1, result.global.cores)));
+        }
+        return result;
+    }
+
+    // One line per server, an "All" line and one line per task class
+    static void writeReport(const std::string& path, const KpiSnapshot& snapshot) {
+        std::ofstream report(path, std::ios::app);
+        if (!report.is_open()) {
+            std::cerr << "Failed to open KPI report file: " << path << std::endl;
+            return;
+        }
+        auto percentiles = [&](const char* name, const LatencyHistogram& histogram) {
+            report << ", " << name << " p50: " << histogram.percentile(50)
+                   << ", " << name << " p99: " << histogram.percentile(99)
+                   << ", " << name << " p99.9: " << histogram.percentile(99.9);
+        };
+        auto line = [&](const std::string& name, const ServerKpi& kpi) {
+            report << name
+                   << ", Completed: " << kpi.completed
+                   << ", Rejected: " << kpi.rejected
+                   << ", Stolen in: " << kpi.stolenIn << " out: " << kpi.stolenOut
+                   << ", Cancelled: " << kpi.cancelled << " preempted: " << kpi.preempted
+                   << ", Suspended: " << kpi.suspended
+                   << ", Missed deadlines: " << kpi.missedDeadlines
+                   << ", Throughput: " << kpi.throughput << " tasks/s"
+                   << ", Utilization: " << kpi.utilization * 100 << "%"
+                   << ", Cores: " << kpi.cores << " busy: " << kpi.averageBusyCores
+                   << ", Average Queue length: " << kpi.averageQueueLength
+                   << ", Waiting time mean: " << kpi.waitTime.mean << " stddev: " << kpi.waitTime.stddev()
+                   << ", Service time mean: " << kpi.serviceTime.mean << " stddev: " << kpi.serviceTime.stddev()
+                   << ", Delay mean: " << kpi.delay.mean << " stddev: " << kpi.delay.stddev();
+            percentiles("Waiting", kpi.waitHistogram);
+            percentiles("Service", kpi.serviceHistogram);
+            percentiles("Delay", kpi.delayHistogram);
+            report << "\n";
+        };
+        report << "Simulation time: " << snapshot.simTime << " secs\n";
+        for (const auto& kpi : snapshot.servers) {
+            line("Server ID: " + std::to_string(kpi.serverId), kpi);
+        }
+        line("Server ID: All", snapshot.global);
+        for (size_t index = 0; index < snapshot.classes.size(); ++index) {
+            line("Class: " + snapshot.classNames[index], snapshot.classes[index]);
+        }
+    }
+
+    // Cumulative distributions for plot.py: "<server> <wait|service|delay> <seconds> <fraction>" per line
+    static void writeCdf(const std::string& path, const KpiSnapshot& snapshot) {
+        std::ofstream cdf(path);
+        if (!cdf.is_open()) {
+            std::cerr << "Failed to open CDF file: " << path << std::endl;
+            return;
+        }
+        auto write = [&](const std::string& name, const ServerKpi& kpi) {
+            kpi.waitHistogram.writeCdf(cdf, name + " wait");
+            kpi.serviceHistogram.writeCdf(cdf, name + " service");
+            kpi.delayHistogram.writeCdf(cdf, name + " delay");
+        };
+        for (const auto& kpi : snapshot.servers) {
+            write(std::to_string(kpi.serverId), kpi);
+        }
+        write("All", snapshot.global);
+    }
+
+private:
+    // Welford accumulator written by one thread and read with relaxed atomics
+    struct StatCell {
+        std::atomic<long long> count{0};
+        std::atomic<double> mean{0.0};
+        std::atomic<double> m2{0.0};
+        std::atomic<double> min{std::numeric_limits<double>::infinity()};
+        std::atomic<double> max{-std::numeric_limits<double>::infinity()};
+
+        void add(double value) {
+            long long n = count.load(std::memory_order_relaxed) + 1;
+            double oldMean = mean.load(std::memory_order_relaxed);
+            double newMean = oldMean + (value - oldMean) / n;
+            m2.store(m2.load(std::memory_order_relaxed) + (value - oldMean) * (value - newMean), std::memory_order_relaxed);
+            mean.store(newMean, std::memory_order_relaxed);
+            count.store(n, std::memory_order_relaxed);
+            if (value < min.load(std::memory_order_relaxed)) min.store(value, std::memory_order_relaxed);
+            if (value > max.load(std::memory_order_relaxed)) max.store(value, std::memory_order_relaxed);
+        }
+
+        RunningStat read() const {
+            RunningStat stat;
+            stat.count = count.load(std::memory_order_relaxed);
+            stat.mean = mean.load(std::memory_order_relaxed);
+            stat.m2 = m2.load(std::memory_order_relaxed);
+            stat.min = min.load(std::memory_order_relaxed);
+            stat.max = max.load(std::memory_order_relaxed);
+            return stat;
+        }
+    };
+
+    // Bucket counts of a LatencyHistogram, allocated on the first sample so idle servers cost nothing
+    struct HistogramCell {
+        std::atomic<std::atomic<uint64_t>*> buckets{nullptr};
+
+        ~HistogramCell() {
+            delete[] buckets.load();
+        }
+
+        void record(double seconds) {
+            std::atomic<uint64_t>* counts = buckets.load(std::memory_order_relaxed);
+            if (!counts) {
+                counts = new std::atomic<uint64_t>[LatencyHistogram::BucketCount]();
+                buckets.store(counts, std::memory_order_release);
+            }
+            std::atomic<uint64_t>& bucket = counts[LatencyHistogram::bucketIndex(seconds)];
+            bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        LatencyHistogram read() const {
+            LatencyHistogram histogram;
+            const std::atomic<uint64_t>* counts = buckets.load(std::memory_order_acquire);
+            if (!counts) return histogram;
+            for (size_t i = 0; i < LatencyHistogram::BucketCount; ++i) {
+                uint64_t count = counts[i].load(std::memory_order_relaxed);
+                if (count) histogram.addToBucket(i, count);
+            }
+            return histogram;
+        }
+    };
+
+    struct Slot {
+        StatCell waitTime, serviceTime, delay;
+        HistogramCell waitHistogram, serviceHistogram, delayHistogram;
+        std::atomic<long long> arrived{0}, completed{0}, rejected{0}, stolenIn{0}, stolenOut{0}, cancelled{0}, preempted{0};
+        std::atomic<long long> suspended{0}, missedDeadlines{0};
+        std::atomic<long long> queued{0}, busy{0};  // Net change made by this thread
+        std::atomic<double> queuedArrivalSum{0.0}, busyStartSum{0.0}, busyTime{0.0};
+        std::atomic<double> queueAreaAdjust{0.0};  // Queue time moved between servers by stealing, or cut short by cancelling
+    };
+
+    struct Totals {
+        RunningStat waitTime, serviceTime, delay;
+        LatencyHistogram waitHistogram, serviceHistogram, delayHistogram;
+        long long arrived = 0, completed = 0, rejected = 0, stolenIn = 0, stolenOut = 0, cancelled = 0, preempted = 0;
+        long long suspended = 0, missedDeadlines = 0;
+        long long queued = 0, busy = 0;
+        double queuedArrivalSum = 0.0, busyStartSum = 0.0, busyTime = 0.0, queueAreaAdjust = 0.0;
+    };
+
+    // One per thread; a sequence lock lets snapshot() read a consistent copy without blocking the owner
+    struct Accumulator {
+        explicit Accumulator(size_t servers) : slots(servers) {}
+
+        std::atomic<uint64_t> sequence{0};
+        std::vector<Slot> slots;
+
+        void readInto(std::vector<Totals>& totals) const {
+            std::vector<Totals> copy(slots.size());
+            while (true) {
+                uint64_t before = sequence.load(std::memory_order_acquire);
+                if (before & 1) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                for (size_t id = 0; id < slots.size(); ++id) {
+                    const Slot& slot = slots[id];
+                    Totals& t = copy[id];
+                    t.waitTime = slot.waitTime.read();
+                    t.serviceTime = slot.serviceTime.read();
+                    t.delay = slot.delay.read();
+                    t.waitHistogram = slot.waitHistogram.read();
+                    t.serviceHistogram = slot.serviceHistogram.read();
+                    t.delayHistogram = slot.delayHistogram.read();
+                    t.arrived = slot.arrived.load(std::memory_order_relaxed);
+                    t.completed = slot.completed.load(std::memory_order_relaxed);
+                    t.rejected = slot.rejected.load(std::memory_order_relaxed);
+                    t.stolenIn = slot.stolenIn.load(std::memory_order_relaxed);
+                    t.stolenOut = slot.stolenOut.load(std::memory_order_relaxed);
+                    t.cancelled = slot.cancelled.load(std::memory_order_relaxed);
+                    t.preempted = slot.preempted.load(std::memory_order_relaxed);
+                    t.suspended = slot.suspended.load(std::memory_order_relaxed);
+                    t.missedDeadlines = slot.missedDeadlines.load(std::memory_order_relaxed);
+                    t.queueAreaAdjust = slot.queueAreaAdjust.load(std::memory_order_relaxed);
+                    t.queued = slot.queued.load(std::memory_order_relaxed);
+                    t.busy = slot.busy.load(std::memory_order_relaxed);
+                    t.queuedArrivalSum = slot.queuedArrivalSum.load(std::memory_order_relaxed);
+                    t.busyStartSum = slot.busyStartSum.load(std::memory_order_relaxed);
+                    t.busyTime = slot.busyTime.load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) break;
+            }
+            for (size_t id = 0; id < copy.size(); ++id) {
+                Totals& total = totals[id];
+                const Totals& t = copy[id];
+                total.waitTime.merge(t.waitTime);
+                total.serviceTime.merge(t.serviceTime);
+                total.delay.merge(t.delay);
+                total.waitHistogram.merge(t.waitHistogram);
+                total.serviceHistogram.merge(t.serviceHistogram);
+                total.delayHistogram.merge(t.delayHistogram);
+                total.arrived += t.arrived;
+                total.completed += t.completed;
+                total.rejected += t.rejected;
+                total.stolenIn += t.stolenIn;
+                total.stolenOut += t.stolenOut;
+                total.cancelled += t.cancelled;
+                total.preempted += t.preempted;
+                total.suspended += t.suspended;
+                total.missedDeadlines += t.missedDeadlines;
+                total.queueAreaAdjust += t.queueAreaAdjust;
+                total.queued += t.queued;
+                total.busy += t.busy;
+                total.queuedArrivalSum += t.queuedArrivalSum;
+                total.busyStartSum += t.busyStartSum;
+                total.busyTime += t.busyTime;
+            }
+        }
+    };
+
+    size_t serverSlots;
+    std::vector<std::string> classNames;  // Their slots follow the servers'
+    uint64_t engineId;
+    std::vector<std::atomic<int>> serverCores;  // Service slots per server, for utilization
+    mutable std::mutex registryMutex;  // Only taken when a thread first reports, and by snapshot()
+    std::vector<std::unique_ptr<Accumulator>> accumulators;
+
+    static uint64_t nextEngineId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    // Single writer per cell, so a plain load/store replaces a read-modify-write
+    static void bump(std::atomic<double>& cell, double amount) {
+        cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    static void bump(std::atomic<long long>& cell, int amount) {
+        cell.store(cell.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    Accumulator& localAccumulator() {
+        // Cache keyed by engine ID so several engines (and reused addresses) never share slots
+        thread_local uint64_t cachedEngine = 0;
+        thread_local Accumulator* cached = nullptr;
+        if (cachedEngine != engineId) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            accumulators.push_back(std::make_unique<Accumulator>(serverSlots + classNames.size()));
+            cached = accumulators.back().get();
+            cachedEngine = engineId;
+        }
+        return *cached;
+    }
+
+    // Apply to the server's slot and, for a known class, to the class's slot in the same update
+    template <typename Update>
+    void update(int serverId, int taskClass, Update apply) {
+        if (serverId < 0 || static_cast<size_t>(serverId) >= serverSlots) return;
+        Accumulator& accumulator = localAccumulator();
+        uint64_t sequence = accumulator.sequence.load(std::memory_order_relaxed);
+        accumulator.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        apply(accumulator.slots[serverId]);
+        if (taskClass >= 0 && static_cast<size_t>(taskClass) < classNames.size()) {
+            apply(accumulator.slots[serverSlots + taskClass]);
+        }
+        accumulator.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    static ServerKpi makeKpi(int id, const Totals& t, double simTime, int cores) {
+        double elapsed = simTime > 0.0 ? simTime : 1.0;
+        ServerKpi kpi;
+        kpi.serverId = id;
+        kpi.waitTime = t.waitTime;
+        kpi.serviceTime = t.serviceTime;
+        kpi.delay = t.delay;
+        kpi.waitHistogram = t.waitHistogram;
+        kpi.serviceHistogram = t.serviceHistogram;
+        kpi.delayHistogram = t.delayHistogram;
+        kpi.arrived = t.arrived;
+        kpi.completed = t.completed;
+        kpi.rejected = t.rejected;
+        kpi.stolenIn = t.stolenIn;
+        kpi.stolenOut = t.stolenOut;
+        kpi.cancelled = t.cancelled;
+        kpi.preempted = t.preempted;
+        kpi.suspended = t.suspended;
+        kpi.missedDeadlines = t.missedDeadlines;
+        double queueArea = t.waitTime.count * t.waitTime.mean + t.queueAreaAdjust + (t.queued * simTime - t.queuedArrivalSum);
+        double busyTime = t.busyTime + (t.busy * simTime - t.busyStartSum);
+        kpi.averageQueueLength = std::max(0.0, queueArea / elapsed);
+        kpi.cores = cores;
+        kpi.averageBusyCores = std::max(0.0, busyTime / elapsed);
+        kpi.utilization = kpi.averageBusyCores / kpi.cores;
+        kpi.throughput = t.completed / elapsed;
+        return kpi;
+    }
+};
+
+#endif // KPI_ENGINE_H
@@ -1,19 +1,124 @@
 #ifndef LOADBALANCER_H
 #define LOADBALANCER_H
 
-#include <queue>
-#include <map>
+#include <deque>
 #include <vector>
 #include <string>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <cstdint>
 #include "SERVERQUEUE.h"
+#include "UtilizationIndex.h"
+#include "RoutingPolicy.h"
+#include "Logger.h"
+#include "TraceFormat.h"
 
 // Struct to represent a task
 struct Task {
     int id;
     double time;
+    double generationTime = -1.0;  // When the generator created it (negative: when a server accepts it)
+    TaskLabel label{};             // Class, priority and deadline for the servers' scheduling
+    uint64_t key = 0;              // Session or cache key for affinity routing (0 = none)
+};
+
+// The servers as the routing policies see them; a server with a full queue is unavailable, so the
+// policies pass it over while another one has room. With a GroupLoad the servers keep up to date, the
+// totals are O(1)
+class ServerQueueTargets final : public RoutingTargets {
+public:
+    ServerQueueTargets(const std::vector<std::shared_ptr<ServerQueue>>& servers,
+                       const std::vector<std::shared_ptr<ServerQueue>>& serverById, const GroupLoad* load = nullptr)
+        : servers(servers), serverById(serverById), load(load) {}
+
+    size_t size() const override { return servers.size(); }
+    int id(size_t index) const override { return servers[index]->getServerID(); }
+    bool available(int id) const override {
+        return id >= 0 && static_cast<size_t>(id) < serverById.size() && serverById[id] && !serverById[id]->isQueueFull();
+    }
+    double weight(size_t index) const override { return servers[index]->getProcessingPower(); }
+    size_t queueLength(size_t index) const override { return servers[index]->getQueueLength(); }
+    double expectedWork(size_t index) const override { return servers[index]->getExpectedRemainingWork(); }
+    int tasksInSystem(size_t index) const override { return servers[index]->getTasksInSystem(); }
+    int cores(size_t index) const override { return servers[index]->getCores(); }
+
+    long long totalTasksInSystem() const override {
+        return load ? load->tasksInSystem.load() : RoutingTargets::totalTasksInSystem();
+    }
+
+    long long totalCores() const override {
+        return load ? load->cores.load() : RoutingTargets::totalCores();
+    }
+
+private:
+    const std::vector<std::shared_ptr<ServerQueue>>& servers;
+    const std::vector<std::shared_ptr<ServerQueue>>& serverById;
+    const GroupLoad* load;
+};
+
+// What happens to a task that finds the backlog full
+enum class OverflowPolicy {
+    RejectNew,  // Tail drop: refuse the arriving task
+    DropOldest  // Head drop: shed the task that has waited longest and keep the new one
+};
+
+// Admission counters, for sizing the backlog and server queues
+struct AdmissionStats {
+    long long received = 0;    // sendTask calls
+    long long dispatched = 0;  // Accepted by a server
+    long long deferred = 0;    // Had to wait in the backlog at least once
+    long long rejected = 0;    // Refused on arrival (backlog full, or no server free with a zero-size backlog)
+    long long dropped = 0;     // Shed from the backlog head (DropOldest)
+    long long expired = 0;     // Waited longer than the maximum backlog wait
+    size_t backlog = 0;        // Tasks still waiting
+    size_t maxBacklog = 0;     // Deepest the backlog has been
+    RunningStat backlogWait;   // Time deferred tasks spent in the backlog before dispatch
+
+    long long shed() const {
+        return rejected + dropped + expired;
+    }
+
+    double dropRate() const {
+        return received > 0 ? static_cast<double>(shed()) / received : 0.0;
+    }
+};
+
+// Duplicating tasks to cut the tail delay: the first copy to finish wins and the other is cancelled
+enum class HedgingPolicy {
+    None,
+    Delayed,   // Send a copy to a second server when the task is still queued after the hedge delay
+    Immediate  // Send every task to two servers at once
+};
+
+// Hedging counters, to weigh the extra load against the delay it saves
+struct HedgeStats {
+    long long hedged = 0;           // Copies sent to a second server
+    long long skipped = 0;          // Copies no other server could take
+    long long started = 0;          // Delayed: tasks already in service when the delay ran out, so not copied
+    long long copyWins = 0;         // Tasks whose copy finished first
+    long long cancelledQueued = 0;  // Losing copies removed from a queue
+    long long preempted = 0;        // Losing copies stopped in service
+};
+
+// Where keyed tasks went: a key that returns to the server that served it last finds a warm cache
+struct AffinityStats {
+    long long keyed = 0;        // Dispatched tasks with a key
+    long long newKeys = 0;      // First task of its key
+    long long sameServer = 0;   // Went to the server its key's previous task went to
+    long long moved = 0;        // Went to another server (spilled, or its server left)
+    double imbalance = 0.0;     // Most tasks dispatched to one server over the mean, among current servers (1 = even)
+
+    // Fraction of returning keys that found their server
+    double hitRate() const {
+        return sameServer + moved > 0 ? static_cast<double>(sameServer) / (sameServer + moved) : 0.0;
+    }
 };
 
 // Forward Declaration
@@ -21,73 +126,518 @@ class ServerQueue;
 
 class LoadBalancer {
 private:
-    std::queue<Task> taskQueue;
-    std::map<int, double> serverUtilization;  // Server ID -> Utilization
+    struct BacklogEntry {
+        Task task;
+        double enqueueTime;
+        bool deferred;  // Already counted in AdmissionStats::deferred
+    };
+
+    // Every task passes through the backlog in FIFO order; it is dispatched immediately
+    // when a server can take it and otherwise waits until utilization drops
+    std::deque<BacklogEntry> backlog;
+    mutable std::mutex backlogMutex;
+    std::atomic<size_t> backlogSize{0};
+    size_t backlogCapacity = 1000;
+    OverflowPolicy overflowPolicy = OverflowPolicy::RejectNew;
+    double maxBacklogWait = 0.0;  // Simulation seconds, 0 waits forever
+    AdmissionStats admission;     // Guarded by backlogMutex
+
+    // Only one thread routes at a time (policies keep state); others leave their work to it
+    std::atomic<bool> routing{false};
+    std::atomic<bool> drainRequested{false};
+    UtilizationIndex serverUtilization;  // Server ID -> Utilization, ordered for O(1) argmin
     std::vector<std::shared_ptr<ServerQueue>> servers; // Array of server instances
-    std::ofstream logFile;
+    std::vector<std::shared_ptr<ServerQueue>> serverById; // Server ID -> instance
+    GroupLoad serverLoad;  // Running totals over `servers`, kept up to date by the servers themselves
+    std::unique_ptr<RoutingPolicy> policy;
+    std::function<bool(ServerQueue&, const Task&)> dispatcher;  // Replaces ServerQueue::addTask when set
+    int logSink = -1;  // Logger sink for load_balancer_log.txt
+    TraceWriter* trace = nullptr;  // Optional binary trace
+    GlobalClock* clock = nullptr;  // Timestamps for backlog waits and trace records
+
+    long long decisions = 0;
+    double totalDecisionNanos = 0.0;  // Time spent inside policy->selectServer
+
+    std::vector<long long> dispatchedTo;  // Server ID -> tasks dispatched, for the load imbalance
+    std::vector<char> retired;            // Server ID -> left through removeServer; its reports are ignored
+    std::unordered_map<uint64_t, int> lastServerForKey;  // Key -> server of its last task
+    AffinityStats affinity;
+
+    // Hedging runs in virtual time only, on the clock's thread; servers report finished tasks to taskFinished
+    struct Hedge {
+        Task task;
+        int primary;
+        int copy;  // -1 until the copy is sent
+    };
+    HedgingPolicy hedging = HedgingPolicy::None;
+    double hedgeDelay = 0.0;
+    std::unordered_map<int, Hedge> hedges;  // Task ID -> servers holding it, until one finishes it
+    HedgeStats hedgeStats;
 
 public:
-    LoadBalancer() {
-        logFile.open("load_balancer_log.txt", std::ios::app);
-        if (!logFile.is_open()) {
+    LoadBalancer(RoutingPolicyType policyType = RoutingPolicyType::LowestUtilization,
+                 const std::string& logPath = "load_balancer_log.txt")
+        : LoadBalancer(makeRoutingPolicy(policyType), logPath) {}
+
+    explicit LoadBalancer(std::unique_ptr<RoutingPolicy> routingPolicy, const std::string& logPath = "load_balancer_log.txt")
+        : policy(std::move(routingPolicy)) {
+        logSink = Logger::instance().openSink(logPath);
+        if (logSink < 0) {
             std::cerr << "Failed to open log file!" << std::endl;
         }
     }
 
     ~LoadBalancer() {
-        if (logFile.is_open()) {
-            logFile.close();
-        }
+        for (const auto& server : servers) server->setGroupLoad(nullptr);
+        Logger::instance().closeSink(logSink);
     }
 
+    // Safe to call from any server thread; a drop in utilization lets the backlog drain
     void trackUtil(int serverId, double utilization) {
-        serverUtilization[serverId] = utilization;
+        if (serverId >= 0 && static_cast<size_t>(serverId) < retired.size() && retired[serverId]) return;  // Draining, takes no tasks
+        serverUtilization.update(serverId, utilization);
+        if (backlogSize.load() > 0) {
+            drainBacklog();
+        }
     }
 
+    // Admit a task to the backlog (subject to the overflow policy) and dispatch as much of it as the servers accept
     void sendTask(const Task& task) {
-        taskQueue.push(task);
+        double now = currentTime();
+        {
+            std::lock_guard<std::mutex> lock(backlogMutex);
+            ++admission.received;
+            if (backlogCapacity > 0 && backlog.size() >= backlogCapacity) {
+                if (overflowPolicy == OverflowPolicy::RejectNew) {
+                    ++admission.rejected;
+                    shedTask(task, now, "backlog full, rejected");
+                    return;
+                }
+                ++admission.dropped;
+                shedTask(backlog.front().task, now, "backlog full, dropped oldest");
+                backlog.pop_front();
+            }
+            backlog.push_back(BacklogEntry{task, now, false});
+            admission.maxBacklog = std::max(admission.maxBacklog, backlog.size());
+            backlogSize = backlog.size();
+        }
+        drainBacklog();
+    }
 
-        int bestServer = -1;
-        double minUtilization = 1e9;
+    void logTask(const Task& task, int serverId) {
+        if (trace) {
+            trace->record(makeTraceRecord(TraceEventType::TaskAssigned, currentTime(),
+                                          task.id, serverId, task.time, 0, serverUtilization.get(serverId)));
+        }
+        Logger::instance().log(logSink, LogLevel::Info, "Task ID: {}, Assigned to Server: {}, Server Current Utilization: {g}",
+                               task.id, serverId, serverUtilization.get(serverId));
+    }
 
-        for (const auto& [serverId, util] : serverUtilization) {
-            if (util < minUtilization) {
-                minUtilization = util;
-                bestServer = serverId;
-            }
+    // Average cost of one routing decision, to compare against the resulting task delay
+    double getAverageDecisionTime() const {
+        return decisions > 0 ? totalDecisionNanos / decisions : 0.0;
+    }
+
+    // withTiming = false leaves out the decision time, the one wall-clock value in the log
+    void logPolicyStats(bool withTiming = true) {
+        std::string stats = "Routing Policy: " + policy->name() +
+                            ", Decisions: " + std::to_string(decisions);
+        if (withTiming) stats += ", Average Decision Time: " + std::to_string(getAverageDecisionTime()) + " ns";
+        Logger::instance().logText(Logger::ConsoleSink, LogLevel::Info, stats);
+        Logger::instance().logText(logSink, LogLevel::Info, stats);
+        std::string policyStats = policy->statsLine();
+        if (!policyStats.empty()) Logger::instance().logText(logSink, LogLevel::Info, policyStats);
+    }
+
+    const RoutingPolicy& getPolicy() const {
+        return *policy;
+    }
+
+    // Tasks and cores over the current servers
+    const GroupLoad& getServerLoad() const {
+        return serverLoad;
+    }
+
+    // Affinity counters and the load imbalance so far
+    AffinityStats getAffinityStats() const {
+        AffinityStats stats = affinity;
+        long long most = 0, total = 0;
+        for (const auto& server : servers) {
+            int id = server->getServerID();
+            long long count = static_cast<size_t>(id) < dispatchedTo.size() ? dispatchedTo[id] : 0;
+            most = std::max(most, count);
+            total += count;
         }
+        stats.imbalance = total > 0 ? static_cast<double>(most) * servers.size() / total : 0.0;
+        return stats;
+    }
 
-        if (minUtilization >= 1.0) {
-            std::cerr << "All servers at maximum capacity. Task " 
-                      << task.id << " queued for later processing." << std::endl;
-            return;
+    // Bound the backlog (0 rejects every task no server can take right away) and choose what to shed when it is full.
+    // Tasks waiting longer than maxWait simulation seconds are shed too (0 waits forever).
+    void setBacklog(size_t capacity, OverflowPolicy policy = OverflowPolicy::RejectNew, double maxWait = 0.0) {
+        std::lock_guard<std::mutex> lock(backlogMutex);
+        backlogCapacity = capacity;
+        overflowPolicy = policy;
+        maxBacklogWait = std::max(0.0, maxWait);
+    }
+
+    AdmissionStats getAdmissionStats() const {
+        std::lock_guard<std::mutex> lock(backlogMutex);
+        AdmissionStats stats = admission;
+        stats.backlog = backlog.size();
+        return stats;
+    }
+
+    void logAdmissionStats() {
+        AdmissionStats stats = getAdmissionStats();
+        for (int sink : {static_cast<int>(Logger::ConsoleSink), logSink}) {
+            Logger::instance().log(sink, LogLevel::Info,
+                                   "Admission: Received: {}, Dispatched: {}, Deferred: {}, Rejected: {}, Dropped: {}, Expired: {}",
+                                   stats.received, stats.dispatched, stats.deferred, stats.rejected, stats.dropped, stats.expired);
+            Logger::instance().log(sink, LogLevel::Info,
+                                   "Backlog: Drop rate: {.2}%, Remaining: {}, Max: {}, Average Wait: {} seconds",
+                                   stats.dropRate() * 100, stats.backlog, stats.maxBacklog, stats.backlogWait.mean);
+            if (hedging == HedgingPolicy::None) continue;
+            Logger::instance().log(sink, LogLevel::Info,
+                                   "Hedging: Copies: {}, Skipped: {}, Started: {}, Copy wins: {}, Cancelled queued: {}, Preempted: {}",
+                                   hedgeStats.hedged, hedgeStats.skipped, hedgeStats.started, hedgeStats.copyWins,
+                                   hedgeStats.cancelledQueued, hedgeStats.preempted);
         }
+    }
 
-        if (bestServer != -1) {
-            std::cout << "Task " << task.id << " sent to Server " << bestServer << std::endl;
-            servers[bestServer - 1]->addTask(task.id, task.time); 
-            logTask(task, bestServer);
-            taskQueue.pop();
-        } else {
-            std::cerr << "No available servers to handle the task." << std::endl;
+    // Append the admission counters, drop rate and admitted throughput over simTime seconds to a results file
+    void writeAdmissionReport(const std::string& path, double simTime) const {
+        AdmissionStats stats = getAdmissionStats();
+        std::ofstream report(path, std::ios::app);
+        if (!report.is_open()) {
+            std::cerr << "Failed to open log file!" << std::endl;
+            return;
+        }
+        report << "Load Balancer, Received: " << stats.received
+               << ", Dispatched: " << stats.dispatched
+               << ", Deferred: " << stats.deferred
+               << ", Rejected: " << stats.rejected
+               << ", Dropped: " << stats.dropped
+               << ", Expired: " << stats.expired
+               << ", Drop rate: " << stats.dropRate() * 100 << "%"
+               << ", Dispatch rate: " << (simTime > 0.0 ? stats.dispatched / simTime : 0.0) << " tasks/s"
+               << ", Backlog remaining: " << stats.backlog
+               << ", Max backlog: " << stats.maxBacklog
+               << ", Backlog wait mean: " << stats.backlogWait.mean << " max: " << (stats.backlogWait.count ? stats.backlogWait.max : 0.0)
+               << "\n";
+        AffinityStats keyed = getAffinityStats();
+        if (keyed.keyed > 0) {
+            report << "Affinity, Keyed: " << keyed.keyed
+                   << ", New keys: " << keyed.newKeys
+                   << ", Same server: " << keyed.sameServer
+                   << ", Moved: " << keyed.moved
+                   << ", Hit rate: " << keyed.hitRate() * 100 << "%"
+                   << ", Load imbalance (max/mean): " << keyed.imbalance
+                   << "\n";
+        }
+        std::string policyStats = policy->statsLine();
+        if (!policyStats.empty()) report << policyStats << "\n";
+        if (hedging != HedgingPolicy::None) {
+            report << "Hedging, Copies: " << hedgeStats.hedged
+                   << ", Skipped: " << hedgeStats.skipped
+                   << ", Started: " << hedgeStats.started
+                   << ", Copy wins: " << hedgeStats.copyWins
+                   << ", Cancelled queued: " << hedgeStats.cancelledQueued
+                   << ", Preempted: " << hedgeStats.preempted
+                   << "\n";
         }
     }
 
-    void logTask(const Task& task, int serverId) {
-        if (logFile.is_open()) {
-            logFile << "Task ID: " << task.id 
-                    << ", Assigned to Server: " << serverId 
-                    << ", Server Current Utilization: " << serverUtilization[serverId] 
-                    << "\n";
+    // Duplicate tasks to a second server, after `delay` simulation seconds (Delayed) or at once (Immediate).
+    // Needs a virtual clock (setClock) and servers with cancellation enabled whose completion callback calls taskFinished.
+    void setHedging(HedgingPolicy policy, double delay = 0.0) {
+        hedging = policy;
+        hedgeDelay = std::max(0.0, delay);
+    }
+
+    // A server finished a task: the other copy, if any, lost and is cancelled
+    void taskFinished(int serverId, int taskId) {
+        auto found = hedges.find(taskId);
+        if (found == hedges.end()) return;
+        Hedge hedge = found->second;
+        hedges.erase(found);
+        if (serverId == hedge.copy) ++hedgeStats.copyWins;
+        std::shared_ptr<ServerQueue> loser = findServer(serverId == hedge.primary ? hedge.copy : hedge.primary);
+        if (!loser) return;
+        switch (loser->cancelTask(taskId)) {
+            case ServerQueue::CancelResult::Dequeued:
+                ++hedgeStats.cancelledQueued;
+                break;
+            case ServerQueue::CancelResult::Preempted:
+                ++hedgeStats.preempted;
+                break;
+            default:
+                break;
         }
     }
 
+    HedgeStats getHedgeStats() const {
+        return hedgeStats;
+    }
+
+    // Timestamp backlog waits with clock (without one, waits and maxWait are not measured)
+    void setClock(GlobalClock* globalClock) {
+        clock = globalClock;
+    }
+
+    // Also record assignments to a binary trace, timestamped with clock
+    void setTrace(TraceWriter* traceWriter, GlobalClock* globalClock) {
+        trace = traceWriter;
+        clock = globalClock;
+    }
+
+    // Hand routed tasks to `deliver` instead of calling the chosen server's addTask; it returns
+    // false when the task was not accepted. The parallel simulation uses it to reach servers on other threads.
+    void setDispatcher(std::function<bool(ServerQueue&, const Task&)> deliver) {
+        dispatcher = std::move(deliver);
+    }
+
     bool hasPendingTasks() const {
-        return !taskQueue.empty();
+        return backlogSize.load() > 0;
+    }
+
+    size_t getBacklogSize() const {
+        return backlogSize.load();
     }
 
     void setServers(const std::vector<std::shared_ptr<ServerQueue>>& serverArray) {
+        for (const auto& server : servers) server->setGroupLoad(nullptr);
         servers = serverArray;
+        serverById.clear();
+        for (const auto& server : servers) {
+            int id = server->getServerID();
+            if (id < 0) continue;
+            if (static_cast<size_t>(id) >= serverById.size()) {
+                serverById.resize(id + 1);
+            }
+            serverById[id] = server;
+        }
+        for (const auto& server : servers) server->setGroupLoad(&serverLoad);
+        policy->serversChanged(targets());
+    }
+
+    // A server joins: new tasks may go to it from now on (Maglev moves about 1/n of the keys to it).
+    // Like removeServer, call it from the routing thread (virtual time) or while no server reports utilization.
+    void addServer(const std::shared_ptr<ServerQueue>& server) {
+        int id = server->getServerID();
+        if (id < 0 || findServer(id)) return;
+        if (static_cast<size_t>(id) >= serverById.size()) serverById.resize(id + 1);
+        serverById[id] = server;
+        servers.push_back(server);
+        server->setGroupLoad(&serverLoad);
+        if (static_cast<size_t>(id) < retired.size()) retired[id] = 0;
+        serverUtilization.update(id, server->getUtilization());
+        policy->serversChanged(targets());
+        Logger::instance().log(logSink, LogLevel::Info, "Server {} joined at time: {} secs.", id, currentTime());
+        if (backlogSize.load() > 0) drainBacklog();
+    }
+
+    // A server leaves: it gets no new tasks and finishes the ones it holds
+    void removeServer(int serverId) {
+        if (!findServer(serverId)) return;
+        servers.erase(std::remove_if(servers.begin(), servers.end(),
+                                     [serverId](const std::shared_ptr<ServerQueue>& server) { return server->getServerID() == serverId; }),
+                      servers.end());
+        serverById[serverId]->setGroupLoad(nullptr);
+        serverById[serverId].reset();
+        if (static_cast<size_t>(serverId) >= retired.size()) retired.resize(serverId + 1, 0);
+        retired[serverId] = 1;
+        serverUtilization.remove(serverId);
+        policy->serversChanged(targets());
+        Logger::instance().log(logSink, LogLevel::Info, "Server {} left at time: {} secs.", serverId, currentTime());
+    }
+
+private:
+    double currentTime() const {
+        return clock ? clock->getCurrentTime() : 0.0;
+    }
+
+    ServerQueueTargets targets() const {
+        return ServerQueueTargets(servers, serverById, &serverLoad);
+    }
+
+    // Called with backlogMutex held
+    void shedTask(const Task& task, double now, const char* reason) {
+        if (trace) {
+            trace->record(makeTraceRecord(TraceEventType::TaskShed, now, task.id, 0, task.time));
+        }
+        Logger::instance().log(Logger::ConsoleSink, LogLevel::Warning, "Task {} shed by the load balancer.", task.id);
+        Logger::instance().logText(logSink, LogLevel::Warning, "Task ID: " + std::to_string(task.id) + ", Shed: " + reason);
+    }
+
+    // Route one task to a server, returns false when no server can take it now
+    bool dispatch(const Task& task) {
+        int leastUtilized = -1;
+        double minUtilization = 1e9;
+        serverUtilization.best(leastUtilized, minUtilization);
+        if (servers.empty() || minUtilization >= 1.0) {
+            return false;
+        }
+
+        auto decisionStart = std::chrono::steady_clock::now();
+        int bestServer = policy->selectServerForKey(task.key, targets(), serverUtilization);
+        totalDecisionNanos += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - decisionStart).count();
+        ++decisions;
+
+        std::shared_ptr<ServerQueue> server = findServer(bestServer);
+        if (!server) {
+            Logger::instance().log(Logger::ConsoleSink, LogLevel::Error, "No available servers to handle the task.");
+            return false;
+        }
+        if (!deliver(*server, task)) {
+            return false;
+        }
+        Logger::instance().log(Logger::ConsoleSink, LogLevel::Info, "Task {} sent to Server {}", task.id, bestServer);
+        logTask(task, bestServer);
+        recordDispatch(task, bestServer);
+        if (hedging != HedgingPolicy::None) startHedge(task, bestServer);
+        return true;
+    }
+
+    // Called from dispatch, while routing
+    void recordDispatch(const Task& task, int serverId) {
+        if (static_cast<size_t>(serverId) >= dispatchedTo.size()) dispatchedTo.resize(serverId + 1, 0);
+        ++dispatchedTo[serverId];
+        if (task.key == 0) return;
+        ++affinity.keyed;
+        auto [last, inserted] = lastServerForKey.try_emplace(task.key, serverId);
+        if (inserted) {
+            ++affinity.newKeys;
+        } else if (last->second == serverId) {
+            ++affinity.sameServer;
+        } else {
+            ++affinity.moved;
+            last->second = serverId;
+        }
+    }
+
+    bool deliver(ServerQueue& server, const Task& task) {
+        return dispatcher ? dispatcher(server, task) : server.addTask(task.id, task.time, task.generationTime, task.label);
+    }
+
+    // Called from dispatch, while routing
+    void startHedge(const Task& task, int primary) {
+        Hedge& hedge = hedges[task.id];
+        hedge = Hedge{task, primary, -1};
+        if (hedging == HedgingPolicy::Immediate) {
+            sendCopy(hedge);
+            return;
+        }
+        if (!clock) return;
+        int taskId = task.id;
+        clock->addTimer(clock->getCurrentTime() + hedgeDelay, [this, taskId]() {
+            auto found = hedges.find(taskId);
+            if (found == hedges.end() || found->second.copy >= 0) return;  // Finished in time
+            // The copy needs the same service time, so once the primary has started it a copy rarely finishes first
+            std::shared_ptr<ServerQueue> primary = findServer(found->second.primary);
+            if (primary && !primary->isQueued(taskId)) {
+                ++hedgeStats.started;
+                return;
+            }
+            // Route like drainBacklog, so the copy's addTask callbacks leave the policy alone
+            if (routing.exchange(true)) return;
+            sendCopy(found->second);
+            routing = false;
+            if (drainRequested.load()) drainBacklog();
+        });
+    }
+
+    // The copy goes where the policy says, or to the least utilized other server when the policy picks the primary again
+    void sendCopy(Hedge& hedge) {
+        int target = policy->selectServer(targets(), serverUtilization);
+        ++decisions;
+        if (target == hedge.primary || !findServer(target)) {
+            target = -1;
+            double lowest = 1.0;
+            for (const auto& server : servers) {
+                int id = server->getServerID();
+                double utilization = serverUtilization.get(id);
+                if (id != hedge.primary && utilization < lowest) {
+                    lowest = utilization;
+                    target = id;
+                }
+            }
+        }
+        std::shared_ptr<ServerQueue> server = findServer(target);
+        if (!server || !deliver(*server, hedge.task)) {
+            ++hedgeStats.skipped;
+            return;
+        }
+        hedge.copy = target;
+        ++hedgeStats.hedged;
+        Logger::instance().log(logSink, LogLevel::Info, "Task ID: {}, Hedged to Server: {}", hedge.task.id, target);
+        logTask(hedge.task, target);
+    }
+
+    // Dispatch backlog tasks in FIFO order until it is empty or no server can take the head.
+    // Whichever thread holds `routing` also serves requests made meanwhile by other threads
+    // (and by its own addTask callbacks), so no drain is lost and routing never re-enters.
+    void drainBacklog() {
+        drainRequested = true;
+        while (drainRequested.load() && !routing.exchange(true)) {
+            drainRequested = false;
+            drainOnce();
+            routing = false;
+        }
+    }
+
+    void drainOnce() {
+        while (true) {
+            BacklogEntry entry;
+            {
+                std::lock_guard<std::mutex> lock(backlogMutex);
+                expireOldTasks();
+                if (backlog.empty()) break;
+                entry = backlog.front();
+                backlog.pop_front();
+                backlogSize = backlog.size();
+            }
+            if (dispatch(entry.task)) {
+                std::lock_guard<std::mutex> lock(backlogMutex);
+                ++admission.dispatched;
+                if (entry.deferred) admission.backlogWait.add(currentTime() - entry.enqueueTime);
+                continue;
+            }
+            // Nobody can take the head: put it back in front and wait for utilization to drop
+            std::lock_guard<std::mutex> lock(backlogMutex);
+            if (backlogCapacity == 0) {
+                ++admission.rejected;
+                shedTask(entry.task, currentTime(), "no server available, rejected");
+                continue;
+            }
+            if (!entry.deferred) {
+                entry.deferred = true;
+                ++admission.deferred;
+                Logger::instance().log(Logger::ConsoleSink, LogLevel::Warning,
+                                       "All servers at maximum capacity. Task {} queued for later processing.", entry.task.id);
+            }
+            backlog.push_front(entry);
+            backlogSize = backlog.size();
+            break;
+        }
+    }
+
+    // Called with backlogMutex held
+    void expireOldTasks() {
+        if (maxBacklogWait <= 0.0 || !clock) return;
+        double now = currentTime();
+        while (!backlog.empty() && now - backlog.front().enqueueTime > maxBacklogWait) {
+            ++admission.expired;
+            shedTask(backlog.front().task, now, "waited too long in the backlog");
+            backlog.pop_front();
+        }
+    }
+
+    std::shared_ptr<ServerQueue> findServer(int serverId) const {
+        if (serverId < 0 || static_cast<size_t>(serverId) >= serverById.size()) {
+            return nullptr;
+        }
+        return serverById[serverId];
     }
 };
 
@@ -0,0 +1,131 @@
+#ifndef LOAD_GENERATOR_H
+#define LOAD_GENERATOR_H
+
+#if defined(__linux__)
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "Histogram.h"
+
+// Closed-loop TCP client for TcpProxy and BackendServer (Linux only): every connection sends one line,
+// waits for the answer and sends the next, until the time is up. The latency of a request is measured
+// from before the connect when reconnecting, so it includes the connection setup the client sees.
+
+struct LoadResult {
+    long long requests = 0;  // Answered with the line that was sent
+    long long busy = 0;      // Answered "BUSY"
+    long long errors = 0;    // Failed connects, resets and wrong answers
+    double seconds = 0.0;
+    LatencyHistogram latency;  // Answered requests only
+
+    double requestsPerSecond() const {
+        return seconds > 0.0 ? requests / seconds : 0.0;
+    }
+};
+
+class LoadGenerator {
+public:
+    LoadGenerator(const std::string& host, uint16_t port) : host(host), port(port) {}
+
+    // `connections` concurrent clients for `seconds`; reconnect opens a new connection for every request
+    LoadResult run(int connections, double seconds, bool reconnect = false) {
+        std::vector<LoadResult> results(std::max(1, connections));
+        std::vector<std::thread> clients;
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < results.size(); ++i) {
+            clients.emplace_back([&, i]() { runClient(static_cast<int>(i), deadline, reconnect, results[i]); });
+        }
+        for (auto& client : clients) client.join();
+        LoadResult total;
+        total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        for (const LoadResult& result : results) {
+            total.requests += result.requests;
+            total.busy += result.busy;
+            total.errors += result.errors;
+            total.latency.merge(result.latency);
+        }
+        return total;
+    }
+
+private:
+    std::string host;
+    uint16_t port;
+
+    int connectOnce() const {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        timeval timeout{5, 0};  // A lost answer must not hang the run
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        inet_pton(AF_INET, host.c_str(), &address.sin_addr);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void runClient(int id, std::chrono::steady_clock::time_point deadline, bool reconnect, LoadResult& result) const {
+        int fd = -1;
+        std::string answer;
+        for (long long sequence = 0; std::chrono::steady_clock::now() < deadline; ++sequence) {
+            auto start = std::chrono::steady_clock::now();
+            if (fd < 0 && (fd = connectOnce()) < 0) {
+                ++result.errors;
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));  // Do not spin on a refusing proxy
+                continue;
+            }
+            std::string request = "task " + std::to_string(id) + " " + std::to_string(sequence);
+            std::string line = request + "\n";
+            bool ok = send(fd, line.data(), line.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(line.size()) &&
+                      readLine(fd, answer);
+            if (ok && answer == request) {
+                ++result.requests;
+                result.latency.record(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            } else if (ok && answer == "BUSY") {
+                ++result.busy;
+            } else {
+                ++result.errors;
+                ok = false;
+            }
+            if (!ok || reconnect) {
+                close(fd);
+                fd = -1;
+            }
+        }
+        if (fd >= 0) close(fd);
+    }
+
+    // One answer line, without the newline; only one request is in flight, so everything received belongs to it
+    static bool readLine(int fd, std::string& line) {
+        line.clear();
+        char buffer[256];
+        while (true) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) return false;
+            line.append(buffer, static_cast<size_t>(received));
+            if (line.back() == '\n') {
+                line.pop_back();
+                return true;
+            }
+        }
+    }
+};
+
+#endif // __linux__
+
+#endif // LOAD_GENERATOR_H
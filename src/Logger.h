@@ -0,0 +1,315 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <type_traits>
+#include <charconv>
+#include "RingBuffer.h"
+
+enum class LogLevel { Debug, Info, Warning, Error };
+
+// Asynchronous logger shared by all components.
+// Each thread appends fixed-size records to its own lock-free buffer; formatting and
+// file I/O happen on one background writer that batches a single write per sink.
+//
+// Messages use {} placeholders: integers print as integers, doubles like std::to_string,
+// {.N} prints a double with N decimals and {g} like the default ostream format.
+// Format strings must be string literals, they are only read by the writer thread.
+class Logger {
+public:
+    static constexpr int ConsoleSink = 0;  // Terminal only, no file
+
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    // Open (append) a log file, returns -1 on failure. Echoed sinks are also written to the terminal.
+    int openSink(const std::string& path, bool echoToConsole = false) {
+        std::FILE* file = std::fopen(path.c_str(), "a");
+        if (!file) return -1;
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        sinks.push_back(Sink{file, echoToConsole, {}});
+        return static_cast<int>(sinks.size() - 1);
+    }
+
+    // Flush pending records and close the file; later records for this sink are dropped
+    void closeSink(int sinkId) {
+        if (sinkId <= ConsoleSink) return;
+        flush();
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        if (static_cast<size_t>(sinkId) < sinks.size() && sinks[sinkId].file) {
+            std::fclose(sinks[sinkId].file);
+            sinks[sinkId].file = nullptr;
+        }
+    }
+
+    template <typename... Args>
+    void log(int sinkId, LogLevel level, const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MaxArgs, "Too many log arguments");
+        if (sinkId < 0 || level < minimumLevel.load(std::memory_order_relaxed)) return;
+        Record record;
+        record.sink = sinkId;
+        record.level = level;
+        record.format = format;
+        record.argCount = 0;
+        (record.add(args), ...);
+        push(record);
+    }
+
+    // Pre-formatted text, for cold paths that already hold a std::string
+    void logText(int sinkId, LogLevel level, const std::string& text) {
+        if (sinkId < 0 || level < minimumLevel.load(std::memory_order_relaxed)) return;
+        Record record;
+        record.sink = sinkId;
+        record.level = level;
+        record.format = nullptr;
+        record.text = text;
+        push(record);
+    }
+
+    void setLevel(LogLevel level) {
+        minimumLevel = level;
+    }
+
+    // Turn terminal output off entirely (files are still written)
+    void setConsoleEcho(bool enabled) {
+        consoleEcho = enabled;
+    }
+
+    // Block until every record logged by this thread so far has been written
+    void flush() {
+        std::unique_lock<std::mutex> lock(controlMutex);
+        uint64_t target = ++flushRequested;
+        wakeWriter.notify_one();
+        flushDone.wait(lock, [&]() { return flushCompleted >= target; });
+    }
+
+    ~Logger() {
+        {
+            std::lock_guard<std::mutex> lock(controlMutex);
+            stopping = true;
+        }
+        wakeWriter.notify_one();
+        if (writerThread.joinable()) {
+            writerThread.join();
+        }
+        for (auto& sink : sinks) {
+            if (sink.file) std::fclose(sink.file);
+        }
+    }
+
+private:
+    static constexpr int MaxArgs = 6;
+    static constexpr size_t ThreadBufferSize = 8192;
+
+    enum class ArgType : uint8_t { Integer, Real };
+
+    struct Record {
+        int sink;
+        LogLevel level;
+        const char* format;
+        uint8_t argCount;
+        ArgType types[MaxArgs];
+        union {
+            long long integer;
+            double real;
+        } args[MaxArgs];
+        std::string text;
+
+        template <typename T>
+        void add(T value) {
+            static_assert(std::is_arithmetic<T>::value, "Log arguments must be numbers");
+            if (std::is_floating_point<T>::value) {
+                types[argCount] = ArgType::Real;
+                args[argCount].real = static_cast<double>(value);
+            } else {
+                types[argCount] = ArgType::Integer;
+                args[argCount].integer = static_cast<long long>(value);
+            }
+            ++argCount;
+        }
+    };
+
+    struct ThreadBuffer {
+        RingBuffer<Record> records{ThreadBufferSize};
+    };
+
+    struct Sink {
+        std::FILE* file;
+        bool echo;
+        std::string batch;
+    };
+
+    std::atomic<LogLevel> minimumLevel{LogLevel::Debug};
+    std::atomic<bool> consoleEcho{true};
+
+    std::mutex bufferMutex;  // Guards the list of thread buffers (registration only)
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+
+    std::mutex sinkMutex;
+    std::vector<Sink> sinks;
+    std::string consoleBatch;
+    std::string errorBatch;
+
+    std::mutex controlMutex;
+    std::condition_variable wakeWriter;
+    std::condition_variable flushDone;
+    uint64_t flushRequested = 0;
+    uint64_t flushCompleted = 0;
+    bool stopping = false;
+    std::atomic<bool> writerBehind{false};  // A producer found its buffer full
+    std::thread writerThread;
+
+    Logger() {
+        sinks.push_back(Sink{nullptr, true, {}});  // ConsoleSink
+        writerThread = std::thread(&Logger::runWriter, this);
+    }
+
+    ThreadBuffer& localBuffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer) {
+            buffer = std::make_shared<ThreadBuffer>();
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            buffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void push(const Record& record) {
+        ThreadBuffer& buffer = localBuffer();
+        while (!buffer.records.tryPush(record)) {
+            // Buffer full: wake the writer and let it catch up instead of dropping the record
+            if (!writerBehind.exchange(true)) {
+                std::lock_guard<std::mutex> lock(controlMutex);
+                wakeWriter.notify_one();
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    // std::to_chars matches printf's %lld, %f, %.Nf and %g output without locale overhead
+    static void appendNumber(std::string& out, const char* spec, size_t specLength, ArgType type, long long integer, double real) {
+        char text[352];  // Enough for any double in fixed notation
+        std::to_chars_result result;
+        if (type == ArgType::Integer) {
+            result = std::to_chars(text, text + sizeof(text), integer);
+        } else if (specLength == 1 && spec[0] == 'g') {
+            result = std::to_chars(text, text + sizeof(text), real, std::chars_format::general, 6);
+        } else if (specLength >= 2 && spec[0] == '.') {
+            result = std::to_chars(text, text + sizeof(text), real, std::chars_format::fixed, std::atoi(spec + 1));
+        } else {
+            result = std::to_chars(text, text + sizeof(text), real, std::chars_format::fixed, 6);
+        }
+        if (result.ec == std::errc()) {
+            out.append(text, result.ptr - text);
+        }
+    }
+
+    static void format(std::string& out, const Record& record) {
+        if (!record.format) {
+            out += record.text;
+            out += '\n';
+            return;
+        }
+        int next = 0;
+        for (const char* c = record.format; *c; ++c) {
+            if (*c == '{') {
+                const char* close = c + 1;
+                while (*close && *close != '}') ++close;
+                if (*close == '}' && next < record.argCount) {
+                    appendNumber(out, c + 1, close - c - 1, record.types[next],
+                                 record.args[next].integer, record.args[next].real);
+                    ++next;
+                    c = close;
+                    continue;
+                }
+            }
+            out += *c;
+        }
+        out += '\n';
+    }
+
+    // Returns the number of records written
+    size_t drain() {
+        std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(bufferMutex);
+            snapshot = buffers;
+        }
+
+        std::lock_guard<std::mutex> lock(sinkMutex);
+        bool echo = consoleEcho.load();
+        Record record;
+        std::string line;
+        size_t written = 0;
+        for (auto& buffer : snapshot) {
+            while (buffer->records.tryPop(record)) {
+                ++written;
+                if (static_cast<size_t>(record.sink) >= sinks.size()) continue;
+                Sink& sink = sinks[record.sink];
+                line.clear();
+                format(line, record);
+                if (sink.file) sink.batch += line;
+                if (echo && sink.echo) {
+                    (record.level >= LogLevel::Warning ? errorBatch : consoleBatch) += line;
+                }
+            }
+        }
+
+        // One write per sink per pass
+        for (auto& sink : sinks) {
+            if (sink.file && !sink.batch.empty()) {
+                std::fwrite(sink.batch.data(), 1, sink.batch.size(), sink.file);
+                std::fflush(sink.file);
+            }
+            sink.batch.clear();
+        }
+        if (!consoleBatch.empty()) {
+            std::fwrite(consoleBatch.data(), 1, consoleBatch.size(), stdout);
+            std::fflush(stdout);
+            consoleBatch.clear();
+        }
+        if (!errorBatch.empty()) {
+            std::fwrite(errorBatch.data(), 1, errorBatch.size(), stderr);
+            errorBatch.clear();
+        }
+        return written;
+    }
+
+    void runWriter() {
+        while (true) {
+            uint64_t target;
+            bool stop;
+            {
+                std::unique_lock<std::mutex> lock(controlMutex);
+                wakeWriter.wait_for(lock, std::chrono::milliseconds(2), [this]() {
+                    return stopping || flushRequested != flushCompleted || writerBehind.load();
+                });
+                target = flushRequested;
+                stop = stopping;
+            }
+            writerBehind = false;
+            // Keep draining while producers are ahead so a full buffer never waits for the timeout
+            while (drain() >= ThreadBufferSize / 2 && !stop) {
+            }
+            {
+                std::lock_guard<std::mutex> lock(controlMutex);
+                flushCompleted = target;
+            }
+            flushDone.notify_all();
+            if (stop) break;
+        }
+    }
+};
+
+#endif // LOGGER_H
@@ -0,0 +1,195 @@
+#ifndef MAGLEV_TABLE_H
+#define MAGLEV_TABLE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+// Maglev consistent-hash lookup table (Eisenbud et al., NSDI 2016): a prime number of slots, each holding a
+// server ID, so a key maps to a server with one hash and one array read. Every server walks its own
+// permutation of the slots (offset and skip from hashes of its ID); a full build lets the servers claim
+// their next free slot in turn, so their slot counts differ by at most one.
+//
+// Joins and leaves are incremental instead of a full rebuild. A leaving server's slots are freed and the
+// others claim them in turn along their permutations; a joining server walks its permutation taking slots
+// from servers above the new fair share. Only the slots that must change owner change, so the keys that
+// move are the leaving server's, or the joining server's new ones, and nothing else. The table can then
+// differ from what a full build would give; the balance stays within a slot or two per server.
+// Not thread safe.
+class MaglevTable {
+public:
+    static constexpr size_t DefaultSize = 65537;  // Prime; grows with the number of servers (see build)
+
+    explicit MaglevTable(size_t minimumSize = DefaultSize) : minimumSize(std::max<size_t>(minimumSize, 3)) {}
+
+    // Populate from scratch. The size is the first prime at or above both minimumSize and 100 slots per
+    // server, so one slot more or less is at most a 1% imbalance.
+    void build(std::vector<int> serverIds) {
+        std::sort(serverIds.begin(), serverIds.end());
+        serverIds.erase(std::unique(serverIds.begin(), serverIds.end()), serverIds.end());
+        serverIds.erase(std::remove_if(serverIds.begin(), serverIds.end(), [](int id) { return id < 0; }), serverIds.end());
+        slots.assign(nextPrime(std::max(minimumSize, serverIds.size() * 100)), -1);
+        members.clear();
+        memberOf.clear();
+        for (int id : serverIds) addMember(id);
+        lastMoved = slots.size();
+        fill(0);
+    }
+
+    // A server joins: it takes slots from servers holding more than the new fair share. Returns the slots moved.
+    size_t add(int serverId) {
+        if (serverId < 0 || contains(serverId)) return lastMoved = 0;
+        if (members.empty() || (members.size() + 1) * 100 > slots.size()) {
+            std::vector<int> ids = serverIds();
+            ids.push_back(serverId);
+            build(ids);  // Too few slots per server to stay balanced: grow the table
+            return lastMoved;
+        }
+        Member& joining = addMember(serverId);
+        size_t floorShare = slots.size() / members.size();
+        size_t moved = 0;
+        for (size_t step = 0; step < 2 * slots.size() && joining.owned < floorShare; ++step) {
+            size_t slot = advance(joining);
+            int owner = slots[slot];
+            if (owner == serverId) continue;
+            if (owner >= 0 && members[memberOf[owner]].owned <= floorShare) continue;
+            if (owner >= 0) --members[memberOf[owner]].owned;
+            slots[slot] = serverId;
+            ++joining.owned;
+            ++moved;
+        }
+        return lastMoved = moved;
+    }
+
+    // A server leaves: its slots go to the others in turn. Returns the slots moved.
+    size_t remove(int serverId) {
+        if (!contains(serverId)) return lastMoved = 0;
+        size_t freed = 0;
+        for (int& owner : slots) {
+            if (owner == serverId) {
+                owner = -1;
+                ++freed;
+            }
+        }
+        size_t index = memberOf[serverId];
+        memberOf[serverId] = -1;
+        members.erase(members.begin() + index);
+        for (size_t i = index; i < members.size(); ++i) memberOf[members[i].id] = static_cast<int>(i);
+        if (members.empty()) {
+            slots.assign(slots.size(), -1);
+        } else {
+            fill(slots.size() - freed);
+        }
+        return lastMoved = freed;
+    }
+
+    // Server for a key hash, -1 when the table is empty
+    int lookup(uint64_t keyHash) const {
+        return slots.empty() ? -1 : slots[slotOf(keyHash)];
+    }
+
+    size_t slotOf(uint64_t keyHash) const {
+        return static_cast<size_t>(keyHash % slots.size());
+    }
+
+    int at(size_t slot) const {
+        return slots[slot % slots.size()];
+    }
+
+    bool contains(int serverId) const {
+        return serverId >= 0 && static_cast<size_t>(serverId) < memberOf.size() && memberOf[serverId] >= 0;
+    }
+
+    // Slots a server holds (its share of the keys is this over size())
+    size_t owned(int serverId) const {
+        return contains(serverId) ? members[memberOf[serverId]].owned : 0;
+    }
+
+    std::vector<int> serverIds() const {
+        std::vector<int> ids;
+        for (const Member& member : members) ids.push_back(member.id);
+        return ids;
+    }
+
+    size_t size() const {
+        return slots.size();
+    }
+
+    size_t serverCount() const {
+        return members.size();
+    }
+
+    // Slots whose server changed in the last build, add or remove (a build counts every slot)
+    size_t getLastMoved() const {
+        return lastMoved;
+    }
+
+    // SplitMix64 finalizer: spreads sequential keys and IDs over every bit
+    static uint64_t hash(uint64_t value) {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    }
+
+private:
+    struct Member {
+        int id;
+        size_t skip;
+        size_t position;  // Next slot of its permutation to try
+        size_t owned = 0;
+    };
+
+    size_t minimumSize;
+    std::vector<int> slots;    // Slot -> server ID, -1 while unassigned
+    std::vector<Member> members;
+    std::vector<int> memberOf;  // Server ID -> index in members, -1 when absent
+    size_t lastMoved = 0;
+
+    Member& addMember(int serverId) {
+        uint64_t offsetHash = hash(static_cast<uint64_t>(serverId) * 2 + 1);
+        uint64_t skipHash = hash(static_cast<uint64_t>(serverId) * 2 + 2);
+        Member member{serverId, static_cast<size_t>(skipHash % (slots.size() - 1)) + 1,
+                      static_cast<size_t>(offsetHash % slots.size())};
+        if (static_cast<size_t>(serverId) >= memberOf.size()) memberOf.resize(serverId + 1, -1);
+        memberOf[serverId] = static_cast<int>(members.size());
+        members.push_back(member);
+        return members.back();
+    }
+
+    // Current slot of the member's permutation, then step to the next one (the table size is prime, so
+    // every skip visits every slot)
+    size_t advance(Member& member) {
+        size_t slot = member.position;
+        member.position = (member.position + member.skip) % slots.size();
+        return slot;
+    }
+
+    // Members claim their next free slot in turn until no slot is free
+    void fill(size_t filled) {
+        while (filled < slots.size()) {
+            for (Member& member : members) {
+                size_t slot = advance(member);
+                while (slots[slot] >= 0) slot = advance(member);
+                slots[slot] = member.id;
+                ++member.owned;
+                if (++filled == slots.size()) return;
+            }
+        }
+    }
+
+    static size_t nextPrime(size_t value) {
+        auto isPrime = [](size_t n) {
+            if (n < 2) return false;
+            for (size_t divisor = 2; divisor * divisor <= n; ++divisor) {
+                if (n % divisor == 0) return false;
+            }
+            return true;
+        };
+        while (!isPrime(value)) ++value;
+        return value;
+    }
+};
+
+#endif // MAGLEV_TABLE_H
@@ -0,0 +1,82 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <iterator>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a whole file: memory-mapped where available, read into memory otherwise
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+#if defined(_WIN32)
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return;
+        fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        fileData = fallback.data();
+        fileSize = fallback.size();
+        opened = true;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            opened = true;
+            fileSize = static_cast<size_t>(info.st_size);
+            if (fileSize > 0) {
+                void* mapping = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED) {
+                    madvise(mapping, fileSize, MADV_SEQUENTIAL);
+                    fileData = static_cast<const char*>(mapping);
+                } else {
+                    opened = false;
+                    fileSize = 0;
+                }
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (fileData) munmap(const_cast<char*>(fileData), fileSize);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return opened; }
+    std::string_view view() const { return std::string_view(fileData ? fileData : "", fileSize); }
+
+    // Drop the pages before `offset` from this process; they are read back from the file if touched again.
+    // Keeps the resident size flat while streaming through a file much larger than memory.
+    void release(size_t offset) {
+#if !defined(_WIN32)
+        if (!fileData) return;
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t length = (offset < fileSize ? offset : fileSize) / page * page;
+        if (length > 0) madvise(const_cast<char*>(fileData), length, MADV_DONTNEED);
+#else
+        (void)offset;
+#endif
+    }
+
+private:
+    const char* fileData = nullptr;
+    size_t fileSize = 0;
+    bool opened = false;
+#if defined(_WIN32)
+    std::string fallback;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,91 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free bounded ring buffer (Vyukov's sequence-per-cell scheme).
+// Any number of producers and consumers; tryPush fails instead of blocking when the ring is full.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity)
+        : ringCapacity(capacity > 0 ? capacity : 1), cells(new Cell[ringCapacity]) {
+        for (size_t i = 0; i < ringCapacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    bool tryPush(const T& value) {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos % ringCapacity];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Full: the consumer has not released this cell yet
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true) {
+            cell = &cells[pos % ringCapacity];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;  // Empty
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = cell->value;
+        cell->sequence.store(pos + ringCapacity, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate while other threads are pushing or popping
+    size_t size() const {
+        size_t tail = enqueuePos.load(std::memory_order_acquire);
+        size_t head = dequeuePos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return ringCapacity;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t ringCapacity;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> enqueuePos{0};  // Separate cache lines for producers and consumers
+    alignas(64) std::atomic<size_t> dequeuePos{0};
+};
+
+#endif // RING_BUFFER_H
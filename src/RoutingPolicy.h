@@ -0,0 +1,351 @@
+#ifndef ROUTING_POLICY_H
+#define ROUTING_POLICY_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <limits>
+#include <cstdint>
+#include <sstream>
+#include "UtilizationIndex.h"
+#include "MaglevTable.h"
+
+enum class RoutingPolicyType {
+    LowestUtilization,
+    RoundRobin,
+    WeightedRoundRobin,
+    JoinShortestQueue,
+    PowerOfDChoices,
+    LeastExpectedWork,
+    Maglev  // Consistent hashing on the task key, optionally with bounded loads
+};
+
+// What the policies read about the servers they choose from, by position 0..size()-1. LoadBalancer
+// adapts its ServerQueues to it and TcpProxy its backends, so both route with the same policies.
+class RoutingTargets {
+public:
+    virtual ~RoutingTargets() = default;
+    virtual size_t size() const = 0;
+    virtual int id(size_t index) const = 0;              // What selectServer returns
+    virtual bool available(int) const { return true; }  // By ID; false skips it (a proxy backend marked down)
+    virtual double weight(size_t index) const = 0;       // Relative capacity (processing power)
+    virtual size_t queueLength(size_t index) const = 0;  // Waiting tasks (a backend's active connections)
+    virtual double expectedWork(size_t index) const = 0; // Seconds of work ahead of a new task
+    virtual int tasksInSystem(size_t index) const = 0;   // Queued and in service
+    virtual int cores(size_t index) const = 0;
+
+    // Sums over every target (O(n)); views that keep running totals override them with O(1) reads
+    virtual long long totalTasksInSystem() const {
+        long long total = 0;
+        for (size_t i = 0; i < size(); ++i) total += tasksInSystem(i);
+        return total;
+    }
+
+    virtual long long totalCores() const {
+        long long total = 0;
+        for (size_t i = 0; i < size(); ++i) total += cores(i);
+        return total;
+    }
+};
+
+// Strategy used by LoadBalancer::sendTask and TcpProxy to pick a server.
+// selectServer returns a server ID, or -1 when no server is available.
+// Not thread safe: concurrent routers (the proxy's event loops) each use their own instance, except for
+// policies that must see every decision (sharedAcrossRouters), which one instance serves under a lock.
+class RoutingPolicy {
+public:
+    virtual ~RoutingPolicy() = default;
+    virtual std::string name() const = 0;
+    virtual int selectServer(const RoutingTargets& targets, const UtilizationIndex& utilization) = 0;
+
+    // For a task with a session or cache key (0 for none); only key-aware policies look at it
+    virtual int selectServerForKey(uint64_t, const RoutingTargets& targets, const UtilizationIndex& utilization) {
+        return selectServer(targets, utilization);
+    }
+
+    // The servers changed (set, joined or left)
+    virtual void serversChanged(const RoutingTargets&) {}
+
+    // Policy-specific counters for the report, empty when there are none
+    virtual std::string statsLine() const {
+        return "";
+    }
+
+    virtual bool sharedAcrossRouters() const {
+        return false;
+    }
+
+protected:
+    // Available server with the lowest score, -1 when none is
+    template <typename Score>
+    static int lowest(const RoutingTargets& targets, Score score) {
+        int bestServer = -1;
+        auto best = std::numeric_limits<decltype(score(size_t(0)))>::max();
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (!targets.available(targets.id(i))) continue;
+            auto value = score(i);
+            if (value < best) {
+                best = value;
+                bestServer = targets.id(i);
+            }
+        }
+        return bestServer;
+    }
+
+    // O(1) from the index; a scan only when its best server is unavailable
+    static int lowestUtilization(const RoutingTargets& targets, const UtilizationIndex& utilization) {
+        int bestServer = -1;
+        double minUtilization = 0.0;
+        if (utilization.best(bestServer, minUtilization) && targets.available(bestServer)) return bestServer;
+        return lowest(targets, [&](size_t i) { return utilization.get(targets.id(i)); });
+    }
+};
+
+// Least utilized server from the blended queue/service-time metric (O(1))
+class LowestUtilizationPolicy : public RoutingPolicy {
+public:
+    std::string name() const override { return "Lowest Utilization"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex& utilization) override {
+        return lowestUtilization(targets, utilization);
+    }
+};
+
+// Cycle through the servers in order (O(1))
+class RoundRobinPolicy : public RoutingPolicy {
+public:
+    std::string name() const override { return "Round Robin"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex&) override {
+        for (size_t tried = 0; tried < targets.size(); ++tried) {
+            next %= targets.size();
+            int id = targets.id(next++);
+            if (targets.available(id)) return id;
+        }
+        return -1;
+    }
+
+private:
+    size_t next = 0;
+};
+
+// Smooth weighted round robin with processingPower as the weight (O(n))
+class WeightedRoundRobinPolicy : public RoutingPolicy {
+public:
+    std::string name() const override { return "Weighted Round Robin"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex&) override {
+        if (currentWeight.size() != targets.size()) {
+            currentWeight.assign(targets.size(), 0.0);
+        }
+        double totalWeight = 0.0;
+        int best = -1;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            if (!targets.available(targets.id(i))) continue;
+            double weight = targets.weight(i);
+            currentWeight[i] += weight;
+            totalWeight += weight;
+            if (best < 0 || currentWeight[i] > currentWeight[best]) best = static_cast<int>(i);
+        }
+        if (best < 0) return -1;
+        currentWeight[best] -= totalWeight;
+        return targets.id(best);
+    }
+
+    // Separate instances would each start their sequence on the heaviest server, so a burst spread over
+    // the routers would all land there
+    bool sharedAcrossRouters() const override {
+        return true;
+    }
+
+private:
+    std::vector<double> currentWeight;
+};
+
+// Fewest queued tasks (O(n))
+class JoinShortestQueuePolicy : public RoutingPolicy {
+public:
+    std::string name() const override { return "Join Shortest Queue"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex&) override {
+        return lowest(targets, [&](size_t i) { return targets.queueLength(i); });
+    }
+};
+
+// Sample d servers at random and join the shortest of them (O(d)); the least utilized when every sample is unavailable
+class PowerOfDChoicesPolicy : public RoutingPolicy {
+public:
+    explicit PowerOfDChoicesPolicy(int choices = 2, unsigned seed = std::random_device{}())
+        : d(std::max(1, choices)), rng(seed) {}
+
+    std::string name() const override { return "Power of " + std::to_string(d) + " Choices"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex& utilization) override {
+        if (targets.size() == 0) return -1;
+        std::uniform_int_distribution<size_t> pick(0, targets.size() - 1);
+        int bestServer = -1;
+        size_t shortest = std::numeric_limits<size_t>::max();
+        for (int i = 0; i < d; ++i) {
+            size_t candidate = pick(rng);
+            if (!targets.available(targets.id(candidate))) continue;
+            size_t length = targets.queueLength(candidate);
+            if (length < shortest) {
+                shortest = length;
+                bestServer = targets.id(candidate);
+            }
+        }
+        return bestServer >= 0 ? bestServer : lowestUtilization(targets, utilization);
+    }
+
+private:
+    int d;
+    std::mt19937 rng;
+};
+
+// Least queued service time divided by power, plus the in-flight remainder (O(n))
+class LeastExpectedWorkPolicy : public RoutingPolicy {
+public:
+    std::string name() const override { return "Least Expected Work"; }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex&) override {
+        return lowest(targets, [&](size_t i) { return targets.expectedWork(i); });
+    }
+};
+
+// Maglev counters: how often bounded loads moved a key off its server, and how many slots membership changes moved
+struct MaglevStats {
+    long long lookups = 0;
+    long long spills = 0;     // Keys sent past their own server because it was over the load bound
+    long long joins = 0;
+    long long leaves = 0;
+    long long rebuilds = 0;   // Full builds (the first one, and growing the table)
+    long long slotsMoved = 0; // By joins and leaves
+    double lastChurn = 0.0;   // Fraction of the slots (so of the keys) the last join or leave moved
+};
+
+// Key -> server through a Maglev table, so a key keeps its server (and its warm cache) while the servers
+// stay the same, and only about 1/n of the keys move when one joins or leaves. O(1) per task.
+// With loadBound > 0 (consistent hashing with bounded loads): a server whose tasks per core would go over
+// loadBound times the average passes the key on to the next server along the table, as does an unavailable
+// one. The average comes from the targets' running totals, so each server checked is O(1); at most 1/loadBound
+// of the servers can be over the bound, so a spilled key usually finds one within a few slots.
+// Tasks without a key are spread over the table by a counter.
+class MaglevPolicy : public RoutingPolicy {
+public:
+    explicit MaglevPolicy(double loadBound = 0.0, size_t tableSize = MaglevTable::DefaultSize)
+        : loadBound(loadBound > 0.0 ? std::max(1.0, loadBound) : 0.0), table(tableSize) {}
+
+    std::string name() const override {
+        if (loadBound <= 0.0) return "Maglev";
+        std::ostringstream text;
+        text << "Maglev (load bound " << loadBound << ")";
+        return text.str();
+    }
+
+    int selectServer(const RoutingTargets& targets, const UtilizationIndex& utilization) override {
+        return selectServerForKey(0, targets, utilization);
+    }
+
+    int selectServerForKey(uint64_t key, const RoutingTargets& targets, const UtilizationIndex&) override {
+        if (table.serverCount() != targets.size()) serversChanged(targets);
+        if (table.serverCount() == 0) return -1;
+        ++stats.lookups;
+        size_t slot = table.slotOf(MaglevTable::hash(key != 0 ? key : ++unkeyed | (1ULL << 63)));
+        int server = table.at(slot);
+        // One more task may take a server to this many tasks per core
+        double limit = loadBound > 0.0 ? loadBound * (targets.totalTasksInSystem() + 1.0) / targets.totalCores() : 0.0;
+        if (usable(targets, server, limit)) return server;
+        // Next usable server along the table; none: stay with the key's own server if it is available
+        for (size_t probe = 1; probe <= 4 * table.serverCount(); ++probe) {
+            int next = table.at(slot + probe);
+            if (next != server && usable(targets, next, limit)) {
+                ++stats.spills;
+                return next;
+            }
+        }
+        return targets.available(server) ? server : -1;
+    }
+
+    // Joins and leaves update the table incrementally; the first call builds it
+    void serversChanged(const RoutingTargets& targets) override {
+        indexById.clear();
+        std::vector<int> ids;
+        for (size_t i = 0; i < targets.size(); ++i) {
+            int id = targets.id(i);
+            if (id < 0) continue;
+            ids.push_back(id);
+            if (static_cast<size_t>(id) >= indexById.size()) indexById.resize(id + 1, -1);
+            indexById[id] = static_cast<int>(i);
+        }
+        if (table.serverCount() == 0) {
+            table.build(ids);
+            ++stats.rebuilds;
+            return;
+        }
+        for (int id : table.serverIds()) {
+            if (static_cast<size_t>(id) >= indexById.size() || indexById[id] < 0) recordChange(table.remove(id), stats.leaves);
+        }
+        for (int id : ids) {
+            if (table.contains(id)) continue;
+            size_t size = table.size();
+            recordChange(table.add(id), stats.joins);
+            if (table.size() != size) ++stats.rebuilds;
+        }
+    }
+
+    std::string statsLine() const override {
+        std::ostringstream line;
+        line << "Maglev, Table size: " << table.size() << ", Servers: " << table.serverCount()
+             << ", Lookups: " << stats.lookups << ", Spills: " << stats.spills << ", Joins: " << stats.joins
+             << ", Leaves: " << stats.leaves << ", Rebuilds: " << stats.rebuilds << ", Slots moved: " << stats.slotsMoved
+             << ", Last churn: " << stats.lastChurn * 100 << "%";
+        return line.str();
+    }
+
+    MaglevStats getStats() const {
+        return stats;
+    }
+
+    const MaglevTable& getTable() const {
+        return table;
+    }
+
+private:
+    double loadBound;
+    MaglevTable table;
+    std::vector<int> indexById;  // Server ID -> position in the targets, -1 when absent
+    uint64_t unkeyed = 0;
+    MaglevStats stats;
+
+    void recordChange(size_t moved, long long& counter) {
+        ++counter;
+        stats.slotsMoved += static_cast<long long>(moved);
+        stats.lastChurn = static_cast<double>(moved) / table.size();
+    }
+
+    // Available, and without a load bound or with one more task keeping it within `limit` tasks (queued and
+    // in service) per core
+    bool usable(const RoutingTargets& targets, int serverId, double limit) const {
+        int index = serverId >= 0 && static_cast<size_t>(serverId) < indexById.size() ? indexById[serverId] : -1;
+        if (index < 0 || !targets.available(serverId)) return false;
+        return loadBound <= 0.0 || (targets.tasksInSystem(index) + 1.0) / targets.cores(index) <= limit;
+    }
+};
+
+// seed only matters for the randomized policies (power of d choices); loadBound only for Maglev
+inline std::unique_ptr<RoutingPolicy> makeRoutingPolicy(RoutingPolicyType type, unsigned seed = std::random_device{}(),
+                                                        double loadBound = 0.0) {
+    switch (type) {
+        case RoutingPolicyType::RoundRobin: return std::make_unique<RoundRobinPolicy>();
+        case RoutingPolicyType::WeightedRoundRobin: return std::make_unique<WeightedRoundRobinPolicy>();
+        case RoutingPolicyType::JoinShortestQueue: return std::make_unique<JoinShortestQueuePolicy>();
+        case RoutingPolicyType::PowerOfDChoices: return std::make_unique<PowerOfDChoicesPolicy>(2, seed);
+        case RoutingPolicyType::LeastExpectedWork: return std::make_unique<LeastExpectedWorkPolicy>();
+        case RoutingPolicyType::Maglev: return std::make_unique<MaglevPolicy>(loadBound);
+        case RoutingPolicyType::LowestUtilization:
+        default: return std::make_unique<LowestUtilizationPolicy>();
+    }
+}
+
+#endif // ROUTING_POLICY_H
@@ -12,115 +12,530 @@
 #include <vector>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
 #include "GlobalClock.h"
+#include "RingBuffer.h"
+#include "Logger.h"
+#include "TraceFormat.h"
+#include "KpiEngine.h"
+#include "Executor.h"
+#include "Scheduling.h"
+
+// Tasks (queued and in service) and cores over a group of servers, kept by the servers themselves so a
+// routing decision reads the group's load in O(1) (see ServerQueue::setGroupLoad)
+struct GroupLoad {
+    std::atomic<long long> tasksInSystem{0};
+    std::atomic<long long> cores{0};
+};
 
 class ServerQueue {
+public:
+    // What cancelTask found
+    enum class CancelResult {
+        NotFound,   // Finished already, never here, or cancellation is off
+        Dequeued,   // Was waiting in the queue
+        Preempted   // Was in service; its core is free again
+    };
+
 private:
     struct Task {
         int taskID;
         double serviceTime;
+        double generationTime;  // Created by the TaskGenerator, for end-to-end delay
         double arrivalTime;
+        double startTime;   // Of the last stretch of service
         double finishTime;
+        TaskLabel label;
+        double servedTime = 0.0;    // Service before the last suspension (ShortestRemainingTime)
+        double suspendTime = -1.0;  // When it was last put back in the queue, -1 if never
+    };
+
+    // One service slot; a server runs `cores` of them against the same queue
+    struct Core {
+        std::atomic<double> serviceEndTime{0.0};  // Finish time of the in-flight task, 0 when idle
+        std::atomic<double> busyTime{0.0};        // Simulation seconds spent serving
+        std::atomic<int> tasksServed{0};
+        std::atomic<int> taskID{-1};              // Task in service, -1 when idle
+        std::atomic<double> serviceStartTime{0.0};
+        unsigned serviceGeneration = 0;  // Bumped by a preemption so the pending completion is ignored
+        Task task;  // In service; read by preemption in virtual time only
     };
 
     int serverID;
-    double processingPower;
+    double processingPower;  // Per core
     int fixedQueueSize;
-    std::queue<Task> taskQueue;
+    int cores = 1;
+    std::unique_ptr<Core[]> coreSlots;
+    std::atomic<int> busyCores{0};
+    RingBuffer<Task> taskQueue;  // Lock-free intake sized from fixedQueueSize
+    std::unique_ptr<TaskScheduler<Task>> scheduler;  // Replaces the ring for every discipline but FIFO (virtual time)
+    int suspendedTasks = 0;
+    // Running aggregates updated on push and pop, so utilization is O(1)
+    std::atomic<int> queuedTasks{0};
+    std::atomic<double> queuedServiceTime{0.0};  // Sum of service times waiting in taskQueue
     GlobalClock* globalClock;
-    std::mutex queueMutex;
+    std::mutex queueMutex;  // Only used to park workers when the ring is empty
     std::condition_variable taskNotifier;
+    std::atomic<int> parkedWorkers{0};
+    std::atomic<bool> stealHint{false};  // A peer has queued work and this server has idle cores
     std::atomic<bool> isRunning;
-    std::thread processingThread;
+    std::vector<std::thread> processingThreads;  // One per core in real-time mode without an executor
+    int reservedCores = 0;  // Event-driven modes: cores with a service start or completion pending
+    std::vector<int> idleCores;  // Event-driven modes: free service slots
+
+    // Real time with an executor: service steps run on its shared threads and sleep on clock timers,
+    // so a server costs no thread of its own
+    Executor* executor = nullptr;
+    std::mutex coreMutex;  // Executor mode: guards reservedCores and idleCores
+    // Executor mode: queued and sleeping steps hold this, so they can tell the server has stopped
+    struct Lifetime {
+        std::atomic<bool> alive{true};
+        std::atomic<int> running{0};  // Steps executing right now
+    };
+    std::shared_ptr<Lifetime> lifetime;
 
-    double totalWaitTime = 0.0;
-    int processedTasks = 0;
+    // Written by the worker and read by the summary calls, hence atomic
+    std::atomic<double> totalWaitTime{0.0};
+    std::atomic<int> processedTasks{0};
 
-    int totalQueueSize = 0;
-    int queueSizeUpdates = 0;
+    std::atomic<double> totalTimingError{0.0};  // Sum of (actual - scheduled) finish times, real time only
+    std::atomic<double> maxTimingError{0.0};
+    std::atomic<int> timedTasks{0};             // Completions whose timing error was measured
+    std::atomic<int> completedTasks{0};
+
+    std::atomic<long long> totalQueueSize{0};
+    std::atomic<int> queueSizeUpdates{0};
 
     std::function<void(std::pair<int, double>)> utilizationCallback;
+    double utilizationThreshold = 0.0;  // Minimum change before a new utilization is published
+    std::atomic<double> publishedUtilization{-1.0};
 
-    std::ofstream logFile;
-    static std::mutex terminalMutex;
+    int logSink = -1;  // Logger sink for this server's log file (echoed to the terminal)
+    TraceWriter* trace = nullptr;  // Optional binary trace shared with the other components
+    KpiEngine* kpis = nullptr;     // Optional online KPI engine shared with the other servers
+    std::atomic<GroupLoad*> groupLoad{nullptr};  // Optional totals shared with the other servers
 
-    void log(const std::string& message) {
-        std::lock_guard<std::mutex> lock(terminalMutex);
+    std::vector<ServerQueue*> peers;  // Work stealing: servers this one may take queued tasks from
+    std::atomic<bool> stealing{false};  // Publishes peers to the worker threads that are already running
+    std::atomic<int> stolenTasks{0};
 
-        // Output to the terminal in real-time
-        std::cout << message << std::endl;
+    // Cancellation (virtual time): the ring cannot remove from the middle, so a cancelled task stays in it
+    // as a tombstone and is skipped when it reaches the head. The map says which queued tasks are still wanted.
+    struct QueuedTask {
+        double serviceTime;
+        double queuedSince;  // Arrival, or the last suspension
+        int taskClass;
+    };
+    bool cancellable = false;
+    std::unordered_map<int, QueuedTask> queuedById;  // Task ID -> queued task, while cancellation is on
+    int tombstones = 0;  // Cancelled tasks still in taskQueue
+    int cancelledTasks = 0;
+    int preemptedTasks = 0;
+    std::function<void(int, int)> completionCallback;  // (server ID, task ID) after every finished task
+
+    // A task entered (+1) or left (-1) this server
+    void countInGroup(int delta) {
+        GroupLoad* group = groupLoad.load();
+        if (group) group->tasksInSystem += delta;
+    }
 
-        // Write to the file
-        if (logFile.is_open()) {
-            logFile << message << std::endl;
+    void traceEvent(TraceEventType type, double simTime, int taskID, double serviceTime, size_t queueLength, double utilization = 0.0) {
+        if (trace) {
+            trace->record(makeTraceRecord(type, simTime, taskID, serverID, serviceTime, queueLength, utilization));
         }
     }
 
-    void recordQueueSize() {
-        totalQueueSize += taskQueue.size();
-        ++queueSizeUpdates;
+    template <typename... Args>
+    void log(LogLevel level, const char* format, Args... args) {
+        Logger::instance().log(logSink, level, format, args...);
     }
 
-    void processTasks() {
-        while (isRunning) {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            taskNotifier.wait(lock, [this]() { return !taskQueue.empty() || !isRunning; });
+    void recordTimingError(double error) {
+        atomicAdd(totalTimingError, error);
+        double currentMax = maxTimingError.load(std::memory_order_relaxed);
+        while (error > currentMax && !maxTimingError.compare_exchange_weak(currentMax, error, std::memory_order_relaxed)) {
+        }
+        ++timedTasks;
+    }
+
+    static void atomicAdd(std::atomic<double>& target, double value) {
+        double current = target.load(std::memory_order_relaxed);
+        while (!target.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+        }
+    }
 
-            if (!isRunning) break;
+    // Ring (FIFO) or the discipline's queue; false when the queue is full. The task is already counted in queuedTasks.
+    bool enqueue(const Task& task) {
+        if (scheduler) {
+            if (queuedTasks.load() > fixedQueueSize) return false;
+            scheduler->push(task, schedulingKey(task), task.label.priority);
+            return true;
+        }
+        bool pushed = taskQueue.tryPush(task);
+        if (!pushed && tombstones > 0) {
+            purgeCancelled();
+            pushed = taskQueue.tryPush(task);
+        }
+        return pushed;
+    }
 
-            Task task = taskQueue.front();
-            taskQueue.pop();
+    bool dequeue(Task& task) {
+        return scheduler ? scheduler->pop(task) : taskQueue.tryPop(task);
+    }
 
-            recordQueueSize();
-            log("Server " + std::to_string(serverID) + 
-                " current task queue size: " + std::to_string(taskQueue.size()));
+    bool queueEmpty() const {
+        return scheduler ? scheduler->empty() : taskQueue.empty();
+    }
 
-            lock.unlock();
+    // Heap order: work left for the size-based disciplines (at power 1), the deadline for EDF
+    double schedulingKey(const Task& task) const {
+        if (scheduler->getDiscipline() == SchedulingDiscipline::EarliestDeadlineFirst) return task.label.deadline;
+        return task.serviceTime;
+    }
 
-            double currentTime = globalClock->getCurrentTime();
+    bool popTask(Task& task) {
+        while (dequeue(task)) {
+            if (cancellable && queuedById.erase(task.taskID) == 0) {
+                --tombstones;  // Cancelled while it waited; the aggregates were adjusted then
+                continue;
+            }
+            --queuedTasks;
+            atomicAdd(queuedServiceTime, -task.serviceTime);
+            return true;
+        }
+        return false;
+    }
+
+    // Rewrite the ring without its tombstones, keeping the order of the live tasks
+    void purgeCancelled() {
+        std::vector<Task> live;
+        Task task;
+        while (taskQueue.tryPop(task)) {
+            if (queuedById.count(task.taskID)) live.push_back(task);
+        }
+        for (const Task& kept : live) {
+            taskQueue.tryPush(kept);
+        }
+        tombstones = 0;
+    }
+
+    // Sleep on the condition variable only when the ring is empty; producers skip the mutex otherwise
+    void parkUntilWork() {
+        std::unique_lock<std::mutex> lock(queueMutex);
+        ++parkedWorkers;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        taskNotifier.wait(lock, [this]() { return !taskQueue.empty() || stealHint.load() || !isRunning; });
+        --parkedWorkers;
+        stealHint = false;
+    }
+
+    void wakeWorker() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parkedWorkers.load() > 0) {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            taskNotifier.notify_one();
+        }
+    }
+
+    // Own queue first, then (with work stealing on) the oldest queued task of the most loaded peer.
+    // Only queued tasks move; in-flight ones stay where they are.
+    bool takeTask(Task& task) {
+        return popTask(task) || (stealing.load(std::memory_order_acquire) && stealFromPeer(task));
+    }
+
+    bool stealFromPeer(Task& task) {
+        ServerQueue* victim = nullptr;
+        int mostQueued = 0;
+        for (ServerQueue* peer : peers) {
+            int queued = peer->queuedTasks.load();
+            if (queued > mostQueued) {
+                mostQueued = queued;
+                victim = peer;
+            }
+        }
+        if (!victim || !victim->popTask(task)) return false;
+
+        double now = globalClock->getCurrentTime();
+        ++stolenTasks;
+        if (kpis) kpis->taskStolen(victim->serverID, serverID, task.suspendTime >= 0.0 ? task.suspendTime : task.arrivalTime, now);
+        log(LogLevel::Info, "Server {} stole task {} from server {} at time: {} secs.", serverID, task.taskID, victim->serverID, now);
+        victim->calculateQueueUtilization();
+        return true;
+    }
+
+    // Called after queuing a task that has to wait: hand it to the first peer with an idle core
+    void offerWork() {
+        for (ServerQueue* peer : peers) {
+            if (peer->acceptStealRequest()) return;
+        }
+    }
+
+    bool acceptStealRequest() {
+        if (!isRunning) return false;
+        if (eventDriven()) return reserveCore();
+        if (parkedWorkers.load() == 0) return false;
+        stealHint = true;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        taskNotifier.notify_one();
+        return true;
+    }
+
+    void recordQueueSize() {
+        totalQueueSize += queuedTasks.load();
+        ++queueSizeUpdates;
+    }
+
+    // Pop-side bookkeeping shared by the threaded and event-driven paths, returns the adjusted service time
+    double beginService(Task& task, int core) {
+        double currentTime = globalClock->getCurrentTime();
+        task.startTime = currentTime;
+        if (task.suspendTime >= 0.0) {
+            // Its wait was counted when it first started
+            traceEvent(TraceEventType::ServiceResume, currentTime, task.taskID, task.serviceTime, std::max(0, queuedTasks.load()));
+            if (kpis) kpis->serviceResumed(serverID, task.suspendTime, currentTime, task.label.taskClass);
+            log(LogLevel::Info, "Server {} resumed task {} with {} seconds of work left at time: {} secs.",
+                serverID, task.taskID, task.serviceTime, currentTime);
+        } else {
+            traceEvent(TraceEventType::ServiceStart, currentTime, task.taskID, task.serviceTime, std::max(0, queuedTasks.load()));
             double waitTime = currentTime - task.arrivalTime;
-            totalWaitTime += waitTime;
+            atomicAdd(totalWaitTime, waitTime);
             processedTasks++;
+            if (kpis) kpis->serviceStarted(serverID, task.arrivalTime, currentTime, task.label.taskClass);
+            log(LogLevel::Info, "Server {} is processing task {} with service time: {} seconds, waited: {} seconds at time: {} secs.",
+                serverID, task.taskID, task.serviceTime, waitTime, currentTime);
+        }
 
-            log("Server " + std::to_string(serverID) + 
-                " is processing task " + std::to_string(task.taskID) +
-                " with service time: " + std::to_string(task.serviceTime) +
-                " seconds, waited: " + std::to_string(waitTime) +
-                " seconds at time: " + std::to_string(currentTime) + " secs.");
+        double adjustedServiceTime = task.serviceTime / processingPower;
+        Core& slot = coreSlots[core];
+        slot.serviceEndTime = currentTime + adjustedServiceTime;
+        slot.serviceStartTime = currentTime;
+        slot.taskID = task.taskID;
+        slot.task = task;
+        ++busyCores;
+        return adjustedServiceTime;
+    }
 
-            double adjustedServiceTime = task.serviceTime / processingPower;
+    void finishService(Task& task, int core) {
+        task.finishTime = globalClock->getCurrentTime();
+        Core& slot = coreSlots[core];
+        slot.serviceEndTime = 0.0;
+        slot.taskID = -1;
+        atomicAdd(slot.busyTime, task.finishTime - task.startTime);
+        ++slot.tasksServed;
+        --busyCores;
+        countInGroup(-1);
+        if (kpis) {
+            kpis->serviceFinished(serverID, task.generationTime, task.startTime, task.finishTime, task.label.taskClass,
+                                  task.servedTime + task.finishTime - task.startTime, task.label.deadline);
+        }
+
+        traceEvent(TraceEventType::TaskFinished, task.finishTime, task.taskID, task.serviceTime, 0);
+        log(LogLevel::Info, "Task ID: {} Task Finished Time: {} secs.", task.taskID, task.finishTime);
+        if (completionCallback) completionCallback(serverID, task.taskID);
+    }
+
+    // Worker loop for one core; all cores pop from the same queue
+    void processTasks(int core) {
+        while (isRunning) {
+            Task task;
+            if (!takeTask(task)) {
+                parkUntilWork();
+                continue;
+            }
+
+            recordQueueSize();
+            log(LogLevel::Info, "Server {} current task queue size: {}", serverID, queuedTasks.load());
+
+            double adjustedServiceTime = beginService(task, core);
 
             double startSimProcessingTime = globalClock->getCurrentTime();
             double endSimProcessingTime = startSimProcessingTime + adjustedServiceTime;
 
-            while(globalClock->getCurrentTime() < endSimProcessingTime) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10)); // Small sleep to avoid busy waiting
+            // Sleep until the clock passes the deadline instead of polling it
+            if (!globalClock->waitUntil(endSimProcessingTime, [this]() { return !isRunning; })) break;
+
+            finishService(task, core);
+            ++completedTasks;
+            recordTimingError(task.finishTime - endSimProcessingTime);
+
+            calculateQueueUtilization();
+
+        }
+    }
+
+    // Virtual time or an executor: service is a chain of scheduled steps instead of a thread per core
+    bool eventDriven() const {
+        return executor || (globalClock && globalClock->isVirtual());
+    }
+
+    // Lock coreMutex when steps can run concurrently (executor mode); virtual time is single threaded
+    std::unique_lock<std::mutex> lockCores() {
+        return executor ? std::unique_lock<std::mutex>(coreMutex) : std::unique_lock<std::mutex>();
+    }
+
+    // Run action at simulation time `time`: an event in virtual time; in executor mode a clock timer
+    // hands it to the executor (at once when the time has come). Steps of a stopped server do nothing.
+    void schedule(double time, GlobalClock::EventType type, std::function<void()> action) {
+        if (!executor) {
+            globalClock->scheduleEvent(time, type, std::move(action));
+            return;
+        }
+        auto step = [lifetime = lifetime, action = std::move(action)]() {
+            ++lifetime->running;
+            if (lifetime->alive.load()) action();
+            --lifetime->running;
+        };
+        if (time <= globalClock->getCurrentTime()) {
+            executor->post(std::move(step));
+        } else {
+            Executor* pool = executor;
+            globalClock->addTimer(time, [pool, step = std::move(step)]() { pool->post(step); });
+        }
+    }
+
+    // Claim a core for a service start if one is free
+    bool reserveCore() {
+        {
+            auto lock = lockCores();
+            if (reservedCores >= cores) return false;
+            ++reservedCores;
+        }
+        schedule(globalClock->getCurrentTime(), GlobalClock::EventType::ServiceStart, [this]() { startNextTask(); });
+        return true;
+    }
+
+    // Event-driven counterpart of processTasks. Runs on a reserved core; the reservation is released
+    // when the queue is empty.
+    void startNextTask() {
+        Task task;
+        if (!isRunning || !takeTask(task)) {
+            {
+                auto lock = lockCores();
+                --reservedCores;
             }
+            // A task pushed while this core was giving up may have found every core reserved
+            if (isRunning && !queueEmpty()) reserveCore();
+            return;
+        }
+
+        recordQueueSize();
+        log(LogLevel::Info, "Server {} current task queue size: {}", serverID, queuedTasks.load());
 
-            task.finishTime = globalClock->getCurrentTime();
+        int core;
+        {
+            auto lock = lockCores();
+            core = idleCores.back();
+            idleCores.pop_back();
+        }
+        double adjustedServiceTime = beginService(task, core);
+        unsigned generation = coreSlots[core].serviceGeneration;
+        schedule(globalClock->getCurrentTime() + adjustedServiceTime, GlobalClock::EventType::ServiceCompletion,
+                 [this, task, core, generation]() mutable {
+                     if (coreSlots[core].serviceGeneration == generation) completeTask(task, core);
+                 });
+    }
 
-            log("Task ID: " + std::to_string(task.taskID) + 
-                " Task Finished Time: " + std::to_string(task.finishTime) + " secs.");
+    void completeTask(Task& task, int core) {
+        // Executor steps wait for the clock tick; virtual-time events fire exactly on time, so there is nothing to measure
+        double timingError = executor ? globalClock->getCurrentTime() - coreSlots[core].serviceEndTime.load() : 0.0;
+        finishService(task, core);
+        {
+            auto lock = lockCores();
+            idleCores.push_back(core);
+        }
+        ++completedTasks;
+        if (executor) recordTimingError(timingError);
+        schedule(globalClock->getCurrentTime(), GlobalClock::EventType::UtilizationUpdate,
+                 [this]() { calculateQueueUtilization(); });
+        schedule(globalClock->getCurrentTime(), GlobalClock::EventType::ServiceStart, [this]() { startNextTask(); });
+    }
 
-            calculateQueueUtilization();
+    // Virtual time: stop the task on `core` (its service so far counts as busy time, its completion is ignored)
+    // and let the core start the next task. Returns when the stretch of service began.
+    double releaseCore(int core, double now) {
+        Core& slot = coreSlots[core];
+        double startTime = slot.serviceStartTime.load();
+        slot.serviceEndTime = 0.0;
+        slot.taskID = -1;
+        ++slot.serviceGeneration;
+        atomicAdd(slot.busyTime, now - startTime);
+        --busyCores;
+        idleCores.push_back(core);
+        schedule(now, GlobalClock::EventType::UtilizationUpdate, [this]() { calculateQueueUtilization(); });
+        schedule(now, GlobalClock::EventType::ServiceStart, [this]() { startNextTask(); });
+        return startTime;
+    }
 
+    // ShortestRemainingTime, every core busy: a task with less work than the longest one in service takes its core
+    void preemptForShorter(double work) {
+        if (!idleCores.empty()) return;  // A core is about to start and will take the shortest task anyway
+        double now = globalClock->getCurrentTime();
+        int longest = -1;
+        double mostWork = work;
+        for (int core = 0; core < cores; ++core) {
+            const Core& slot = coreSlots[core];
+            double workLeft = (slot.serviceEndTime.load() - now) * processingPower;
+            if (slot.taskID.load() >= 0 && workLeft > mostWork) {
+                mostWork = workLeft;
+                longest = core;
+            }
         }
+        if (longest >= 0) suspendService(longest, now);
     }
 
-    void calculateQueueUtilization() {
-        double occupiedQueueUtilization = static_cast<double>(taskQueue.size()) / fixedQueueSize;
+    // Put the task in service back in the queue with the work it has left. The queue may go over its size
+    // by the few suspended tasks, which were admitted before.
+    void suspendService(int core, double now) {
+        Task task = coreSlots[core].task;
+        task.serviceTime = std::max(0.0, (coreSlots[core].serviceEndTime.load() - now) * processingPower);
+        double startTime = releaseCore(core, now);
+        task.servedTime += now - startTime;
+        task.suspendTime = now;
+        ++queuedTasks;
+        atomicAdd(queuedServiceTime, task.serviceTime);
+        scheduler->push(task, schedulingKey(task), task.label.priority);
+        if (cancellable) queuedById[task.taskID] = QueuedTask{task.serviceTime, now, task.label.taskClass};
+        ++suspendedTasks;
+        if (kpis) kpis->serviceSuspended(serverID, startTime, now, task.label.taskClass);
+        traceEvent(TraceEventType::TaskSuspended, now, task.taskID, task.serviceTime, std::max(0, queuedTasks.load()));
+        log(LogLevel::Info, "Server {} suspended task {} with {} seconds of work left at time: {} secs.",
+            serverID, task.taskID, task.serviceTime, now);
+    }
 
-        double totalServiceTime = 0.0;
-        std::queue<Task> tempQueue = taskQueue;
-        while (!tempQueue.empty()) {
-            const Task& task = tempQueue.front();
-            totalServiceTime += task.serviceTime;
-            tempQueue.pop();
+    // Occupancy counts busy cores as well as queued tasks, and queued work drains on every core
+    double computeUtilization() const {
+        int occupied = std::max(0, queuedTasks.load()) + std::max(0, busyCores.load());
+        double occupiedQueueUtilization = static_cast<double>(occupied) / (fixedQueueSize + cores);
+
+        double totalServiceTime = std::max(0.0, queuedServiceTime.load());
+
+        double serviceTimeUtilization = totalServiceTime / (processingPower * cores * fixedQueueSize);
+        return (occupiedQueueUtilization + serviceTimeUtilization) / 2.0;
+    }
+
+    // Publish only significant changes: a move of at least utilizationThreshold,
+    // crossing full capacity (1.0), or dropping to idle
+    bool shouldPublish(double utilization) {
+        double previous = publishedUtilization.load();
+        if (previous >= 0.0 && utilization != 0.0 &&
+            std::abs(utilization - previous) < utilizationThreshold &&
+            (utilization >= 1.0) == (previous >= 1.0)) {
+            return false;
         }
+        return publishedUtilization.compare_exchange_strong(previous, utilization);
+    }
+
+    void calculateQueueUtilization() {
+        double finalUtilization = computeUtilization();
+        if (!shouldPublish(finalUtilization)) return;
 
-        double serviceTimeUtilization = totalServiceTime / (processingPower * fixedQueueSize);
-        double finalUtilization = (occupiedQueueUtilization + serviceTimeUtilization) / 2.0;
-        log( "Server " + std::to_string(serverID) + " utilization updated: "  + std::to_string(finalUtilization * 100 )+ "%.");
+        if (globalClock) {
+            traceEvent(TraceEventType::UtilizationUpdate, globalClock->getCurrentTime(), 0, 0.0,
+                       std::max(0, queuedTasks.load()), finalUtilization);
+        }
+        log(LogLevel::Debug, "Server {} utilization updated: {}%.", serverID, finalUtilization * 100);
 
 
         if (utilizationCallback) {
@@ -130,80 +545,340 @@ private:
 
 public:
     ServerQueue()
-        : serverID(1), processingPower(10), fixedQueueSize(20), globalClock(nullptr),
+        : serverID(1), processingPower(10), fixedQueueSize(20), coreSlots(new Core[1]), taskQueue(20), globalClock(nullptr),
         utilizationCallback(nullptr), isRunning(false), totalQueueSize(0), queueSizeUpdates(0) {
+        idleCores.push_back(0);
 
         // Optional: Open a default log file
-        logFile.open("default_log.txt", std::ios::out | std::ios::app);
+        logSink = Logger::instance().openSink("default_log.txt", true);
     }
 
-    ServerQueue(int id, double power, int queueSize, GlobalClock* clock, std::function<void(std::pair<int, double>)> utilizationCallback)
+    // power is per core; each of the `cores` service slots takes tasks from the same queue.
+    // The log goes to logPath, or server<id>_log.txt when it is empty ("-" for no log file).
+    // In real time, the cores run on `executor` when one is given, instead of a thread each.
+    ServerQueue(int id, double power, int queueSize, GlobalClock* clock, std::function<void(std::pair<int, double>)> utilizationCallback,
+                int cores = 1, const std::string& logPath = "", Executor* executor = nullptr)
         : serverID(id), globalClock(clock), utilizationCallback(utilizationCallback), isRunning(true),
-          totalQueueSize(0), queueSizeUpdates(0), fixedQueueSize(queueSize) {
+          totalQueueSize(0), queueSizeUpdates(0), fixedQueueSize(std::max(1, queueSize)), cores(std::max(1, cores)),
+          taskQueue(std::max(1, queueSize)) {
 
         processingPower = std::clamp(power, 1.0, 100.0);
+        coreSlots.reset(new Core[this->cores]);
+        for (int core = this->cores - 1; core >= 0; --core) {
+            idleCores.push_back(core);
+        }
 
-        logFile.open("server" + std::to_string(serverID) + "_log.txt", std::ios::out | std::ios::app);
+        if (logPath != "-") {
+            logSink = Logger::instance().openSink(logPath.empty() ? "server" + std::to_string(serverID) + "_log.txt" : logPath, true);
+        }
 
-        processingThread = std::thread(&ServerQueue::processTasks, this);
+        // In virtual time the clock drives service through events instead of worker threads
+        if (!globalClock->isVirtual() && executor) {
+            this->executor = executor;
+            lifetime = std::make_shared<Lifetime>();
+        } else if (!globalClock->isVirtual()) {
+            for (int core = 0; core < this->cores; ++core) {
+                processingThreads.emplace_back(&ServerQueue::processTasks, this, core);
+            }
+        }
         calculateQueueUtilization();
     }
 
     ~ServerQueue() {
         stopProcessing();
-        if (processingThread.joinable()) {
-            processingThread.join();
+
+        Logger::instance().closeSink(logSink);
+    }
+
+    // Returns false without queuing the task when the queue is already full.
+    // generationTime is when the task was created; negative means now. label gives the task's class,
+    // priority and deadline to the scheduling discipline and the KPIs.
+    bool addTask(int taskID, double serviceTime, double generationTime = -1.0, const TaskLabel& label = TaskLabel()) {
+        double arrivalTime = globalClock->getCurrentTime();
+        if (generationTime < 0.0) generationTime = arrivalTime;
+        // Count the task before publishing it so the worker never sees it missing from the aggregates
+        ++queuedTasks;
+        atomicAdd(queuedServiceTime, serviceTime);
+        Task task{taskID, serviceTime, generationTime, arrivalTime, 0.0, 0.0, label};
+        if (!enqueue(task)) {
+            --queuedTasks;
+            atomicAdd(queuedServiceTime, -serviceTime);
+            if (kpis) kpis->taskRejected(serverID, label.taskClass);
+            traceEvent(TraceEventType::TaskRejected, arrivalTime, taskID, serviceTime, std::max(0, queuedTasks.load()));
+            log(LogLevel::Warning, "Server {} queue full, rejected task {} at time: {} secs.", serverID, taskID, arrivalTime);
+            return false;
+        }
+        if (cancellable) queuedById[taskID] = QueuedTask{serviceTime, arrivalTime, label.taskClass};
+        countInGroup(1);
+
+        if (kpis) kpis->taskArrived(serverID, arrivalTime, label.taskClass);
+        traceEvent(TraceEventType::TaskAdded, arrivalTime, taskID, serviceTime, std::max(0, queuedTasks.load()));
+        log(LogLevel::Info, "Server {} added task {} with service time: {} at time: {} secs.",
+            serverID, taskID, serviceTime, arrivalTime);
+
+        recordQueueSize();
+        log(LogLevel::Info, "Server {} current task queue size: {}", serverID, queuedTasks.load());
+        calculateQueueUtilization();
+
+        if (eventDriven()) {
+            if (!reserveCore()) {
+                if (scheduler && scheduler->getDiscipline() == SchedulingDiscipline::ShortestRemainingTime) {
+                    preemptForShorter(serviceTime);
+                }
+                if (stealing.load(std::memory_order_acquire)) offerWork();
+            }
+            return true;
         }
 
-        if (logFile.is_open()) {
-            logFile.close();
+        wakeWorker();
+        if (stealing.load(std::memory_order_acquire) && busyCores.load() >= cores) {
+            offerWork();
         }
+        return true;
     }
 
-    bool addTask(int taskID, double serviceTime) {
+    void stopProcessing() {
+        isRunning = false;
         {
             std::lock_guard<std::mutex> lock(queueMutex);
-            double arrivalTime = globalClock->getCurrentTime();
-            taskQueue.push(Task{taskID, serviceTime, arrivalTime});
+            taskNotifier.notify_all();
+        }
+        if (globalClock) {
+            globalClock->wakeWaiters();
+        }
+        if (lifetime) {
+            // Later steps do nothing; wait for the ones already running, as for the threads below
+            lifetime->alive = false;
+            while (lifetime->running.load() > 0) {
+                std::this_thread::yield();
+            }
+        }
 
-            log("Server " + std::to_string(serverID) + 
-                " added task " + std::to_string(taskID) +
-                " with service time: " + std::to_string(serviceTime) +
-                " at time: " + std::to_string(arrivalTime) + " secs.");
+        for (auto& thread : processingThreads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
 
-            recordQueueSize();
-            log("Server " + std::to_string(serverID) + 
-                " current task queue size: " + std::to_string(taskQueue.size()));
-            calculateQueueUtilization();
+    void calculateAverageWaitTime() {
+        int processed = processedTasks.load();
+        double averageWaitTime = (processed > 0) ? totalWaitTime.load() / processed : 0.0;
+        traceEvent(TraceEventType::AverageWaitingTime, globalClock ? globalClock->getCurrentTime() : 0.0, 0, averageWaitTime, 0);
+        log(LogLevel::Info, "Server {} Average Waiting Time: {} seconds.", serverID, averageWaitTime);
+    }
+
+    // Real time only: how late the clock woke the server after each task's scheduled finish. Skipped in virtual
+    // time, where every completion fires exactly on time.
+    void calculateAverageTimingError() {
+        if (globalClock && globalClock->isVirtual()) return;
+        int timed = timedTasks.load();
+        double averageError = (timed > 0) ? totalTimingError.load() / timed : 0.0;
+        log(LogLevel::Info, "Server {} Average Timing Error: {} seconds, Max Timing Error: {} seconds.",
+            serverID, averageError, maxTimingError.load());
+    }
+
+    // Also record events to a binary trace (nullptr to stop)
+    void setTrace(TraceWriter* traceWriter) {
+        trace = traceWriter;
+    }
+
+    // Also report arrivals, service and rejections to a KPI engine (nullptr to stop)
+    void setKpiEngine(KpiEngine* engine) {
+        kpis = engine;
+        if (kpis) kpis->setCores(serverID, cores);
+    }
+
+    // Count this server's tasks and cores in `group` from now on (nullptr to leave it). Work stealing moves
+    // tasks within the group, so the totals stay exact. Switch groups while no task arrives or finishes here
+    // (virtual time: from the clock's thread).
+    void setGroupLoad(GroupLoad* group) {
+        GroupLoad* previous = groupLoad.exchange(group);
+        if (previous == group) return;
+        if (previous) {
+            previous->tasksInSystem -= getTasksInSystem();
+            previous->cores -= cores;
+        }
+        if (group) {
+            group->tasksInSystem += getTasksInSystem();
+            group->cores += cores;
         }
+    }
 
-        taskNotifier.notify_one();
+    // Let idle cores take queued (not in-flight) tasks from the most loaded of these servers; call once, before tasks arrive
+    void enableWorkStealing(const std::vector<std::shared_ptr<ServerQueue>>& servers) {
+        if (stealing.load()) return;
+        for (const auto& server : servers) {
+            if (server.get() != this) peers.push_back(server.get());
+        }
+        stealing.store(true, std::memory_order_release);
+    }
+
+    // Let cancelTask withdraw tasks; task IDs must be unique on this server. Virtual time only, where the
+    // server runs on one thread; returns false (and changes nothing) otherwise. Call before tasks arrive.
+    bool enableCancellation() {
+        if (!globalClock->isVirtual()) return false;
+        cancellable = true;
         return true;
     }
 
-    void stopProcessing() {
-        isRunning = false;
-        taskNotifier.notify_all();
+    // Withdraw a task that has not finished. A queued task is dropped in O(1) and skipped when it reaches
+    // the head of the queue; a task in service is preempted, its service so far counted as busy time, and
+    // the freed core starts the next task.
+    CancelResult cancelTask(int taskID) {
+        if (!cancellable) return CancelResult::NotFound;
+        double now = globalClock->getCurrentTime();
+        auto queued = queuedById.find(taskID);
+        if (queued != queuedById.end()) {
+            QueuedTask task = queued->second;
+            queuedById.erase(queued);
+            ++tombstones;
+            --queuedTasks;
+            countInGroup(-1);
+            atomicAdd(queuedServiceTime, -task.serviceTime);
+            ++cancelledTasks;
+            if (kpis) kpis->taskCancelled(serverID, task.queuedSince, now, task.taskClass);
+            traceEvent(TraceEventType::TaskCancelled, now, taskID, task.serviceTime, std::max(0, queuedTasks.load()));
+            log(LogLevel::Info, "Server {} cancelled queued task {} at time: {} secs.", serverID, taskID, now);
+            schedule(now, GlobalClock::EventType::UtilizationUpdate, [this]() { calculateQueueUtilization(); });
+            return CancelResult::Dequeued;
+        }
+        for (int core = 0; core < cores; ++core) {
+            Core& slot = coreSlots[core];
+            if (slot.taskID.load() != taskID) continue;
+            int taskClass = slot.task.label.taskClass;
+            double startTime = releaseCore(core, now);
+            countInGroup(-1);
+            ++preemptedTasks;
+            if (kpis) kpis->servicePreempted(serverID, startTime, now, taskClass);
+            traceEvent(TraceEventType::TaskPreempted, now, taskID, now - startTime, std::max(0, queuedTasks.load()));
+            log(LogLevel::Info, "Server {} preempted task {} after {} seconds of service at time: {} secs.",
+                serverID, taskID, now - startTime, now);
+            return CancelResult::Preempted;
+        }
+        return CancelResult::NotFound;
+    }
 
-        if (processingThread.joinable()) {
-            processingThread.join();
+    // Serve queued tasks in another order than FIFO. Virtual time only, where the server runs on one thread;
+    // returns false (and stays FIFO) otherwise. Call before tasks arrive.
+    bool setSchedulingDiscipline(SchedulingDiscipline discipline) {
+        if (discipline == SchedulingDiscipline::Fifo) {
+            scheduler.reset();
+            return true;
         }
+        if (!globalClock->isVirtual()) return false;
+        scheduler = std::make_unique<TaskScheduler<Task>>(discipline);
+        return true;
     }
 
-    void calculateAverageWaitTime() {
-        double averageWaitTime = (processedTasks > 0) ? totalWaitTime / processedTasks : 0.0;
-        log("Server " + std::to_string(serverID) + 
-            " Average Waiting Time: " + std::to_string(averageWaitTime) + " seconds.");
+    SchedulingDiscipline getSchedulingDiscipline() const {
+        return scheduler ? scheduler->getDiscipline() : SchedulingDiscipline::Fifo;
+    }
+
+    // Tasks a shorter arrival sent back to the queue (ShortestRemainingTime)
+    int getSuspendedTasks() const {
+        return suspendedTasks;
+    }
+
+    // With cancellation on: the task is waiting in the queue, not yet in service
+    bool isQueued(int taskID) const {
+        return queuedById.count(taskID) > 0;
+    }
+
+    // Called as every task finishes (not when it is cancelled or preempted)
+    void setCompletionCallback(std::function<void(int serverId, int taskID)> callback) {
+        completionCallback = std::move(callback);
+    }
+
+    int getCancelledTasks() const {
+        return cancelledTasks;
+    }
+
+    int getPreemptedTasks() const {
+        return preemptedTasks;
+    }
+
+    // Tasks this server took from its peers
+    int getStolenTasks() const {
+        return stolenTasks.load();
+    }
+
+    int getCores() const {
+        return cores;
+    }
+
+    // Simulation seconds each core has spent serving (finished and preempted tasks)
+    std::vector<double> getCoreBusyTimes() const {
+        std::vector<double> busyTimes;
+        for (int core = 0; core < cores; ++core) {
+            busyTimes.push_back(coreSlots[core].busyTime.load());
+        }
+        return busyTimes;
+    }
+
+    // Busy time, tasks served and utilization of every core since simulation time 0
+    void calculateCoreUtilization() {
+        double elapsed = globalClock ? globalClock->getCurrentTime() : 0.0;
+        for (int core = 0; core < cores; ++core) {
+            double busyTime = coreSlots[core].busyTime.load();
+            log(LogLevel::Info, "Server {} Core {} Busy Time: {} seconds, Tasks: {}, Utilization: {}%.",
+                serverID, core, busyTime, coreSlots[core].tasksServed.load(), elapsed > 0.0 ? busyTime / elapsed * 100 : 0.0);
+        }
+    }
+
+    int getServerID() const {
+        return serverID;
+    }
+
+    double getProcessingPower() const {
+        return processingPower;
+    }
+
+    // Number of tasks waiting in the queue (excludes the in-flight task)
+    size_t getQueueLength() const {
+        return static_cast<size_t>(std::max(0, queuedTasks.load()));
+    }
+
+    // addTask would reject a task now
+    bool isQueueFull() const {
+        return queuedTasks.load() >= fixedQueueSize;
+    }
+
+    // Queued tasks plus tasks in service
+    int getTasksInSystem() const {
+        return std::max(0, queuedTasks.load()) + busyCores.load();
+    }
+
+    double getUtilization() const {
+        return computeUtilization();
+    }
+
+    // Only publish utilization changes of at least this much (0 publishes every change)
+    void setUtilizationThreshold(double threshold) {
+        utilizationThreshold = std::max(0.0, threshold);
+    }
+
+    // Seconds until the server is idle if no more work arrives: queued and in-flight work spread over the cores
+    double getExpectedRemainingWork() const {
+        double now = globalClock->getCurrentTime();
+        double inFlight = 0.0;
+        for (int core = 0; core < cores; ++core) {
+            double endTime = coreSlots[core].serviceEndTime.load();
+            if (endTime > 0.0) inFlight += std::max(0.0, endTime - now);
+        }
+        return (std::max(0.0, queuedServiceTime.load()) / processingPower + inFlight) / cores;
+    }
+
+    int getCompletedTasks() const {
+        return completedTasks;
     }
 
     void calculateAverageQueueOccupancy() {
-        double averageOccupancy = (queueSizeUpdates > 0) ? static_cast<double>(totalQueueSize) / queueSizeUpdates : 0.0;
+        double averageOccupancy = (queueSizeUpdates > 0) ? static_cast<double>(totalQueueSize.load()) / queueSizeUpdates.load() : 0.0;
         int flooredOccupancy = static_cast<int>(std::floor(averageOccupancy));
-        log("Server " + std::to_string(serverID) + 
-            " Average Queue Length: " + std::to_string(flooredOccupancy) + " tasks.");
+        traceEvent(TraceEventType::AverageQueueLength, globalClock ? globalClock->getCurrentTime() : 0.0, 0, 0.0, flooredOccupancy);
+        log(LogLevel::Info, "Server {} Average Queue Length: {} tasks.", serverID, flooredOccupancy);
     }
 };
 
-std::mutex ServerQueue::terminalMutex;
-
 #endif // SERVER_QUEUE_H
@@ -0,0 +1,100 @@
+#ifndef SCHEDULING_H
+#define SCHEDULING_H
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+
+// Order in which a server serves its waiting tasks
+enum class SchedulingDiscipline {
+    Fifo,                  // Arrival order (the lock-free ring, the default)
+    Priority,              // Lowest priority value first, FIFO within a level
+    ShortestJobFirst,      // Smallest service time first, never interrupts a task in service
+    ShortestRemainingTime, // Smallest remaining work first; a shorter arrival preempts the longest task in service
+    EarliestDeadlineFirst  // Earliest deadline first; tasks without one come last
+};
+
+// What a discipline may look at besides the service time
+struct TaskLabel {
+    int taskClass = 0;  // Index into the task classes, for per-class KPIs
+    int priority = 0;   // Lower is served first (0 to TaskScheduler::PriorityLevels - 1)
+    double deadline = std::numeric_limits<double>::infinity();  // Absolute simulation time, infinity for none
+};
+
+// Waiting tasks in the order a discipline serves them. Priority is a bucket queue: one FIFO per level and a
+// cursor at the lowest level that may hold tasks, so push and pop are O(1) but for moving the cursor up past
+// empty levels. The other disciplines keep a binary
+// min-heap on the task's key (service time, remaining work or deadline), ties broken by arrival order: O(log n).
+// FIFO does not use this class; ServerQueue keeps its ring for it. Not thread safe.
+template <typename T>
+class TaskScheduler {
+public:
+    static constexpr int PriorityLevels = 64;
+
+    explicit TaskScheduler(SchedulingDiscipline discipline) : discipline(discipline) {}
+
+    // key orders the heap disciplines; priority (clamped to the levels) orders Priority
+    void push(const T& task, double key, int priority) {
+        ++count;
+        if (discipline == SchedulingDiscipline::Priority) {
+            int level = std::clamp(priority, 0, PriorityLevels - 1);
+            if (static_cast<size_t>(level) >= buckets.size()) buckets.resize(level + 1);  // Only the levels in use
+            buckets[level].push_back(task);
+            lowest = std::min(lowest, level);
+            return;
+        }
+        heap.push_back(Entry{key, nextSequence++, task});
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+
+    bool pop(T& task) {
+        if (count == 0) return false;
+        --count;
+        if (discipline == SchedulingDiscipline::Priority) {
+            while (buckets[lowest].empty()) ++lowest;
+            task = buckets[lowest].front();
+            buckets[lowest].pop_front();
+            return true;
+        }
+        std::pop_heap(heap.begin(), heap.end(), later);
+        task = heap.back().task;
+        heap.pop_back();
+        return true;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    SchedulingDiscipline getDiscipline() const {
+        return discipline;
+    }
+
+private:
+    struct Entry {
+        double key;
+        uint64_t sequence;
+        T task;
+    };
+
+    // std heaps keep the largest on top: "later" puts the smallest key, then the oldest entry, there
+    static bool later(const Entry& a, const Entry& b) {
+        if (a.key != b.key) return a.key > b.key;
+        return a.sequence > b.sequence;
+    }
+
+    SchedulingDiscipline discipline;
+    size_t count = 0;
+    std::vector<std::deque<T>> buckets;
+    int lowest = PriorityLevels;  // No level below it holds a task
+    std::vector<Entry> heap;
+    uint64_t nextSequence = 0;
+};
+
+#endif // SCHEDULING_H
@@ -0,0 +1,342 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <filesystem>
+#include "GlobalClock.h"
+#include "LoadBalancer.h"
+#include "Analyzer.h"
+#include "SERVERQUEUE.h"
+#include "TASKGENERATOR.h"
+#include "TraceFormat.h"
+#include "KpiEngine.h"
+#include "Executor.h"
+#include "ParallelSimulation.h"
+
+// A group of identical servers
+struct ServerPool {
+    int count = 1;
+    double power = 15.0;  // Per core
+    int queueSize = 10;
+    int cores = 1;
+};
+
+// Everything one simulation run needs. Defaults are the values main.cpp used to hard-code.
+struct SimulationConfig {
+    double speed = 10;                  // Simulation time = actual time * speed (real time only)
+    double averageServiceTime = 40.0;   // Mean task size, in seconds at power 1
+    double interArrivalTime = 3.0;      // Mean time between generated tasks (simulation seconds)
+    ArrivalProcessType arrivalProcess = ArrivalProcessType::Deterministic;
+    double burstFactor = 5.0;           // MMPP: arrival rate multiplier during bursts
+    double burstDuration = 60.0;        // MMPP: mean burst length
+    double normalDuration = 600.0;      // MMPP: mean time between bursts
+    double diurnalPeriod = 86400.0;     // Diurnal: length of the repeating rate profile
+    std::vector<std::pair<double, double>> diurnalProfile = ArrivalParameters{}.diurnalProfile;  // (time, rate multiplier)
+    ServiceDistributionType serviceDistribution = ServiceDistributionType::Exponential;
+    double paretoShape = 1.5;           // Pareto service: tail shape (> 1, smaller is heavier)
+    double logNormalSigma = 1.0;        // LogNormal service: standard deviation of ln(service time)
+    size_t keySpace = 0;                // Give tasks a session/cache key from 1 to keySpace (0 = no keys)
+    double keySkew = 1.0;               // Zipf exponent of the key popularity (0 = uniform)
+    std::string replayFile;             // Replay this trace instead of generating tasks (empty = generate; see TraceReplay.h)
+    double replayTimeScale = 1.0;       // Replay this many times faster than recorded
+    bool replayLoop = false;            // Restart the trace when it ends
+    double simulationDuration = 2 * 3600;
+    int numberOfServers = 3;
+    int coresPerServer = 1;             // Service slots per server sharing its queue (processing power is per core)
+    double basePower = 15.0;            // Server i (from 0) gets basePower + i * powerStep
+    double powerStep = 5.0;
+    int baseQueueSize = 10;             // Server i (from 0) gets baseQueueSize + i * queueSizeStep
+    int queueSizeStep = 5;
+    std::vector<ServerPool> serverPools;  // When set, replaces the numberOfServers/base/step servers above, in order
+    std::vector<TaskClass> taskClasses; // Mix of task classes (empty = every task is one class), with per-class KPIs
+    double utilizationThreshold = 0.01; // Only report utilization changes of at least this much to the load balancer
+    bool workStealing = false;          // Idle servers take queued tasks from the most loaded server
+    SchedulingDiscipline scheduling = SchedulingDiscipline::Fifo;  // Order each server serves its queue in (virtual time
+                                        // for all but Fifo)
+    int serverThreads = 0;              // Real time: run every server on a shared pool of this many threads
+                                        // instead of a thread per core (0 = a thread per core)
+    bool virtualTime = true;            // Jump from event to event instead of ticking in real time (speed is ignored)
+    int partitions = 0;                 // Virtual time: split the servers over this many threads, with the load balancer
+                                        // on its own (0 = everything on one clock; see ParallelSimulation.h)
+    double reportDelay = 0.01;          // Partitions: simulation seconds a server's utilization report takes to reach
+                                        // the load balancer (the lookahead; the results depend on it)
+    std::chrono::microseconds tick = std::chrono::milliseconds(1);  // Real-time tick length
+    unsigned seed = 0;                  // Random number seed (0 = a different random seed every run)
+    bool deterministic = false;         // Bit-identical output for a given seed: needs virtual time and a non-zero seed,
+                                        // and leaves wall-clock measurements out of the log files
+
+    RoutingPolicyType routingPolicy = RoutingPolicyType::LowestUtilization;
+    size_t backlogCapacity = 100;       // Tasks the load balancer holds while every server is full (0 rejects them)
+    OverflowPolicy overflowPolicy = OverflowPolicy::RejectNew;
+    double maxBacklogWait = 0.0;        // Shed tasks that waited longer than this in the backlog (0 = never)
+    double loadBound = 0.0;             // Maglev: a server over this many times the average tasks per core passes the
+                                        // key on (0 = never, pure consistent hashing)
+    HedgingPolicy hedging = HedgingPolicy::None;  // Virtual time: duplicate tasks to a second server, cancel the loser
+    double hedgeDelay = 10.0;           // Delayed hedging: send the copy when the task has not finished after this long
+
+    bool binaryTrace = true;            // Also write simulation_trace.bin (decode with trace2text)
+    bool logAnalyzer = false;           // Re-derive analyzer_results.txt by parsing the log files instead of using the online KPIs
+    bool consoleEcho = true;            // Echo logs to the terminal; process-wide, so main applies it, not runSimulation
+    std::string outputDir;              // Where every log and result file goes (empty = current directory)
+};
+
+// Set a numeric field by name ("numberOfServers", "interArrivalTime", ...); booleans take 0 or 1.
+// Returns false for unknown names.
+inline bool setConfigValue(SimulationConfig& config, const std::string& name, double value) {
+    if (name == "speed") config.speed = value;
+    else if (name == "averageServiceTime") config.averageServiceTime = value;
+    else if (name == "interArrivalTime") config.interArrivalTime = value;
+    else if (name == "simulationDuration") config.simulationDuration = value;
+    else if (name == "burstFactor") config.burstFactor = value;
+    else if (name == "burstDuration") config.burstDuration = value;
+    else if (name == "normalDuration") config.normalDuration = value;
+    else if (name == "diurnalPeriod") config.diurnalPeriod = value;
+    else if (name == "paretoShape") config.paretoShape = value;
+    else if (name == "logNormalSigma") config.logNormalSigma = value;
+    else if (name == "replayTimeScale") config.replayTimeScale = value;
+    else if (name == "replayLoop") config.replayLoop = value != 0.0;
+    else if (name == "numberOfServers") config.numberOfServers = static_cast<int>(value);
+    else if (name == "coresPerServer") config.coresPerServer = static_cast<int>(value);
+    else if (name == "basePower") config.basePower = value;
+    else if (name == "powerStep") config.powerStep = value;
+    else if (name == "baseQueueSize") config.baseQueueSize = static_cast<int>(value);
+    else if (name == "queueSizeStep") config.queueSizeStep = static_cast<int>(value);
+    else if (name == "utilizationThreshold") config.utilizationThreshold = value;
+    else if (name == "workStealing") config.workStealing = value != 0.0;
+    else if (name == "serverThreads") config.serverThreads = static_cast<int>(value);
+    else if (name == "virtualTime") config.virtualTime = value != 0.0;
+    else if (name == "partitions") config.partitions = static_cast<int>(value);
+    else if (name == "reportDelay") config.reportDelay = value;
+    else if (name == "backlogCapacity") config.backlogCapacity = static_cast<size_t>(value);
+    else if (name == "maxBacklogWait") config.maxBacklogWait = value;
+    else if (name == "hedgeDelay") config.hedgeDelay = value;
+    else if (name == "keySpace") config.keySpace = static_cast<size_t>(value);
+    else if (name == "keySkew") config.keySkew = value;
+    else if (name == "loadBound") config.loadBound = value;
+    else if (name == "binaryTrace") config.binaryTrace = value != 0.0;
+    else if (name == "logAnalyzer") config.logAnalyzer = value != 0.0;
+    else if (name == "deterministic") config.deterministic = value != 0.0;
+    else return false;
+    return true;
+}
+
+struct SimulationResult {
+    KpiSnapshot kpis;
+    AdmissionStats admission;
+    HedgeStats hedging;
+    AffinityStats affinity;
+    int completedTasks = 0;
+    uint64_t events = 0;       // Events the virtual-time clock processed (0 in real time)
+    uint64_t traceDigest = 0;  // TraceWriter::digest() of simulation_trace.bin (0 without a trace)
+};
+
+// One entry (count 1) per server, from serverPools or the numberOfServers/base/step fields
+inline std::vector<ServerPool> serverList(const SimulationConfig& config) {
+    std::vector<ServerPool> list;
+    if (config.serverPools.empty()) {
+        for (int i = 0; i < config.numberOfServers; ++i) {
+            list.push_back(ServerPool{1, config.basePower + i * config.powerStep,
+                                      config.baseQueueSize + i * config.queueSizeStep, config.coresPerServer});
+        }
+        return list;
+    }
+    for (const ServerPool& pool : config.serverPools) {
+        for (int i = 0; i < pool.count; ++i) {
+            list.push_back(ServerPool{1, pool.power, pool.queueSize, pool.cores});
+        }
+    }
+    return list;
+}
+
+// Path of an output file inside the run's output directory
+inline std::string outputPath(const SimulationConfig& config, const std::string& fileName) {
+    if (config.outputDir.empty()) return fileName;
+    return (std::filesystem::path(config.outputDir) / fileName).string();
+}
+
+// Build the clock, task generator, load balancer and servers, run for simulationDuration and write
+// the result files. Runs share nothing but the Logger, so several can run at once on different
+// threads as long as their output directories differ.
+inline SimulationResult runSimulation(const SimulationConfig& config) {
+    if (!config.outputDir.empty()) {
+        std::filesystem::create_directories(config.outputDir);
+    }
+
+    std::vector<ServerPool> serverSpecs = serverList(config);
+    unsigned seed = config.seed != 0 ? config.seed : std::random_device{}();
+    // Declared before the clock so it outlives the clock's timers, which post server steps to it
+    std::unique_ptr<Executor> executor;
+    if (!config.virtualTime && config.serverThreads > 0) {
+        executor = std::make_unique<Executor>(static_cast<size_t>(config.serverThreads));
+    }
+    GlobalClock clock(config.speed, config.virtualTime ? ClockMode::Virtual : ClockMode::RealTime, config.tick);
+    // With partitions, clock is the load balancer's and every partition of servers has a clock of its own
+    std::unique_ptr<ParallelSimulation> parallel;
+    if (config.virtualTime && config.partitions > 0) {
+        parallel = std::make_unique<ParallelSimulation>(clock, config.partitions, config.reportDelay);
+    }
+    LoadBalancer LB(makeRoutingPolicy(config.routingPolicy, seed + 1, config.loadBound), outputPath(config, "load_balancer_log.txt"));
+    LB.setBacklog(config.backlogCapacity, config.overflowPolicy, config.maxBacklogWait);
+    LB.setClock(&clock);
+    LB.setHedging(config.hedging, config.hedgeDelay);
+    TaskGenerator TG(config.averageServiceTime, outputPath(config, "task_log.txt"), &clock);
+    TG.setSeed(seed);
+    ServiceParameters service{config.averageServiceTime, config.paretoShape, config.logNormalSigma};
+    TG.setServiceDistribution(makeServiceDistribution(config.serviceDistribution, service));
+    TG.setTaskClasses(config.taskClasses);
+    TG.setKeys(config.keySpace, config.keySkew);
+
+    std::vector<std::shared_ptr<ServerQueue>> servers;
+    for (size_t i = 0; i < serverSpecs.size(); ++i) {
+        GlobalClock* serverClock = &clock;
+        std::function<void(std::pair<int, double>)> reportUtilization = [&LB](std::pair<int, double> utilizationData) {
+            LB.trackUtil(utilizationData.first, utilizationData.second);
+        };
+        if (parallel) {
+            int partition = parallel->partitionOf(i);
+            serverClock = &parallel->partitionClock(partition);
+            reportUtilization = [lp = parallel.get(), partition](std::pair<int, double> utilizationData) {
+                lp->report(partition, utilizationData.first, utilizationData.second);
+            };
+        }
+        // (service id - server processing power - queue size - clock reference - utilization call back function - cores - log file - executor)
+        servers.push_back(std::make_shared<ServerQueue>(
+            static_cast<int>(i + 1), serverSpecs[i].power, serverSpecs[i].queueSize, serverClock, reportUtilization,
+            serverSpecs[i].cores, outputPath(config, "server" + std::to_string(i + 1) + "_log.txt"), executor.get()));
+    }
+    if (parallel) {
+        // Routed tasks reach the server on its partition's clock at the time they were sent; a full queue rejects them there
+        parallel->setReportHandler([&LB](int serverId, double utilization) { LB.trackUtil(serverId, utilization); });
+        LB.setDispatcher([lp = parallel.get(), &clock](ServerQueue& server, const Task& task) {
+            ServerQueue* target = &server;
+            lp->sendToPartition(lp->partitionOf(server.getServerID() - 1), clock.getCurrentTime(),
+                                GlobalClock::EventType::TaskArrival,
+                                [target, task]() { target->addTask(task.id, task.time, task.generationTime, task.label); });
+            return true;
+        });
+    }
+    for (auto& server : servers) {
+        server->setUtilizationThreshold(config.utilizationThreshold);
+        server->setSchedulingDiscipline(config.scheduling);
+    }
+    if (config.workStealing) {
+        for (auto& server : servers) {
+            server->enableWorkStealing(servers);
+        }
+    }
+    if (config.hedging != HedgingPolicy::None) {
+        // The first copy to finish tells the load balancer, which cancels the other one
+        for (auto& server : servers) {
+            server->enableCancellation();
+            server->setCompletionCallback([&LB](int serverId, int taskId) { LB.taskFinished(serverId, taskId); });
+        }
+    }
+    std::vector<std::string> classNames;
+    for (const TaskClass& taskClass : config.taskClasses) classNames.push_back(taskClass.name);
+    KpiEngine kpis(static_cast<int>(servers.size()), classNames);// Online KPIs, final results are ready as soon as the run stops
+    for (auto& server : servers) {
+        server->setKpiEngine(&kpis);
+    }
+    TraceWriter trace(config.binaryTrace ? outputPath(config, "simulation_trace.bin") : "");
+    if (trace.isOpen() && parallel) {
+        // Each logical process records in memory; the barriers merge the records into the file
+        parallel->setTrace(&trace);
+        LB.setTrace(parallel->balancerTrace(), &clock);
+        TG.setTrace(parallel->balancerTrace());
+        for (size_t i = 0; i < servers.size(); ++i) {
+            servers[i]->setTrace(parallel->partitionTrace(parallel->partitionOf(i)));
+        }
+    } else if (trace.isOpen()) {
+        LB.setTrace(&trace, &clock);
+        TG.setTrace(&trace);
+        for (auto& server : servers) {
+            server->setTrace(&trace);
+        }
+    }
+    LB.setServers(servers);
+
+    auto sendTask = [&LB, &clock, &TG, &config](std::pair<int, double> task) {
+        Task tasklb = {task.first, task.second, clock.getCurrentTime()};// Generation time, for end-to-end delay
+        tasklb.key = TG.getLastTaskKey();
+        if (!config.taskClasses.empty()) {
+            const TaskClass& taskClass = config.taskClasses[TG.getLastTaskClass()];
+            tasklb.label.taskClass = TG.getLastTaskClass();
+            tasklb.label.priority = taskClass.priority;
+            if (taskClass.deadline > 0.0) tasklb.label.deadline = tasklb.generationTime + taskClass.deadline;
+        }
+        LB.sendTask(tasklb);
+    };
+    if (!config.replayFile.empty()) {
+        TG.start(std::make_unique<TraceReplay>(config.replayFile, config.replayTimeScale, config.replayLoop), sendTask);
+    } else {
+        ArrivalParameters arrivals{config.interArrivalTime, config.burstFactor, config.burstDuration,
+                                   config.normalDuration, config.diurnalPeriod, config.diurnalProfile};
+        TG.start(makeArrivalProcess(config.arrivalProcess, arrivals), sendTask);
+    }
+
+    if (parallel) {
+        parallel->runUntil(config.simulationDuration);// Window by window, the servers' partitions in parallel
+    } else if (clock.isVirtual()) {
+        clock.runUntil(config.simulationDuration);// Process all events up to the end of the simulation
+    } else {
+        clock.waitUntil(config.simulationDuration);// Sleep until the clock reaches the end of the simulation
+    }
+
+    TG.stop();
+
+    SimulationResult result;
+    for (auto& server : servers) {
+        server->calculateAverageWaitTime();
+        server->calculateAverageQueueOccupancy();
+        server->stopProcessing();
+        server->calculateAverageTimingError();// real time: how late the clock woke the server after each scheduled finish
+        server->calculateCoreUtilization();// busy time and tasks served per core
+        result.completedTasks += server->getCompletedTasks();
+    }
+    if (parallel) {
+        parallel->flushTrace();// The servers' summary records
+    }
+
+    LB.logPolicyStats(!config.deterministic);// routing policy and its average per-decision cost
+    LB.logAdmissionStats();// deferred, rejected and dropped tasks, for sizing the queues
+
+    result.kpis = kpis.snapshot(clock.getCurrentTime());
+    result.admission = LB.getAdmissionStats();
+    result.hedging = LB.getHedgeStats();
+    result.affinity = LB.getAffinityStats();
+    std::string kpiReport = outputPath(config, "kpi_results.txt");
+    KpiEngine::writeReport(kpiReport, result.kpis);// Full per-server statistics
+    LB.writeAdmissionReport(kpiReport, result.kpis.simTime);// Load balancer admission and drop rate
+    KpiEngine::writeCdf(outputPath(config, "latency_cdf.txt"), result.kpis);// Wait, service and delay distributions for plot.py
+
+    bool traced = trace.isOpen();
+    trace.close();
+    result.events = parallel ? parallel->getProcessedEvents() : clock.getProcessedEvents();
+    result.traceDigest = traced ? trace.digest() : 0;
+    Logger::instance().flush();// Make sure every log line is on disk before the analyzer reads it
+
+    std::string analyzerResults = outputPath(config, "analyzer_results.txt");
+    if (config.logAnalyzer) {
+        std::vector<std::string> logFiles;
+        for (size_t i = 0; i < servers.size(); ++i) {
+            logFiles.push_back(outputPath(config, "server" + std::to_string(i + 1) + "_log.txt"));
+        }
+        analyzer(logFiles, outputPath(config, "task_log.txt"), analyzerResults);
+    } else {
+        for (const auto& kpi : result.kpis.servers) {
+            saveResults(kpi.serverId, kpi.delay.mean, kpi.waitTime.mean, static_cast<int>(kpi.averageQueueLength),
+                        kpi.delayHistogram, kpi.waitHistogram, kpi.serviceHistogram, analyzerResults);
+        }
+    }
+    for (size_t i = 0; i < result.kpis.classes.size(); ++i) {
+        const ServerKpi& kpi = result.kpis.classes[i];// Per-class lines after the servers
+        saveClassResults(result.kpis.classNames[i], kpi.completed, kpi.missedDeadlines, kpi.delay.mean, kpi.waitTime.mean,
+                         kpi.averageQueueLength, kpi.delayHistogram, kpi.waitHistogram, kpi.serviceHistogram, analyzerResults);
+    }
+    return result;
+}
+
+#endif // SIMULATION_H
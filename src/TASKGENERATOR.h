@@ -12,18 +12,23 @@
 #include <atomic>
 #include <chrono>
 #include <functional>
+#include "GlobalClock.h"
+#include "Logger.h"
+#include "TraceFormat.h"
+#include "Workload.h"
+#include "TraceReplay.h"
 
 class TaskGenerator {
 public:
     // Constructor to initialize the Task Generator with average service time
     TaskGenerator(double averageServiceTime, std::string logFilePath, GlobalClock* globalClock)
         : rng(std::random_device{}()), 
-          serviceTimeDist(1.0 / averageServiceTime),
+          serviceTimes(std::make_unique<ExponentialService>(averageServiceTime)),
           currentTaskID(0), 
-          logFile(logFilePath, std::ios::app), 
+          logSink(Logger::instance().openSink(logFilePath)), 
           globalClock(globalClock),
           stopThread(false) {
-        if (!logFile.is_open()) {
+        if (logSink < 0) {
             throw std::runtime_error("Failed to open log file.");
         }
         lastGeneratedTask = {0, 0.0};
@@ -32,28 +37,63 @@ public:
     // Destructor to close the log file and stop the thread
     ~TaskGenerator() {
         stop();
-        if (logFile.is_open()) {
-            logFile.close();
-        }
+        Logger::instance().closeSink(logSink);
     }
 
-    // Start the task generator in a separate thread
+    // Start the task generator in a separate thread, one task every interArrivalTime
     void start(double interArrivalTime, std::function<void(std::pair<int, double>)> taskCallback) {
-        stopThread = false;
-        generatorThread = std::thread([this, interArrivalTime, taskCallback]() {
-            while (!stopThread.load()) {
-                auto task = generateAndLogTask();
-                if (taskCallback) {
-                    taskCallback(task); // Send task to LoadBalancer
-                }
-                std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(interArrivalTime * 1000)));
+        start(std::make_unique<DeterministicArrivals>(interArrivalTime), taskCallback);
+    }
+
+    // Start with gaps drawn from an arrival process (Poisson, MMPP, diurnal, ...)
+    void start(std::unique_ptr<ArrivalProcess> process, std::function<void(std::pair<int, double>)> taskCallback) {
+        setArrivalProcess(std::move(process));
+        run(taskCallback);
+    }
+
+    // Replay a recorded trace: arrival times and service times both come from the file, and the
+    // generator stops emitting when it ends. Tasks keep their usual IDs and task_log.txt lines.
+    void start(std::unique_ptr<TraceReplay> trace, std::function<void(std::pair<int, double>)> taskCallback) {
+        {
+            std::lock_guard<std::mutex> lock(workloadMutex);
+            replay = std::move(trace);
+            if (!replay || !replay->next(replayTask)) {
+                replay.reset();
+                return;  // Empty trace: nothing to send
             }
-        });
+        }
+        run(taskCallback);
+    }
+
+    // Both can be swapped while the generator runs; the next arrival or task uses the new one.
+    // Setting an arrival process ends a replay.
+    void setArrivalProcess(std::unique_ptr<ArrivalProcess> process) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        arrivals = std::move(process);
+        replay.reset();
+    }
+
+    void setServiceDistribution(std::unique_ptr<ServiceTimeDistribution> distribution) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        serviceTimes = std::move(distribution);
+    }
+
+    // Mix of task classes; each task draws its class, then its service time scaled by the class.
+    // An empty list (the default) is one class, 0, and draws nothing extra. Replayed tasks are class 0.
+    void setTaskClasses(const std::vector<TaskClass>& classes) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        taskClasses = classes;
+        std::vector<double> shares;
+        for (const TaskClass& taskClass : classes) shares.push_back(taskClass.share);
+        classPicker = std::discrete_distribution<int>(shares.begin(), shares.end());
     }
 
     // Stop the task generator thread
     void stop() {
         stopThread = true;
+        if (globalClock) {
+            globalClock->wakeWaiters();
+        }
         if (generatorThread.joinable()) {
             generatorThread.join();
         }
@@ -62,52 +102,161 @@ public:
     // Generate a single task manually
     std::pair<int, double> generateTask() {
         currentTaskID++; // Increment task ID
-        double serviceTime = generateExponential(1.0 / serviceTimeDist.lambda());
+        double serviceTime = nextServiceTime();
         logTask(currentTaskID, serviceTime);
         lastGeneratedTask = {currentTaskID, serviceTime};
         return lastGeneratedTask;
     }
 
+    // Also record generated tasks to a binary trace (nullptr to stop)
+    void setTrace(TraceWriter* traceWriter) {
+        trace = traceWriter;
+    }
+
+    // Reproducible service times: the same seed gives the same task sequence
+    void setSeed(unsigned seed) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        rng.seed(seed);
+    }
+
     // Get the last generated task
     std::pair<int, double> getLastGeneratedTask() const {
         return lastGeneratedTask;
     }
 
+    // Class of the last generated task; read it from the task callback
+    int getLastTaskClass() const {
+        return lastTaskClass;
+    }
+
+    // Give every task a key from 1 to keySpace (Zipf with exponent skew) for affinity routing; 0 keys turns
+    // keys off (the default) and draws nothing extra.
+    void setKeys(size_t keySpace, double skew) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        keys = keySpace > 0 ? std::make_unique<ZipfKeys>(keySpace, skew) : nullptr;
+    }
+
+    // Key of the last generated task (the recorded key of a replayed CSV trace), 0 without keys
+    uint64_t getLastTaskKey() const {
+        return lastTaskKey;
+    }
+
 private:
 
+    // Emit the first task now, then one per arrival until stopped (or the replayed trace ends)
+    void run(std::function<void(std::pair<int, double>)> taskCallback) {
+        stopThread = false;
+        if (globalClock && globalClock->isVirtual()) {
+            // No thread in virtual time: each arrival schedules the next one on the clock
+            arrivalCallback = taskCallback;
+            globalClock->scheduleEvent(globalClock->getCurrentTime(), GlobalClock::EventType::TaskArrival,
+                                       [this]() { handleArrival(); });
+            return;
+        }
+        generatorThread = std::thread([this, taskCallback]() {
+            double nextArrival = globalClock ? globalClock->getCurrentTime() : 0.0;
+            while (!stopThread.load()) {
+                auto task = generateAndLogTask();
+                if (taskCallback) {
+                    taskCallback(task); // Send task to LoadBalancer
+                }
+                double gap = nextInterArrival(nextArrival);
+                if (gap < 0.0) break; // Replayed trace ended
+                if (!globalClock) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int>(gap * 1000)));
+                    continue;
+                }
+                // Inter-arrival time is in simulation seconds; wake exactly when the next arrival is due
+                nextArrival += gap;
+                if (!globalClock->waitUntil(nextArrival, [this]() { return stopThread.load(); })) break;
+            }
+        });
+    }
+
+    // Virtual-time arrival event: emit one task and schedule the next arrival
+    void handleArrival() {
+        if (stopThread.load()) return;
+        auto task = generateAndLogTask();
+        if (arrivalCallback) {
+            arrivalCallback(task); // Send task to LoadBalancer
+        }
+        double now = globalClock->getCurrentTime();
+        double gap = nextInterArrival(now);
+        if (gap < 0.0) return; // Replayed trace ended
+        globalClock->scheduleEvent(now + gap, GlobalClock::EventType::TaskArrival, [this]() { handleArrival(); });
+    }
+
+    // Time to the next arrival; negative once a replayed trace has ended
+    double nextInterArrival(double now) {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        if (replay) {
+            ReplayTask next;
+            if (!replay->next(next)) return -1.0;
+            double gap = std::max(0.0, next.time - replayTask.time); // Out-of-order records arrive at once
+            replayTask = next;
+            return gap;
+        }
+        return arrivals->nextInterArrival(now, rng);
+    }
+
+    double nextServiceTime() {
+        std::lock_guard<std::mutex> lock(workloadMutex);
+        lastTaskClass = 0;
+        lastTaskKey = 0;
+        if (replay) {
+            lastTaskKey = replayTask.key;
+            return replayTask.serviceTime;
+        }
+        if (taskClasses.size() > 1) lastTaskClass = classPicker(rng);
+        double scale = taskClasses.empty() ? 1.0 : taskClasses[lastTaskClass].serviceScale;
+        double serviceTime = serviceTimes->sample(rng) * scale;
+        lastTaskKey = keys ? keys->sample(rng) : 0;
+        return serviceTime;
+    }
+
     // Helper function to generate and log a task
 std::pair<int, double> generateAndLogTask() {
     currentTaskID++;
-    double serviceTime = generateExponential(1.0 / serviceTimeDist.lambda());
+    double serviceTime = nextServiceTime();
     //std::cout << "Generated Service Time: " << serviceTime << " (Exponential Distribution)\n";  // Debugging line
     logTask(currentTaskID, serviceTime);
     lastGeneratedTask = {currentTaskID, serviceTime};
     return lastGeneratedTask;
 }
 
-// Helper function to generate exponentially distributed random numbers
-double generateExponential(double mean) {
-    return serviceTimeDist(rng);  // Generates a random number from exponential distribution
-}
-
 
     // Log task details with timestamp to a file
     void logTask(int taskID, double serviceTime) {
         if (globalClock) {
-            logFile << std::fixed << std::setprecision(2);
-            logFile << "[Time: " << globalClock->getCurrentTime() << "] Task ID: " << taskID 
-                    << ", Service Time: " << serviceTime << " seconds\n";
+            if (trace) {
+                TraceRecord record = makeTraceRecord(TraceEventType::TaskGenerated, globalClock->getCurrentTime(), taskID, 0, serviceTime);
+                record.taskClass = static_cast<uint8_t>(lastTaskClass);
+                trace->record(record);
+            }
+            Logger::instance().log(logSink, LogLevel::Info, "[Time: {.2}] Task ID: {}, Service Time: {.2} seconds",
+                                   globalClock->getCurrentTime(), taskID, serviceTime);
         }
     }
 
     std::mt19937 rng; // Random number generator
-    std::exponential_distribution<double> serviceTimeDist; // Exponential distribution for service time
+    std::unique_ptr<ServiceTimeDistribution> serviceTimes; // Service time distribution (exponential by default)
+    std::unique_ptr<ArrivalProcess> arrivals; // Gaps between arrivals, set by start()
+    std::unique_ptr<TraceReplay> replay; // Recorded trace being replayed, replaces arrivals and serviceTimes
+    ReplayTask replayTask{0.0, 0.0, 0}; // Replayed task that arrives next
+    std::vector<TaskClass> taskClasses; // Empty: every task is class 0
+    std::discrete_distribution<int> classPicker; // Draws a class index by share
+    int lastTaskClass = 0;
+    std::unique_ptr<ZipfKeys> keys; // Null: tasks have no key
+    uint64_t lastTaskKey = 0;
+    std::mutex workloadMutex; // Guards rng, serviceTimes, arrivals, the replay, the classes and the keys
     int currentTaskID; // Counter for unique task IDs
-    std::ofstream logFile; // Log file stream
+    int logSink; // Logger sink for the task log
+    TraceWriter* trace = nullptr; // Optional binary trace
     GlobalClock* globalClock; // Pointer to global clock
     std::atomic<bool> stopThread; // Flag to stop the thread
     std::thread generatorThread; // Thread for generating tasks
     std::pair<int, double> lastGeneratedTask; // Last generated task
+    std::function<void(std::pair<int, double>)> arrivalCallback; // Task callback used in virtual-time mode
 };
 
 #endif // TASK_GENERATOR_H
@@ -0,0 +1,590 @@
+#ifndef TCP_PROXY_H
+#define TCP_PROXY_H
+
+#if defined(__linux__)
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <unordered_set>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include "RoutingPolicy.h"
+#include "UtilizationIndex.h"
+#include "Logger.h"
+
+// Layer-4 TCP proxy that routes real connections with the simulator's policies (Linux only).
+// Every worker thread runs its own epoll loop on its own SO_REUSEPORT listening socket, so the kernel
+// spreads new connections over the cores and a connection never changes thread. Each loop routes with
+// its own RoutingPolicy instance (its own round robin position and random generator); only a policy that
+// must see every decision (weighted round robin) is shared, under a lock. Bytes go through a
+// pipe with splice() in both directions and are never copied into user space. sendfile() is not used
+// because it cannot read from a socket.
+//
+// Each backend publishes a utilization to a UtilizationIndex on every connection open and close and
+// every latency sample: the same blend ServerQueue uses, with active connections as occupancy and
+// active connections times the measured response latency as queued work.
+
+struct BackendEndpoint {
+    std::string host = "127.0.0.1";  // IPv4 address
+    uint16_t port = 0;
+    double weight = 1.0;  // Relative capacity (a ServerQueue's processing power), for the weighted policies
+    int capacity = 64;    // Connections at which occupancy reaches 1 (a ServerQueue's queue size plus cores)
+};
+
+// Counters of one backend at one moment
+struct BackendSnapshot {
+    int active = 0;               // Open connections
+    long long connections = 0;    // Connections routed to it
+    long long failures = 0;       // Connects that failed (the client was routed elsewhere)
+    long long responses = 0;      // Request/response exchanges seen (client bytes, then backend bytes)
+    long long bytesToBackend = 0;
+    long long bytesToClient = 0;
+    double latency = 0.0;         // Moving average of request-to-first-response-byte time, seconds
+    double utilization = 0.0;     // Value published to the routing index
+};
+
+class TcpProxy {
+public:
+    explicit TcpProxy(std::vector<BackendEndpoint> endpoints,
+                      RoutingPolicyType policyType = RoutingPolicyType::LowestUtilization,
+                      unsigned seed = std::random_device{}(), const std::string& logPath = "proxy_log.txt")
+        : endpoints(std::move(endpoints)), policyType(policyType), seed(seed),
+          sharedPolicy(makeRoutingPolicy(policyType, seed)), backends(new Backend[this->endpoints.size()]) {
+        logSink = Logger::instance().openSink(logPath);
+        if (!sharedPolicy->sharedAcrossRouters()) sharedPolicy.reset();
+        for (size_t i = 0; i < this->endpoints.size(); ++i) {
+            utilization.update(static_cast<int>(i), 0.0);
+        }
+    }
+
+    ~TcpProxy() {
+        stop();
+        Logger::instance().closeSink(logSink);
+    }
+
+    TcpProxy(const TcpProxy&) = delete;
+    TcpProxy& operator=(const TcpProxy&) = delete;
+
+    // Listen on port (0 picks a free one, see getPort) with `workers` event loops (0 = one per hardware thread).
+    // Returns false and sets getError() when the sockets cannot be set up. Ignores SIGPIPE process-wide.
+    bool start(uint16_t port, int workers = 0, const std::string& bindAddress = "0.0.0.0") {
+        if (endpoints.empty()) return fail("no backends");
+        std::signal(SIGPIPE, SIG_IGN);  // A peer that closes mid-splice must not kill the process
+        if (workers <= 0) workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        listenPort = port;
+        running = true;
+        for (int i = 0; i < workers; ++i) {
+            auto worker = std::make_unique<Worker>();
+            if (!sharedPolicy) worker->policy = makeRoutingPolicy(policyType, seed + static_cast<unsigned>(i));
+            if (!openWorker(*worker, bindAddress)) {
+                closeWorker(*worker);
+                stop();
+                return false;
+            }
+            workerLoops.push_back(std::move(worker));
+        }
+        for (auto& worker : workerLoops) {
+            Worker* loop = worker.get();
+            loop->thread = std::thread([this, loop]() { run(*loop); });
+        }
+        Logger::instance().log(logSink, LogLevel::Info, "Proxy listening on port {} with {} event loops and {} backends",
+                               listenPort, workers, endpoints.size());
+        return true;
+    }
+
+    void stop() {
+        if (!running.exchange(false)) return;
+        for (auto& worker : workerLoops) {
+            uint64_t one = 1;
+            if (worker->wake >= 0) (void)!write(worker->wake, &one, sizeof(one));
+        }
+        for (auto& worker : workerLoops) {
+            if (worker->thread.joinable()) worker->thread.join();
+            closeWorker(*worker);
+        }
+        workerLoops.clear();
+        for (size_t i = 0; i < endpoints.size(); ++i) {
+            BackendSnapshot stats = getBackendStats(i);
+            Logger::instance().log(logSink, LogLevel::Info,
+                                   "Backend {}: {} connections, {} failed connects, {} responses, average latency {.6} s",
+                                   i + 1, stats.connections, stats.failures, stats.responses, stats.latency);
+        }
+    }
+
+    uint16_t getPort() const {
+        return listenPort;
+    }
+
+    const std::string& getError() const {
+        return error;
+    }
+
+    size_t getBackendCount() const {
+        return endpoints.size();
+    }
+
+    BackendSnapshot getBackendStats(size_t index) const {
+        const Backend& backend = backends[index];
+        BackendSnapshot stats;
+        stats.active = backend.active.load();
+        stats.connections = backend.connections.load();
+        stats.failures = backend.failures.load();
+        stats.responses = backend.responses.load();
+        stats.bytesToBackend = backend.bytesToBackend.load();
+        stats.bytesToClient = backend.bytesToClient.load();
+        stats.latency = backend.latency.load();
+        stats.utilization = utilization.get(static_cast<int>(index));
+        return stats;
+    }
+
+    // Latency at which an active connection counts as one full queue slot of work (default 50 ms)
+    void setLatencyTarget(double seconds) {
+        if (seconds > 0.0) latencyTarget = seconds;
+    }
+
+private:
+    static constexpr size_t PipeChunk = 64 * 1024;    // Bytes moved per splice call
+    static constexpr int ChunksPerEvent = 16;         // Then let other connections run
+    static constexpr int MaxEvents = 256;
+    static constexpr double LatencyWeight = 0.2;      // Weight of a new sample in the moving average
+    static constexpr int64_t DownNanos = 1000000000;  // A backend that refused a connect is skipped for 1 s
+
+    struct Backend {
+        std::atomic<int> active{0};
+        std::atomic<long long> connections{0};
+        std::atomic<long long> failures{0};
+        std::atomic<long long> responses{0};
+        std::atomic<long long> bytesToBackend{0};
+        std::atomic<long long> bytesToClient{0};
+        std::atomic<double> latency{0.0};
+        std::atomic<int64_t> downUntil{0};  // steady_clock nanoseconds
+    };
+
+    struct Connection;
+
+    enum class EndpointKind { Listener, Wake, Client, Backend };
+
+    // epoll_event.data.ptr
+    struct Endpoint {
+        EndpointKind kind;
+        Connection* connection;
+    };
+
+    // One direction: from -> pipe -> to
+    struct Pump {
+        int from = -1;
+        int to = -1;
+        int pipe[2] = {-1, -1};
+        size_t buffered = 0;  // Bytes in the pipe
+        bool eof = false;     // `from` has no more data
+        bool done = false;    // eof and drained: `to` was shut down for writing
+        bool hungUp = false;  // `from` hung up: reads never block any more, so it is no longer polled
+
+        bool wantsRead() const { return !eof && buffered == 0; }
+    };
+
+    struct Connection {
+        int client = -1;
+        int backend = -1;
+        int backendIndex = -1;
+        int attempts = 0;
+        bool connecting = false;
+        int64_t requestStart = 0;  // When client bytes went out with no response yet (0 = none pending)
+        Pump up;                   // Client to backend
+        Pump down;                 // Backend to client
+        uint32_t clientEvents = 0;
+        uint32_t backendEvents = 0;
+        Endpoint clientEndpoint{EndpointKind::Client, nullptr};
+        Endpoint backendEndpoint{EndpointKind::Backend, nullptr};
+    };
+
+    struct Worker {
+        int epoll = -1;
+        int listener = -1;
+        int wake = -1;
+        Endpoint listenerEndpoint{EndpointKind::Listener, nullptr};
+        Endpoint wakeEndpoint{EndpointKind::Wake, nullptr};
+        std::unordered_set<Connection*> connections;
+        std::vector<Connection*> closed;  // Deleted after the event batch, so a stale event cannot match a new one
+        std::vector<std::pair<int, int>> sparePipes;
+        std::unique_ptr<RoutingPolicy> policy;  // Null when the proxy's shared policy routes
+        std::thread thread;
+    };
+
+    // The backends as the routing policies see them: IDs are indices, active connections are the queue,
+    // and a backend that refused a connect is unavailable until its down time passes
+    class BackendTargets final : public RoutingTargets {
+    public:
+        BackendTargets(const TcpProxy& proxy, int64_t now) : proxy(proxy), now(now) {}
+
+        size_t size() const override { return proxy.endpoints.size(); }
+        int id(size_t index) const override { return static_cast<int>(index); }
+        bool available(int id) const override { return proxy.backends[id].downUntil.load() <= now; }
+        double weight(size_t index) const override { return proxy.endpoints[index].weight; }
+        size_t queueLength(size_t index) const override { return static_cast<size_t>(std::max(0, active(index))); }
+        int tasksInSystem(size_t index) const override { return active(index); }
+        int cores(size_t) const override { return 1; }
+
+        // The new connection waits behind the active ones, each taking about the measured latency
+        double expectedWork(size_t index) const override {
+            return (active(index) + 1) * std::max(proxy.backends[index].latency.load(), 1e-6) / weight(index);
+        }
+
+    private:
+        const TcpProxy& proxy;
+        int64_t now;
+
+        int active(size_t index) const { return proxy.backends[index].active.load(); }
+    };
+
+    std::vector<BackendEndpoint> endpoints;
+    RoutingPolicyType policyType;
+    unsigned seed;  // Loop i's policy is seeded with seed + i
+    std::unique_ptr<RoutingPolicy> sharedPolicy;  // Set when the policy is shared across the loops
+    std::mutex sharedPolicyMutex;
+    std::unique_ptr<Backend[]> backends;
+    UtilizationIndex utilization;
+    double latencyTarget = 0.05;
+    std::vector<std::unique_ptr<Worker>> workerLoops;
+    std::atomic<bool> running{false};
+    uint16_t listenPort = 0;
+    std::string error;
+    int logSink = -1;
+
+    static int64_t nowNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool fail(const std::string& message) {
+        error = message + (errno ? std::string(": ") + std::strerror(errno) : "");
+        return false;
+    }
+
+    bool openWorker(Worker& worker, const std::string& bindAddress) {
+        worker.epoll = epoll_create1(EPOLL_CLOEXEC);
+        worker.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        worker.listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (worker.epoll < 0 || worker.wake < 0 || worker.listener < 0) return fail("cannot create sockets");
+        int on = 1;
+        setsockopt(worker.listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        setsockopt(worker.listener, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(listenPort);
+        if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1) return fail("bad bind address " + bindAddress);
+        if (bind(worker.listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(worker.listener, SOMAXCONN) != 0) {
+            return fail("cannot listen on port " + std::to_string(listenPort));
+        }
+        if (listenPort == 0) {
+            // The first loop took an ephemeral port; the others join it
+            socklen_t length = sizeof(address);
+            getsockname(worker.listener, reinterpret_cast<sockaddr*>(&address), &length);
+            listenPort = ntohs(address.sin_port);
+        }
+        return watch(worker, worker.listener, EPOLLIN, &worker.listenerEndpoint, EPOLL_CTL_ADD) &&
+               watch(worker, worker.wake, EPOLLIN, &worker.wakeEndpoint, EPOLL_CTL_ADD);
+    }
+
+    void closeWorker(Worker& worker) {
+        while (!worker.connections.empty()) release(worker, *worker.connections.begin());
+        for (Connection* connection : worker.closed) delete connection;
+        worker.closed.clear();
+        for (auto& spare : worker.sparePipes) {
+            close(spare.first);
+            close(spare.second);
+        }
+        worker.sparePipes.clear();
+        for (int* fd : {&worker.listener, &worker.wake, &worker.epoll}) {
+            if (*fd >= 0) close(*fd);
+            *fd = -1;
+        }
+    }
+
+    bool watch(Worker& worker, int fd, uint32_t events, Endpoint* endpoint, int operation) {
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = endpoint;
+        return epoll_ctl(worker.epoll, operation, fd, &event) == 0 || fail("epoll_ctl");
+    }
+
+    void run(Worker& worker) {
+        epoll_event events[MaxEvents];
+        while (running.load()) {
+            int count = epoll_wait(worker.epoll, events, MaxEvents, -1);
+            if (count < 0 && errno != EINTR) break;
+            for (int i = 0; i < count; ++i) {
+                Endpoint* endpoint = static_cast<Endpoint*>(events[i].data.ptr);
+                if (endpoint->kind == EndpointKind::Listener) {
+                    acceptAll(worker);
+                } else if (endpoint->kind == EndpointKind::Wake) {
+                    uint64_t value;
+                    (void)!read(worker.wake, &value, sizeof(value));
+                } else if (worker.connections.count(endpoint->connection)) {
+                    handle(worker, endpoint->connection, endpoint->kind == EndpointKind::Backend, events[i].events);
+                }
+            }
+            for (Connection* connection : worker.closed) delete connection;
+            worker.closed.clear();
+        }
+    }
+
+    void acceptAll(Worker& worker) {
+        while (true) {
+            int client = accept4(worker.listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client < 0) return;  // EAGAIN: accepted everything; other errors: try again on the next event
+            int on = 1;
+            setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            Connection* connection = new Connection();
+            connection->client = client;
+            connection->clientEndpoint.connection = connection;
+            connection->backendEndpoint.connection = connection;
+            worker.connections.insert(connection);
+            watch(worker, client, 0, &connection->clientEndpoint, EPOLL_CTL_ADD);  // Reads wait for the backend
+            if (!connectBackend(worker, connection)) release(worker, connection);
+        }
+    }
+
+    // Pick a backend and start a non-blocking connect; false when every backend failed
+    bool connectBackend(Worker& worker, Connection* connection) {
+        while (connection->attempts < static_cast<int>(endpoints.size())) {
+            ++connection->attempts;
+            int index = selectBackend(worker);
+            if (index < 0) return false;
+            Backend& backend = backends[index];
+            int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (fd < 0) return false;
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(endpoints[index].port);
+            inet_pton(AF_INET, endpoints[index].host.c_str(), &address.sin_addr);
+            if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && errno != EINPROGRESS) {
+                close(fd);
+                markDown(index);
+                continue;
+            }
+            connection->backend = fd;
+            connection->backendIndex = index;
+            connection->connecting = true;
+            ++backend.active;
+            ++backend.connections;
+            publish(index);
+            connection->backendEvents = EPOLLOUT;
+            watch(worker, fd, EPOLLOUT, &connection->backendEndpoint, EPOLL_CTL_ADD);
+            return true;
+        }
+        return false;
+    }
+
+    void handle(Worker& worker, Connection* connection, bool backendSide, uint32_t events) {
+        if (connection->connecting) {
+            if (!backendSide) {
+                if (events & (EPOLLERR | EPOLLHUP)) release(worker, connection);  // Client gave up while connecting
+                return;
+            }
+            int socketError = 0;
+            socklen_t length = sizeof(socketError);
+            getsockopt(connection->backend, SOL_SOCKET, SO_ERROR, &socketError, &length);
+            if (socketError != 0) {
+                // Refused: forget this backend for a while and try another one
+                markDown(connection->backendIndex);
+                dropBackend(worker, connection);
+                if (!connectBackend(worker, connection)) release(worker, connection);
+                return;
+            }
+            if (!startPumps(worker, connection)) {
+                release(worker, connection);
+                return;
+            }
+        }
+        if (events & EPOLLERR) {
+            release(worker, connection);
+            return;
+        }
+        // A hang-up is not the end: what the peer sent before its FIN may still be in the socket and the pipe
+        if (events & EPOLLHUP) hangUp(worker, backendSide ? connection->down : connection->up);
+        bool ok = pump(connection->up, connection, true) && pump(connection->down, connection, false);
+        if (!ok || (connection->up.done && connection->down.done)) {
+            release(worker, connection);
+            return;
+        }
+        updateInterest(worker, connection);
+    }
+
+    bool startPumps(Worker& worker, Connection* connection) {
+        connection->connecting = false;
+        for (Pump* pump : {&connection->up, &connection->down}) {
+            if (!worker.sparePipes.empty()) {
+                pump->pipe[0] = worker.sparePipes.back().first;
+                pump->pipe[1] = worker.sparePipes.back().second;
+                worker.sparePipes.pop_back();
+            } else if (pipe2(pump->pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+                return false;
+            }
+        }
+        connection->up.from = connection->client;
+        connection->up.to = connection->backend;
+        connection->down.from = connection->backend;
+        connection->down.to = connection->client;
+        return true;
+    }
+
+    // Move what can be moved without blocking; false on a connection error
+    bool pump(Pump& pump, Connection* connection, bool upstream) {
+        for (int chunk = 0; chunk < ChunksPerEvent; ++chunk) {
+            if (pump.buffered > 0) {
+                ssize_t moved = splice(pump.pipe[0], nullptr, pump.to, nullptr, pump.buffered,
+                                       SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+                if (moved < 0) return errno == EAGAIN;
+                pump.buffered -= static_cast<size_t>(moved);
+                continue;
+            }
+            if (pump.eof) {
+                if (!pump.done) {
+                    shutdown(pump.to, SHUT_WR);
+                    pump.done = true;
+                }
+                return true;
+            }
+            ssize_t received = splice(pump.from, nullptr, pump.pipe[1], nullptr, PipeChunk,
+                                      SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+            if (received == 0) {
+                pump.eof = true;
+                continue;
+            }
+            if (received < 0) return errno == EAGAIN;
+            pump.buffered += static_cast<size_t>(received);
+            recordTraffic(connection, upstream, received);
+        }
+        return true;
+    }
+
+    void recordTraffic(Connection* connection, bool upstream, ssize_t bytes) {
+        Backend& backend = backends[connection->backendIndex];
+        if (upstream) {
+            backend.bytesToBackend += bytes;
+            if (connection->requestStart == 0) connection->requestStart = nowNanos();
+            return;
+        }
+        backend.bytesToClient += bytes;
+        if (connection->requestStart != 0) {
+            double sample = (nowNanos() - connection->requestStart) * 1e-9;
+            connection->requestStart = 0;
+            ++backend.responses;
+            double average = backend.latency.load();
+            double updated;
+            do {
+                updated = average == 0.0 ? sample : average + LatencyWeight * (sample - average);
+            } while (!backend.latency.compare_exchange_weak(average, updated));
+            publish(connection->backendIndex);
+        }
+    }
+
+    // EPOLLHUP cannot be masked and stays raised, so the hung-up socket leaves the epoll set instead of
+    // waking the loop until the other side has taken everything. Both directions of it are shut, so
+    // nothing waits to be written to it. Its reads return data or EOF at once, so the pump is driven by
+    // the other side's EPOLLOUT until it reaches EOF (see updateInterest).
+    static void hangUp(Worker& worker, Pump& pump) {
+        if (pump.hungUp) return;
+        pump.hungUp = true;
+        epoll_ctl(worker.epoll, EPOLL_CTL_DEL, pump.from, nullptr);
+    }
+
+    // Read from `from` while the pipe is empty; write to `to` while it has data, or while `from` hung up
+    // with data left (then every read succeeds, and a writable `to` keeps the pump going)
+    static uint32_t interest(const Pump& reading, const Pump& writing) {
+        uint32_t events = reading.wantsRead() ? uint32_t(EPOLLIN) : 0u;
+        if (writing.buffered > 0 || (writing.hungUp && !writing.eof)) events |= EPOLLOUT;
+        return events;
+    }
+
+    void updateInterest(Worker& worker, Connection* connection) {
+        if (!connection->up.hungUp) {
+            setInterest(worker, connection->client, connection->clientEvents, interest(connection->up, connection->down),
+                        &connection->clientEndpoint);
+        }
+        if (!connection->down.hungUp) {
+            setInterest(worker, connection->backend, connection->backendEvents, interest(connection->down, connection->up),
+                        &connection->backendEndpoint);
+        }
+    }
+
+    void setInterest(Worker& worker, int fd, uint32_t& current, uint32_t events, Endpoint* endpoint) {
+        if (events == current) return;
+        current = events;
+        watch(worker, fd, events, endpoint, EPOLL_CTL_MOD);
+    }
+
+    // Close the backend side only (a failed connect)
+    void dropBackend(Worker&, Connection* connection) {
+        close(connection->backend);  // Also removes it from the epoll set
+        connection->backend = -1;
+        --backends[connection->backendIndex].active;
+        publish(connection->backendIndex);
+        connection->backendIndex = -1;
+        connection->connecting = false;
+    }
+
+    void release(Worker& worker, Connection* connection) {
+        if (connection->backend >= 0) dropBackend(worker, connection);
+        if (connection->client >= 0) close(connection->client);
+        for (Pump* pump : {&connection->up, &connection->down}) {
+            if (pump->pipe[0] < 0) continue;
+            if (pump->buffered == 0 && worker.sparePipes.size() < 1024) {
+                worker.sparePipes.emplace_back(pump->pipe[0], pump->pipe[1]);  // Empty: reuse it
+            } else {
+                close(pump->pipe[0]);
+                close(pump->pipe[1]);
+            }
+        }
+        worker.connections.erase(connection);
+        worker.closed.push_back(connection);
+    }
+
+    void markDown(int index) {
+        ++backends[index].failures;
+        backends[index].downUntil = nowNanos() + DownNanos;
+        Logger::instance().log(logSink, LogLevel::Warning, "Backend {} refused a connection, skipping it for 1 s", index + 1);
+    }
+
+    // Same blend as ServerQueue::computeUtilization: occupancy, and queued work (latency per active connection)
+    void publish(int index) {
+        const Backend& backend = backends[index];
+        double capacity = std::max(1, endpoints[index].capacity);
+        int active = std::max(0, backend.active.load());
+        double occupancy = active / capacity;
+        double work = active * backend.latency.load() / (capacity * latencyTarget);
+        utilization.update(index, (occupancy + work) / 2.0);
+    }
+
+    // Backend index for a new connection, -1 when every backend is down
+    int selectBackend(Worker& worker) {
+        BackendTargets targets(*this, nowNanos());
+        if (worker.policy) return worker.policy->selectServer(targets, utilization);
+        std::lock_guard<std::mutex> lock(sharedPolicyMutex);
+        return sharedPolicy->selectServer(targets, utilization);
+    }
+};
+
+#endif // __linux__
+
+#endif // TCP_PROXY_H
@@ -0,0 +1,194 @@
+#ifndef TRACE_FORMAT_H
+#define TRACE_FORMAT_H
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+
+// Compact binary trace shared by all components: a 16-byte header followed by
+// fixed-width 32-byte records in the order they were produced.
+// Use trace2text to turn a trace back into the usual text logs.
+
+enum class TraceEventType : uint8_t {
+    TaskGenerated,       // TaskGenerator: taskId, serviceTime
+    TaskAssigned,        // LoadBalancer: taskId, serverId, utilization of the chosen server
+    TaskAdded,           // ServerQueue: taskId, serverId, serviceTime, queueLength after the push
+    TaskRejected,        // ServerQueue: taskId, serverId (queue full)
+    ServiceStart,        // ServerQueue: taskId, serverId, serviceTime, queueLength after the pop
+    TaskFinished,        // ServerQueue: taskId, serverId
+    UtilizationUpdate,   // ServerQueue: serverId, utilization
+    AverageWaitingTime,  // ServerQueue summary: serverId, serviceTime holds the average wait
+    AverageQueueLength,  // ServerQueue summary: serverId, queueLength holds the floored average
+    TaskShed,            // LoadBalancer: taskId, serviceTime (backlog full or waited too long)
+    TaskCancelled,       // ServerQueue: taskId, serverId, serviceTime, queueLength after the removal
+    TaskPreempted,       // ServerQueue: taskId, serverId, serviceTime holds the service it got
+    TaskSuspended,       // ServerQueue: taskId, serverId, serviceTime holds the work left, queueLength after the push
+    ServiceResume        // ServerQueue: a suspended task back in service; taskId, serverId, serviceTime holds the work left,
+                         // queueLength after the pop
+};
+
+struct TraceHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+    uint64_t reserved;
+};
+
+struct TraceRecord {
+    double simTime;
+    double serviceTime;
+    uint32_t taskId;
+    uint32_t serverId;
+    float utilization;
+    uint16_t queueLength;  // Saturates at 65535
+    TraceEventType type;
+    uint8_t taskClass;  // TaskGenerated: the task's class (0 without classes); 0 otherwise
+};
+
+static_assert(sizeof(TraceHeader) == 16, "TraceHeader must stay 16 bytes");
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord must stay 32 bytes");
+
+constexpr char TraceMagic[4] = {'L', 'B', 'T', 'R'};
+constexpr uint16_t TraceVersion = 1;
+
+inline TraceRecord makeTraceRecord(TraceEventType type, double simTime, int taskId = 0, int serverId = 0,
+                                   double serviceTime = 0.0, size_t queueLength = 0, double utilization = 0.0) {
+    TraceRecord record{};
+    record.type = type;
+    record.simTime = simTime;
+    record.taskId = static_cast<uint32_t>(taskId);
+    record.serverId = static_cast<uint32_t>(serverId);
+    record.serviceTime = serviceTime;
+    record.queueLength = static_cast<uint16_t>(queueLength > 65535 ? 65535 : queueLength);
+    record.utilization = static_cast<float>(utilization);
+    return record;
+}
+
+// Append-only trace file for one run. Records are buffered and written in large blocks;
+// the lock is held only to copy one record.
+class TraceWriter {
+public:
+    // In memory only: records wait for takeRecords() instead of going to a file
+    // (the parallel simulation gives each logical process one and merges them)
+    TraceWriter() : inMemory(true) {}
+
+    explicit TraceWriter(const std::string& path) {
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) return;
+        TraceHeader header{};
+        std::memcpy(header.magic, TraceMagic, sizeof(header.magic));
+        header.version = TraceVersion;
+        header.recordSize = sizeof(TraceRecord);
+        std::fwrite(&header, sizeof(header), 1, file);
+        buffer.reserve(BufferRecords);
+    }
+
+    ~TraceWriter() {
+        close();
+    }
+
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    void record(const TraceRecord& record) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (!file && !inMemory) return;
+        buffer.push_back(record);
+        if (file && buffer.size() >= BufferRecords) {
+            writeBuffer();
+        }
+    }
+
+    // Append records that are already in order
+    void record(const std::vector<TraceRecord>& records) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        if (!file && !inMemory) return;
+        buffer.insert(buffer.end(), records.begin(), records.end());
+        if (file && buffer.size() >= BufferRecords) {
+            writeBuffer();
+        }
+    }
+
+    // In-memory writer: move the records collected so far to the end of out
+    void takeRecords(std::vector<TraceRecord>& out) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        out.insert(out.end(), buffer.begin(), buffer.end());
+        buffer.clear();
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writeBuffer();
+        if (file) std::fflush(file);
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        writeBuffer();
+        if (file) {
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+
+    // 64-bit FNV-1a hash of every record written so far (complete after close()).
+    // Two runs have the same digest exactly when their traces are bit-identical.
+    uint64_t digest() {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        return recordDigest;
+    }
+
+private:
+    static constexpr size_t BufferRecords = 4096;  // 128 KB per write
+
+    std::FILE* file = nullptr;
+    bool inMemory = false;
+    std::vector<TraceRecord> buffer;
+    std::mutex writerMutex;
+    uint64_t recordDigest = 14695981039346656037ull;  // FNV-1a offset basis
+
+    void writeBuffer() {
+        if (file && !buffer.empty()) {
+            std::fwrite(buffer.data(), sizeof(TraceRecord), buffer.size(), file);
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(buffer.data());
+            for (size_t i = 0, size = buffer.size() * sizeof(TraceRecord); i < size; ++i) {
+                recordDigest = (recordDigest ^ bytes[i]) * 1099511628211ull;
+            }
+        }
+        buffer.clear();
+    }
+};
+
+// Sequential reader, returns false from open() when the header does not match this version
+class TraceReader {
+public:
+    ~TraceReader() {
+        if (file) std::fclose(file);
+    }
+
+    bool open(const std::string& path) {
+        file = std::fopen(path.c_str(), "rb");
+        if (!file) return false;
+        TraceHeader header{};
+        if (std::fread(&header, sizeof(header), 1, file) != 1) return false;
+        return std::memcmp(header.magic, TraceMagic, sizeof(header.magic)) == 0 &&
+               header.version == TraceVersion && header.recordSize == sizeof(TraceRecord);
+    }
+
+    // Read up to maxRecords records into out, returns how many were read
+    size_t read(std::vector<TraceRecord>& out, size_t maxRecords = 65536) {
+        out.resize(maxRecords);
+        size_t count = file ? std::fread(out.data(), sizeof(TraceRecord), maxRecords, file) : 0;
+        out.resize(count);
+        return count;
+    }
+
+private:
+    std::FILE* file = nullptr;
+};
+
+#endif // TRACE_FORMAT_H
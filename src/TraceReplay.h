@@ -0,0 +1,225 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include "MappedFile.h"
+#include "TraceFormat.h"
+
+// Streams recorded tasks (arrival time, service time) out of a trace file for TaskGenerator to replay.
+// The file is memory-mapped and read front to back, so a trace of hundreds of millions of records
+// needs no more memory than a small one. Three formats are recognised:
+//   - simulation_trace.bin (binary trace): the TaskGenerated records
+//   - task_log.txt: "[Time: 12.00] Task ID: 5, Service Time: 46.16 seconds"
+//   - CSV: "timestamp,key,cost" or "timestamp,cost" (timestamp and cost in seconds); lines that do not
+//     start with a number, such as a header, and lines starting with '#' are skipped
+// The request key of a CSV trace becomes the task's key (a number as is, anything else hashed), so
+// affinity routing sees the recorded sessions; tasks still get fresh IDs from the generator.
+// The other formats have no key.
+
+enum class ReplayFormat {
+    Unknown,
+    BinaryTrace,
+    TaskLog,
+    Csv
+};
+
+struct ReplayTask {
+    double time;         // Simulation seconds since the first record: divided by timeScale, plus completed loops
+    double serviceTime;  // Seconds at power 1, as recorded
+    uint64_t key = 0;    // Request key of a CSV record, 0 for none
+};
+
+class TraceReplay {
+public:
+    // timeScale 100 replays the trace 100 times faster (gaps divided by 100); loop restarts it at the end
+    explicit TraceReplay(const std::string& path, double timeScale = 1.0, bool loop = false)
+        : file(path), data(file.view()), timeScale(timeScale > 0.0 ? timeScale : 1.0), loop(loop) {
+        if (!file.isOpen()) return;
+        if (data.size() >= sizeof(TraceHeader) && std::memcmp(data.data(), TraceMagic, sizeof(TraceMagic)) == 0) {
+            TraceHeader header;
+            std::memcpy(&header, data.data(), sizeof(header));
+            if (header.recordSize == sizeof(TraceRecord)) {
+                format = ReplayFormat::BinaryTrace;
+                begin = cursor = sizeof(TraceHeader);
+            }
+            return;
+        }
+        std::string_view head = data.substr(0, 4096);  // Sniff the start only, the file may be huge
+        format = head.find("[Time:") != std::string_view::npos &&
+                 head.find("Service Time:") != std::string_view::npos ? ReplayFormat::TaskLog : ReplayFormat::Csv;
+    }
+
+    TraceReplay(const TraceReplay&) = delete;
+    TraceReplay& operator=(const TraceReplay&) = delete;
+
+    // Opened and in a known format
+    bool isOpen() const {
+        return format != ReplayFormat::Unknown;
+    }
+
+    ReplayFormat getFormat() const {
+        return format;
+    }
+
+    // Next task in arrival order; false at the end of the trace (never, when looping a non-empty trace)
+    bool next(ReplayTask& task) {
+        double time, serviceTime;
+        uint64_t key = 0;
+        while (!readRecord(time, serviceTime, key)) {
+            // Each loop starts one average gap after the previous one ended, so arrivals keep their spacing
+            double span = lastTime - firstTime;
+            double period = passRecords > 1 ? span + span / (passRecords - 1) : 0.0;
+            if (!loop || period <= 0.0) return false;
+            loopOffset += period;
+            cursor = begin;
+            passRecords = 0;
+            ++loops;
+        }
+        if (records == 0) firstTime = time;
+        ++records;
+        ++passRecords;
+        lastTime = time;
+        task.time = (time - firstTime + loopOffset) / timeScale;
+        task.serviceTime = serviceTime;
+        task.key = key;
+        return true;
+    }
+
+    // Tasks returned so far, over all loops
+    size_t getRecords() const {
+        return records;
+    }
+
+    // Completed passes over the trace
+    size_t getLoops() const {
+        return loops;
+    }
+
+    // Text lines that were not a record (headers, comments, other log lines)
+    size_t getSkippedLines() const {
+        return skippedLines;
+    }
+
+private:
+    static constexpr size_t ReleaseEvery = 64 << 20;  // Unmap consumed pages every 64 MB
+
+    MappedFile file;
+    std::string_view data;
+    ReplayFormat format = ReplayFormat::Unknown;
+    double timeScale;
+    bool loop;
+    size_t begin = 0;       // Offset of the first record
+    size_t cursor = 0;      // Offset of the next unread byte
+    size_t released = 0;    // Pages before this offset were released
+    double firstTime = 0.0; // Recorded time of the very first record
+    double lastTime = 0.0;  // Recorded time of the latest record
+    double loopOffset = 0.0;
+    size_t records = 0;
+    size_t passRecords = 0;
+    size_t loops = 0;
+    size_t skippedLines = 0;
+
+    // Next record as recorded (unscaled); false at the end of the file
+    bool readRecord(double& time, double& serviceTime, uint64_t& key) {
+        key = 0;
+        bool found = format == ReplayFormat::BinaryTrace ? readBinary(time, serviceTime) : readText(time, serviceTime, key);
+        if (cursor < released) {
+            released = 0;  // Restarted a loop
+        } else if (cursor - released >= ReleaseEvery) {
+            file.release(cursor);
+            released = cursor;
+        }
+        return found;
+    }
+
+    bool readBinary(double& time, double& serviceTime) {
+        while (cursor + sizeof(TraceRecord) <= data.size()) {
+            TraceRecord record;
+            std::memcpy(&record, data.data() + cursor, sizeof(record));
+            cursor += sizeof(record);
+            if (record.type == TraceEventType::TaskGenerated) {
+                time = record.simTime;
+                serviceTime = record.serviceTime;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool readText(double& time, double& serviceTime, uint64_t& key) {
+        while (cursor < data.size()) {
+            const char* start = data.data() + cursor;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', data.size() - cursor));
+            std::string_view line(start, newline ? newline - start : data.data() + data.size() - start);
+            cursor += line.size() + 1;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty()) continue;
+            if (format == ReplayFormat::TaskLog ? parseTaskLogLine(line, time, serviceTime)
+                                                 : parseCsvLine(line, time, serviceTime, key)) {
+                return true;
+            }
+            ++skippedLines;
+        }
+        return false;
+    }
+
+    static bool parseTaskLogLine(std::string_view line, double& time, double& serviceTime) {
+        return parseAfter(line, "[Time:", time) && parseAfter(line, "Service Time:", serviceTime);
+    }
+
+    // First field is the timestamp, last field the cost; anything in between is the key
+    static bool parseCsvLine(std::string_view line, double& time, double& serviceTime, uint64_t& key) {
+        size_t firstComma = line.find(',');
+        size_t lastComma = line.rfind(',');
+        if (firstComma == std::string_view::npos) return false;
+        if (!parseNumber(line.substr(0, firstComma), time) ||
+            !parseNumber(line.substr(lastComma + 1), serviceTime) || serviceTime < 0.0) {
+            return false;
+        }
+        if (lastComma > firstComma) key = parseKey(line.substr(firstComma + 1, lastComma - firstComma - 1));
+        return true;
+    }
+
+    // A whole non-negative number is the key itself; any other text is hashed. 0 (no key) only for an
+    // empty field.
+    static uint64_t parseKey(std::string_view field) {
+        size_t first = field.find_first_not_of(" \t\"");
+        size_t last = field.find_last_not_of(" \t\"");
+        if (first == std::string_view::npos) return 0;
+        field = field.substr(first, last - first + 1);
+        uint64_t key = 0;
+        auto result = std::from_chars(field.data(), field.data() + field.size(), key);
+        if (result.ec == std::errc() && result.ptr == field.data() + field.size() && key > 0) return key;
+        key = std::hash<std::string_view>()(field);
+        return key != 0 ? key : 1;
+    }
+
+    // Number after keyword, ended by anything that is not part of it ("46.16 seconds", "0.00]")
+    static bool parseAfter(std::string_view line, std::string_view keyword, double& value) {
+        size_t pos = line.find(keyword);
+        if (pos == std::string_view::npos) return false;
+        const char* first = line.data() + pos + keyword.size();
+        const char* last = line.data() + line.size();
+        while (first < last && (*first == ' ' || *first == '\t')) ++first;
+        auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && std::isfinite(value);
+    }
+
+    // Whole field, surrounding spaces allowed
+    static bool parseNumber(std::string_view field, double& value) {
+        size_t first = field.find_first_not_of(" \t\"");
+        size_t last = field.find_last_not_of(" \t\"");
+        if (first == std::string_view::npos) return false;
+        field = field.substr(first, last - first + 1);
+        auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+        return result.ec == std::errc() && result.ptr == field.data() + field.size() && std::isfinite(value);
+    }
+};
+
+#endif // TRACE_REPLAY_H
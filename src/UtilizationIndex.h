@@ -0,0 +1,125 @@
+#ifndef UTILIZATION_INDEX_H
+#define UTILIZATION_INDEX_H
+
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <algorithm>
+
+// Thread-safe indexed 4-ary min-heap of server utilizations.
+// Server IDs index a flat position array, so update() is O(log n) and best() is O(1).
+class UtilizationIndex {
+public:
+    // Insert a server or change its utilization
+    void update(int serverId, double utilization) {
+        if (serverId < 0) return;
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (static_cast<size_t>(serverId) >= position.size()) {
+            position.resize(serverId + 1, -1);
+        }
+        int slot = position[serverId];
+        if (slot < 0) {
+            heap.push_back(Entry{utilization, serverId});
+            position[serverId] = static_cast<int>(heap.size() - 1);
+            siftUp(heap.size() - 1);
+            return;
+        }
+        double previous = heap[slot].utilization;
+        heap[slot].utilization = utilization;
+        if (utilization < previous) {
+            siftUp(slot);
+        } else {
+            siftDown(slot);
+        }
+    }
+
+    // Take a server out (it left the load balancer); O(log n)
+    void remove(int serverId) {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (serverId < 0 || static_cast<size_t>(serverId) >= position.size() || position[serverId] < 0) return;
+        size_t slot = static_cast<size_t>(position[serverId]);
+        position[serverId] = -1;
+        Entry last = heap.back();
+        heap.pop_back();
+        if (slot == heap.size()) return;
+        place(slot, last);
+        siftUp(slot);
+        siftDown(static_cast<size_t>(position[last.serverId]));
+    }
+
+    // Least utilized server (lowest ID wins ties), false when the index is empty
+    bool best(int& serverId, double& utilization) const {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (heap.empty()) return false;
+        serverId = heap.front().serverId;
+        utilization = heap.front().utilization;
+        return true;
+    }
+
+    // Current utilization of a server, 0 if it never reported
+    double get(int serverId) const {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (serverId < 0 || static_cast<size_t>(serverId) >= position.size() || position[serverId] < 0) {
+            return 0.0;
+        }
+        return heap[position[serverId]].utilization;
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        return heap.size();
+    }
+
+private:
+    static constexpr size_t Arity = 4;  // Shallower than a binary heap and children share a cache line
+
+    struct Entry {
+        double utilization;
+        int serverId;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<int> position;  // Server ID -> heap slot, -1 when absent
+    mutable std::mutex indexMutex;
+
+    static bool less(const Entry& a, const Entry& b) {
+        if (a.utilization != b.utilization) return a.utilization < b.utilization;
+        return a.serverId < b.serverId;
+    }
+
+    void place(size_t slot, const Entry& entry) {
+        heap[slot] = entry;
+        position[entry.serverId] = static_cast<int>(slot);
+    }
+
+    void siftUp(size_t slot) {
+        Entry entry = heap[slot];
+        while (slot > 0) {
+            size_t parent = (slot - 1) / Arity;
+            if (!less(entry, heap[parent])) break;
+            place(slot, heap[parent]);
+            slot = parent;
+        }
+        place(slot, entry);
+    }
+
+    void siftDown(size_t slot) {
+        Entry entry = heap[slot];
+        size_t count = heap.size();
+        while (true) {
+            size_t first = slot * Arity + 1;
+            if (first >= count) break;
+            size_t last = std::min(first + Arity, count);
+            size_t smallest = first;
+            for (size_t child = first + 1; child < last; ++child) {
+                if (less(heap[child], heap[smallest])) smallest = child;
+            }
+            if (!less(heap[smallest], entry)) break;
+            place(slot, heap[smallest]);
+            slot = smallest;
+        }
+        place(slot, entry);
+    }
+};
+
+#endif // UTILIZATION_INDEX_H
@@ -0,0 +1,279 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+// Arrival processes and service-time distributions used by TaskGenerator.
+// Both draw from the generator's random number generator, so a seeded generator repeats its workload.
+
+enum class ArrivalProcessType {
+    Deterministic,  // Exactly interArrivalTime apart (D/M/c)
+    Poisson,        // Exponential gaps with mean interArrivalTime (M/M/c)
+    MMPP,           // Poisson whose rate jumps by burstFactor during bursts (two-state Markov-modulated)
+    Diurnal         // Poisson whose rate follows a repeating piecewise-linear profile
+};
+
+enum class ServiceDistributionType {
+    Exponential,
+    Deterministic,  // Every task takes exactly the mean
+    Pareto,         // Heavy tail, shape paretoShape (> 1)
+    LogNormal       // Heavy tail, log-space standard deviation logNormalSigma
+};
+
+struct ArrivalParameters {
+    double interArrivalTime = 3.0;   // Mean gap at rate multiplier 1 (simulation seconds)
+    double burstFactor = 5.0;        // MMPP: rate multiplier while bursting
+    double burstDuration = 60.0;     // MMPP: mean length of a burst
+    double normalDuration = 600.0;   // MMPP: mean time between bursts
+    double diurnalPeriod = 86400.0;  // Diurnal: profile length; the profile repeats
+    // Diurnal: (time in period, rate multiplier) points, linear in between and wrapping around
+    std::vector<std::pair<double, double>> diurnalProfile = {{0.0, 0.3}, {21600.0, 0.6}, {43200.0, 1.5}, {64800.0, 1.2}};
+};
+
+struct ServiceParameters {
+    double averageServiceTime = 40.0;
+    double paretoShape = 1.5;
+    double logNormalSigma = 1.0;
+};
+
+// A kind of task: drawn with probability share / (sum of shares), its service time is the distribution's
+// draw times serviceScale. priority and deadline label the task for the servers' scheduling discipline.
+struct TaskClass {
+    std::string name = "default";
+    double share = 1.0;
+    double serviceScale = 1.0;
+    int priority = 0;       // Lower is served first (Priority discipline)
+    double deadline = 0.0;  // Seconds after generation (EarliestDeadlineFirst and the missed-deadline KPI), 0 for none
+};
+
+// Time to the next arrival, given the current simulation time
+class ArrivalProcess {
+public:
+    virtual ~ArrivalProcess() = default;
+    virtual std::string name() const = 0;
+    virtual double nextInterArrival(double now, std::mt19937& rng) = 0;
+};
+
+class DeterministicArrivals : public ArrivalProcess {
+public:
+    explicit DeterministicArrivals(double interval) : interval(interval) {}
+    std::string name() const override { return "Deterministic"; }
+    double nextInterArrival(double, std::mt19937&) override { return interval; }
+
+private:
+    double interval;
+};
+
+class PoissonArrivals : public ArrivalProcess {
+public:
+    explicit PoissonArrivals(double meanInterval) : gap(1.0 / meanInterval) {}
+    std::string name() const override { return "Poisson"; }
+    double nextInterArrival(double, std::mt19937& rng) override { return gap(rng); }
+
+private:
+    std::exponential_distribution<double> gap;
+};
+
+// Two-state MMPP. The state switches after exponential sojourns; since every clock here is
+// memoryless, racing the next arrival against the next switch is exact.
+class MmppArrivals : public ArrivalProcess {
+public:
+    MmppArrivals(double meanInterval, double burstFactor, double burstDuration, double normalDuration)
+        : rates{1.0 / meanInterval, burstFactor / meanInterval},
+          switchRates{1.0 / normalDuration, 1.0 / burstDuration} {}
+
+    std::string name() const override { return "MMPP"; }
+
+    double nextInterArrival(double, std::mt19937& rng) override {
+        double elapsed = 0.0;
+        while (true) {
+            double arrival = std::exponential_distribution<double>(rates[bursting])(rng);
+            double change = std::exponential_distribution<double>(switchRates[bursting])(rng);
+            if (arrival <= change) return elapsed + arrival;
+            elapsed += change;
+            bursting = !bursting;
+        }
+    }
+
+    bool isBursting() const {
+        return bursting;
+    }
+
+    // Long-run arrival rate: each state's rate weighted by its share of time
+    double averageRate() const {
+        double normalShare = (1.0 / switchRates[0]) / (1.0 / switchRates[0] + 1.0 / switchRates[1]);
+        return normalShare * rates[0] + (1.0 - normalShare) * rates[1];
+    }
+
+private:
+    double rates[2];
+    double switchRates[2];
+    int bursting = 0;
+};
+
+// Non-homogeneous Poisson by thinning: propose at the peak rate, keep with probability rate(t) / peak
+class DiurnalArrivals : public ArrivalProcess {
+public:
+    DiurnalArrivals(double meanInterval, double period, std::vector<std::pair<double, double>> profile)
+        : baseRate(1.0 / meanInterval), period(period), points(std::move(profile)) {
+        std::sort(points.begin(), points.end());
+        for (const auto& point : points) peak = std::max(peak, point.second);
+    }
+
+    std::string name() const override { return "Diurnal"; }
+
+    double nextInterArrival(double now, std::mt19937& rng) override {
+        if (peak <= 0.0) return period;  // Silent profile: check again next period
+        std::exponential_distribution<double> proposal(baseRate * peak);
+        std::uniform_real_distribution<double> accept(0.0, peak);
+        double t = now;
+        do {
+            t += proposal(rng);
+        } while (accept(rng) > multiplier(t));
+        return t - now;
+    }
+
+    // Rate multiplier at time t, interpolated between the profile points
+    double multiplier(double t) const {
+        if (points.empty()) return 1.0;
+        double phase = std::fmod(t, period);
+        if (phase < 0.0) phase += period;
+        for (size_t i = 0; i < points.size(); ++i) {
+            const auto& next = points[i];
+            if (phase < next.first) {
+                // Between the previous point (the last one, shifted back a period, before the first) and next
+                auto previous = i > 0 ? points[i - 1] : std::make_pair(points.back().first - period, points.back().second);
+                return interpolate(previous, next, phase);
+            }
+        }
+        auto next = std::make_pair(points.front().first + period, points.front().second);
+        return interpolate(points.back(), next, phase);
+    }
+
+private:
+    double baseRate;
+    double period;
+    std::vector<std::pair<double, double>> points;
+    double peak = 0.0;
+
+    static double interpolate(const std::pair<double, double>& from, const std::pair<double, double>& to, double t) {
+        double span = to.first - from.first;
+        if (span <= 0.0) return to.second;
+        return from.second + (to.second - from.second) * (t - from.first) / span;
+    }
+};
+
+inline std::unique_ptr<ArrivalProcess> makeArrivalProcess(ArrivalProcessType type, const ArrivalParameters& parameters) {
+    switch (type) {
+        case ArrivalProcessType::Poisson: return std::make_unique<PoissonArrivals>(parameters.interArrivalTime);
+        case ArrivalProcessType::MMPP:
+            return std::make_unique<MmppArrivals>(parameters.interArrivalTime, parameters.burstFactor,
+                                                  parameters.burstDuration, parameters.normalDuration);
+        case ArrivalProcessType::Diurnal:
+            return std::make_unique<DiurnalArrivals>(parameters.interArrivalTime, parameters.diurnalPeriod,
+                                                     parameters.diurnalProfile);
+        case ArrivalProcessType::Deterministic:
+        default: return std::make_unique<DeterministicArrivals>(parameters.interArrivalTime);
+    }
+}
+
+// Session or cache keys 1..count, key k drawn with probability proportional to 1 / k^skew (0 = uniform,
+// around 1 for web caches). Inverse CDF by binary search: O(log count) per key, 8 bytes per key.
+class ZipfKeys {
+public:
+    ZipfKeys(size_t count, double skew) : cumulative(std::max<size_t>(count, 1)) {
+        double total = 0.0;
+        for (size_t key = 0; key < cumulative.size(); ++key) {
+            total += std::pow(static_cast<double>(key + 1), -skew);
+            cumulative[key] = total;
+        }
+    }
+
+    uint64_t sample(std::mt19937& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, cumulative.back())(rng);
+        size_t index = std::upper_bound(cumulative.begin(), cumulative.end(), u) - cumulative.begin();
+        return std::min(index, cumulative.size() - 1) + 1;
+    }
+
+private:
+    std::vector<double> cumulative;
+};
+
+// Service time of one task (seconds at power 1)
+class ServiceTimeDistribution {
+public:
+    virtual ~ServiceTimeDistribution() = default;
+    virtual std::string name() const = 0;
+    virtual double sample(std::mt19937& rng) = 0;
+};
+
+class ExponentialService : public ServiceTimeDistribution {
+public:
+    explicit ExponentialService(double mean) : distribution(1.0 / mean) {}
+    std::string name() const override { return "Exponential"; }
+    double sample(std::mt19937& rng) override { return distribution(rng); }
+
+private:
+    std::exponential_distribution<double> distribution;
+};
+
+class DeterministicService : public ServiceTimeDistribution {
+public:
+    explicit DeterministicService(double mean) : mean(mean) {}
+    std::string name() const override { return "Deterministic"; }
+    double sample(std::mt19937&) override { return mean; }
+
+private:
+    double mean;
+};
+
+// Scale chosen so the mean is `mean`: scale = mean * (shape - 1) / shape
+class ParetoService : public ServiceTimeDistribution {
+public:
+    ParetoService(double mean, double shape) : shape(shape), scale(mean * (shape - 1.0) / shape) {}
+    std::string name() const override { return "Pareto (shape " + std::to_string(shape) + ")"; }
+
+    double sample(std::mt19937& rng) override {
+        double u = 1.0 - std::uniform_real_distribution<double>(0.0, 1.0)(rng);  // (0, 1]
+        return scale / std::pow(u, 1.0 / shape);
+    }
+
+private:
+    double shape;
+    double scale;
+};
+
+// mu chosen so the mean is `mean`: mu = ln(mean) - sigma^2 / 2
+class LogNormalService : public ServiceTimeDistribution {
+public:
+    LogNormalService(double mean, double sigma)
+        : sigma(sigma), distribution(std::log(mean) - sigma * sigma / 2.0, sigma) {}
+    std::string name() const override { return "LogNormal (sigma " + std::to_string(sigma) + ")"; }
+    double sample(std::mt19937& rng) override { return distribution(rng); }
+
+private:
+    double sigma;
+    std::lognormal_distribution<double> distribution;
+};
+
+inline std::unique_ptr<ServiceTimeDistribution> makeServiceDistribution(ServiceDistributionType type,
+                                                                       const ServiceParameters& parameters) {
+    switch (type) {
+        case ServiceDistributionType::Deterministic: return std::make_unique<DeterministicService>(parameters.averageServiceTime);
+        case ServiceDistributionType::Pareto:
+            return std::make_unique<ParetoService>(parameters.averageServiceTime, parameters.paretoShape);
+        case ServiceDistributionType::LogNormal:
+            return std::make_unique<LogNormalService>(parameters.averageServiceTime, parameters.logNormalSigma);
+        case ServiceDistributionType::Exponential:
+        default: return std::make_unique<ExponentialService>(parameters.averageServiceTime);
+    }
+}
+
+#endif // WORKLOAD_H
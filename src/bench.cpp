@@ -0,0 +1,319 @@
+// Regression benchmark: runs fixed, deterministic scenarios and compares them against recorded baselines.
+//
+//   g++ -std=c++17 -O2 -pthread bench.cpp -o bench
+//   ./bench                         # compare against bench_baseline.csv, exit 1 on a regression
+//   ./bench record=1                # run and write the current results as the new baseline
+//   ./bench scenarios=default,bursty repeat=5 baseline=other.csv out=bench logs=1
+//   ./bench list=1                  # print the scenarios
+//
+// Every scenario runs with a fixed seed in deterministic mode, so its KPIs and trace digest must match
+// the baseline exactly; any drift is a behaviour change, not noise. Speed (simulator events per second,
+// best of `repeat` runs) and peak resident size are machine dependent and only fail past a tolerance:
+//   speedTolerance=0.3   fail when events/s drops by more than 30%
+//   rssTolerance=0.25    fail when peak RSS grows by more than 25%
+//   kpiTolerance=0       largest allowed relative KPI difference
+// Text logs keep only warnings unless logs=1, so the numbers are the simulator's rather than the log writer's
+// (the binary trace is always written: its digest is what proves a run bit-identical).
+// Each run happens in a child process so its peak RSS is its own. Results also go to <out>/bench_results.csv.
+
+#include <cstdio>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include "ConfigFile.h"
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+struct Scenario {
+    string name;
+    string description;
+    vector<string> settings;  // Config overrides on top of the defaults
+    vector<ServerPool> pools;
+};
+
+// Fixed scenarios. Changing one invalidates its baseline: record again.
+vector<Scenario> scenarios() {
+    return {
+        {"default", "main.cpp defaults (3 servers, one task every 3 s) over a day",
+         {"simulationDuration=86400"}, {}},
+        {"heavy_jsq", "8 equal servers at 83% load, join shortest queue, 1 day",
+         {"numberOfServers=8", "basePower=20", "powerStep=0", "interArrivalTime=0.3", "simulationDuration=86400",
+          "routingPolicy=JoinShortestQueue", "arrivalProcess=Poisson"}, {}},
+        {"bursty", "MMPP bursts and Pareto service times, power of two choices, work stealing, 1 day",
+         {"arrivalProcess=MMPP", "burstFactor=3", "interArrivalTime=1.5", "serviceDistribution=Pareto",
+          "simulationDuration=86400", "routingPolicy=PowerOfDChoices", "workStealing=true"}, {}},
+        {"pools", "Two small servers and one 4-core server, diurnal load, least expected work, drop oldest, 1 day",
+         {"arrivalProcess=Diurnal", "interArrivalTime=1.2", "diurnalPeriod=21600",
+          "diurnalProfile=0:0.4, 10800:1.6", "simulationDuration=86400", "routingPolicy=LeastExpectedWork",
+          "overflowPolicy=DropOldest", "maxBacklogWait=120"},
+         {ServerPool{2, 15.0, 10, 1}, ServerPool{1, 60.0, 40, 4}}},
+        {"overload", "Default servers at twice their capacity, 50-task backlog, 1 day",
+         {"interArrivalTime=0.5", "backlogCapacity=50", "arrivalProcess=Poisson", "simulationDuration=86400"}, {}},
+    };
+}
+
+// One scenario run; plain data so a child process can send it through a pipe
+struct BenchSample {
+    uint64_t events = 0;
+    double wallSeconds = 0.0;
+    long peakRssKb = 0;
+    uint64_t traceDigest = 0;
+    double completed = 0.0;
+    double throughput = 0.0;
+    double utilization = 0.0;
+    double waitMean = 0.0;
+    double delayMean = 0.0;
+    double delayP99 = 0.0;
+    double dropRate = 0.0;
+
+    double eventsPerSecond() const {
+        return wallSeconds > 0.0 ? events / wallSeconds : 0.0;
+    }
+};
+
+// KPIs compared for drift, in CSV column order
+const vector<pair<const char*, double BenchSample::*>> kpiColumns = {
+    {"completed", &BenchSample::completed}, {"throughput", &BenchSample::throughput},
+    {"utilization", &BenchSample::utilization}, {"wait_mean", &BenchSample::waitMean},
+    {"delay_mean", &BenchSample::delayMean}, {"delay_p99", &BenchSample::delayP99},
+    {"drop_rate", &BenchSample::dropRate},
+};
+
+BenchSample runScenario(const SimulationConfig& config, bool keepLogs) {
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(keepLogs ? LogLevel::Info : LogLevel::Warning);
+    auto start = chrono::steady_clock::now();
+    SimulationResult result = runSimulation(config);
+    BenchSample sample;
+    sample.wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    sample.events = result.events;
+    sample.traceDigest = result.traceDigest;
+    const ServerKpi& all = result.kpis.global;
+    sample.completed = static_cast<double>(all.completed);
+    sample.throughput = all.throughput;
+    sample.utilization = all.utilization;
+    sample.waitMean = all.waitTime.mean;
+    sample.delayMean = all.delay.mean;
+    sample.delayP99 = all.delayHistogram.percentile(99);
+    sample.dropRate = result.admission.dropRate();
+#if !defined(_WIN32)
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    sample.peakRssKb = usage.ru_maxrss;
+#endif
+    return sample;
+}
+
+// Run in a child process (the parent never starts the Logger, so the child owns its only writer thread)
+bool runIsolated(const SimulationConfig& config, bool keepLogs, BenchSample& sample) {
+#if defined(_WIN32)
+    sample = runScenario(config, keepLogs);  // No fork: peak RSS is not measured
+    return true;
+#else
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    pid_t child = fork();
+    if (child < 0) return false;
+    if (child == 0) {
+        close(fds[0]);
+        BenchSample result = runScenario(config, keepLogs);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t received = read(fds[0], &sample, sizeof(sample));
+    close(fds[0]);
+    int status = 0;
+    waitpid(child, &status, 0);
+    return received == static_cast<ssize_t>(sizeof(sample)) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#endif
+}
+
+string hexDigest(uint64_t digest) {
+    ostringstream text;
+    text << hex << setw(16) << setfill('0') << digest;
+    return text.str();
+}
+
+void writeResults(const string& path, const vector<pair<string, BenchSample>>& results) {
+    ofstream file(path);
+    file << "scenario,events,events_per_sec,peak_rss_kb,trace_digest";
+    for (const auto& column : kpiColumns) file << "," << column.first;
+    file << "\n" << setprecision(17);
+    for (const auto& [name, sample] : results) {
+        file << name << "," << sample.events << "," << sample.eventsPerSecond() << "," << sample.peakRssKb << ","
+             << hexDigest(sample.traceDigest);
+        for (const auto& column : kpiColumns) file << "," << sample.*column.second;
+        file << "\n";
+    }
+}
+
+map<string, BenchSample> readBaseline(const string& path) {
+    map<string, BenchSample> baseline;
+    ifstream file(path);
+    string line;
+    getline(file, line);  // Header
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        stringstream fields(line);
+        string name, events, rate, rss, digest;
+        if (!getline(fields, name, ',') || !getline(fields, events, ',') || !getline(fields, rate, ',') ||
+            !getline(fields, rss, ',') || !getline(fields, digest, ',')) continue;
+        BenchSample sample;
+        sample.events = stoull(events);
+        sample.wallSeconds = stod(rate) > 0.0 ? sample.events / stod(rate) : 0.0;
+        sample.peakRssKb = stol(rss);
+        sample.traceDigest = stoull(digest, nullptr, 16);
+        for (const auto& column : kpiColumns) {
+            string value;
+            if (getline(fields, value, ',')) sample.*column.second = stod(value);
+        }
+        baseline[name] = sample;
+    }
+    return baseline;
+}
+
+string percent(double now, double before) {
+    if (before <= 0.0) return "n/a";
+    ostringstream text;
+    text << showpos << fixed << setprecision(1) << (now / before - 1.0) * 100.0 << "%";
+    return text.str();
+}
+
+int main(int argc, char const *argv[]) {
+    string baselinePath = "bench_baseline.csv";
+    string outputDir = "bench";
+    string only;
+    bool record = false;
+    bool keepLogs = false;
+    int repeat = 5;
+    double speedTolerance = 0.3, rssTolerance = 0.25, kpiTolerance = 0.0;
+
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        string name = argument.substr(0, equals);
+        string value = equals == string::npos ? "" : argument.substr(equals + 1);
+        if (name == "baseline") baselinePath = value;
+        else if (name == "out") outputDir = value;
+        else if (name == "scenarios") only = "," + value + ",";
+        else if (name == "record") record = value != "0";
+        else if (name == "list") {
+            for (const Scenario& scenario : scenarios()) cout << left << setw(11) << scenario.name << scenario.description << endl;
+            return 0;
+        }
+        else if (name == "logs") keepLogs = value != "0";
+        else if (name == "repeat") repeat = max(1, atoi(value.c_str()));
+        else if (name == "speedTolerance") speedTolerance = atof(value.c_str());
+        else if (name == "rssTolerance") rssTolerance = atof(value.c_str());
+        else if (name == "kpiTolerance") kpiTolerance = atof(value.c_str());
+        else {
+            cerr << "Unknown option: " << argument << endl;
+            return 1;
+        }
+    }
+
+    map<string, BenchSample> baseline = readBaseline(baselinePath);
+    if (!record && baseline.empty()) {
+        cerr << "No baseline in " << baselinePath << "; run with record=1 first" << endl;
+        return 1;
+    }
+    filesystem::create_directories(outputDir);
+
+    vector<pair<string, BenchSample>> results;
+    bool regression = false;
+    cout << left << setw(11) << "scenario" << right << setw(13) << "events/s" << setw(9) << "vs base"
+         << setw(10) << "RSS MB" << setw(9) << "vs base" << setw(12) << "KPI drift" << "  trace" << endl;
+
+    for (const Scenario& scenario : scenarios()) {
+        if (!only.empty() && only.find("," + scenario.name + ",") == string::npos) continue;
+        SimulationConfig config;
+        config.seed = 1;
+        config.deterministic = true;
+        config.consoleEcho = false;
+        config.outputDir = outputDir + "/" + scenario.name;
+        config.serverPools = scenario.pools;
+        ConfigLoader loader(config);
+        for (const string& setting : scenario.settings) loader.applyOverride(setting);
+        loader.validate();
+        if (!loader.ok()) {
+            cerr << scenario.name << ": " << loader.getErrors().front() << endl;
+            return 1;
+        }
+
+        // Best speed of the repeats; the peak RSS and the deterministic results are the same in each
+        BenchSample best;
+        long peakRssKb = 0;
+        for (int run = 0; run < repeat; ++run) {
+            BenchSample sample;
+            if (!runIsolated(config, keepLogs, sample)) {
+                cerr << scenario.name << ": run failed" << endl;
+                return 1;
+            }
+            if (run == 0 || sample.eventsPerSecond() > best.eventsPerSecond()) best = sample;
+            peakRssKb = max(peakRssKb, sample.peakRssKb);
+        }
+        best.peakRssKb = peakRssKb;
+        results.emplace_back(scenario.name, best);
+
+        cout << left << setw(11) << scenario.name << right << fixed << setprecision(0) << setw(13)
+             << best.eventsPerSecond() << setprecision(1);
+        auto base = baseline.find(scenario.name);
+        if (record || base == baseline.end()) {
+            cout << setw(9) << "-" << setw(10) << best.peakRssKb / 1024.0 << setw(9) << "-" << setw(12) << "-"
+                 << "  " << hexDigest(best.traceDigest) << (record ? "" : " (no baseline)") << endl;
+            continue;
+        }
+        const BenchSample& before = base->second;
+        double drift = 0.0;
+        const char* worst = "";
+        for (const auto& column : kpiColumns) {
+            double now = best.*column.second, then = before.*column.second;
+            double difference = now == then ? 0.0 : fabs(now - then) / max(fabs(then), 1e-12);
+            if (difference > drift) {
+                drift = difference;
+                worst = column.first;
+            }
+        }
+        bool slower = best.eventsPerSecond() < before.eventsPerSecond() * (1.0 - speedTolerance);
+        bool bigger = before.peakRssKb > 0 && best.peakRssKb > before.peakRssKb * (1.0 + rssTolerance);
+        bool drifted = drift > kpiTolerance;
+        bool traceChanged = best.traceDigest != before.traceDigest;
+        regression = regression || slower || bigger || drifted || traceChanged;
+
+        ostringstream driftText;
+        if (drift == 0.0) driftText << "0";
+        else driftText << setprecision(2) << drift * 100.0 << "% " << worst;
+        cout << setw(9) << percent(best.eventsPerSecond(), before.eventsPerSecond()) << setw(10)
+             << best.peakRssKb / 1024.0 << setw(9) << percent(best.peakRssKb, before.peakRssKb) << setw(12)
+             << driftText.str() << "  " << (traceChanged ? "CHANGED" : "identical")
+             << (slower ? "  SLOWER" : "") << (bigger ? "  BIGGER" : "") << (drifted ? "  KPI DRIFT" : "") << endl;
+    }
+
+    writeResults(outputDir + "/bench_results.csv", results);
+    if (record) {
+        // Scenarios that did not run keep their old baseline
+        vector<pair<string, BenchSample>> merged;
+        for (const Scenario& scenario : scenarios()) {
+            auto fresh = find_if(results.begin(), results.end(), [&](const auto& result) { return result.first == scenario.name; });
+            if (fresh != results.end()) merged.push_back(*fresh);
+            else if (baseline.count(scenario.name)) merged.emplace_back(scenario.name, baseline[scenario.name]);
+        }
+        writeResults(baselinePath, merged);
+        cout << "Recorded " << results.size() << " scenarios to " << baselinePath << endl;
+        return 0;
+    }
+    cout << (regression ? "Regression against " : "No regression against ") << baselinePath << endl;
+    return regression ? 1 : 0;
+}
@@ -1,56 +1,52 @@
-#include "GlobalClock.h"
-#include "LoadBalancer.h"
-#include "Analyzer.h"
-#include "SERVERQUEUE.h"
-#include "TASKGENERATOR.h"
+#include "ConfigFile.h"
+#include <ctime>
 
 using namespace std;
 
+// ./simulation [config.ini] [key=value ...]  (see simulation.ini for every key and its default)
 int main(int argc, char const *argv[]) {
-    double speed = 10; // Control the speed of the clock (eq -> simulation time = actual time * speed)
-    double averageServiceTime = 40.0; // Control the average service time of the 
-    int NumberofServers = 3; // Conrtol number of servers used
-
-    GlobalClock clock(speed);// Create clock instance with the controled speed
-    LoadBalancer LB;// Create load balacer server instance
-    TaskGenerator TG(averageServiceTime, "task_log.txt", &clock);// Create task genrator server instance (average service time - log file - clock reference)
-
-    vector<shared_ptr<ServerQueue>> servers;// Create a vector of server instance .
-    for (int i = 0; i < NumberofServers; ++i) {
-    // (service id - server processing power - qeue size - clock reference - utilization call back function)
-        servers.push_back(make_shared<ServerQueue>(
-            i + 1, 15.0 + i * 5, 10 + i * 5, &clock,
-            [&LB](pair<int, double> utilizationData) {
-                LB.trackUtil(utilizationData.first, utilizationData.second);
-            }));
+    SimulationConfig config; // Defaults: 3 servers, 40 s average service time, one task every 3 s, 2h in virtual time
+    ConfigLoader loader(config);
+    // Config files first, then command-line overrides, whatever their order
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument == "-h" || argument == "--help") {
+            cout << "Usage: " << argv[0] << " [config.ini] [key=value ...]" << endl;
+            return 0;
+        }
+        if (argument.find('=') == string::npos) loader.loadFile(argument);
+    }
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        if (argument.find('=') != string::npos) loader.applyOverride(argument);
     }
-    
-    LB.setServers(servers);//Conect all the servers to the load balacer
-    
-    //(Task generate frequency (inter arrival time)- task call back function)
-    TG.start(0.3, [&LB](pair<int, double> task) {
-        Task tasklb = {task.first, task.second};
-        LB.sendTask(tasklb);
-    });
-    
-    double simulationDuration = 2 * 3600;//Set a simulation duration for 2h 
-    while (clock.getCurrentTime() < simulationDuration) {
-        this_thread::sleep_for(chrono::milliseconds(100));// Avoid busy waiting
+    loader.validate();
+    if (!loader.ok()) {
+        for (const string& error : loader.getErrors()) {
+            cerr << "Config error: " << error << endl;
+        }
+        return 1;
     }
 
-    TG.stop(); //Manual stop task genrator server 
+    Logger::instance().setConsoleEcho(config.consoleEcho);
+    SimulationResult result = runSimulation(config);
 
-    for (int i = 0; i < NumberofServers; ++i) {
-        servers[i]->calculateAverageWaitTime();// calculate average waitTime for each server
-        servers[i]->calculateAverageQueueOccupancy();// calculate average queue occupancy for each server
-        servers[i]->stopProcessing(); // Manual stop each server to avoid destructor being called automatically
-    }
+    const KpiSnapshot& results = result.kpis;
+    cout << "Completed: " << results.global.completed << ", Throughput: " << results.global.throughput
+         << " tasks/s, Average Waiting time: " << results.global.waitTime.mean
+         << " s, Average Delay time: " << results.global.delay.mean << " s, p99 Delay: "
+         << results.global.delayHistogram.percentile(99) << " s" << endl;
 
-    vector<string> logFiles;
-    for (int i = 0; i < NumberofServers; ++i) {
-        logFiles.push_back("server" + to_string(i + 1) + "_log.txt");
+    if (config.deterministic) {
+        // Equal digests mean bit-identical traces, so two runs (or two builds) can be compared at a glance
+        cout << "Events: " << result.events << ", Trace digest: " << hex << result.traceDigest << dec << endl;
     }
-    analyzer(logFiles, "task_log.txt");// Analyze the simulation results
+
+    int completedTasks = result.completedTasks;
+    double cpuSeconds = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;// process CPU time over all threads
+    cout << "CPU time: " << cpuSeconds << " s, per completed task: "
+         << (completedTasks > 0 ? cpuSeconds * 1e6 / completedTasks : 0.0) << " us ("
+         << completedTasks << " tasks)" << endl;
 
     return 0;
 }
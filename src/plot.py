@@ -1,16 +1,28 @@
+import os
+import sys
 import matplotlib.pyplot as plt
 
-# Read and parse the results file
+# Usage: python plot.py [results file] [latency_cdf.txt ...]
+# Several CDF files (e.g. one per routing policy run) are drawn on the same plot.
+results_file = sys.argv[1] if len(sys.argv) > 1 else "testFiles/plot_test.txt"
+cdf_files = sys.argv[2:] if len(sys.argv) > 2 else ["latency_cdf.txt"]
+
+# Read and parse the results file ("Key: value" pairs separated by ", ")
 results = {}
-with open("testFiles/plot_test.txt", "r") as file:
+classes = {}  # "Class: name" lines, one per task class
+with open(results_file, "r") as file:
     for line in file:
-        parts = line.split(", ")
-        server_id = int(parts[0].split(": ")[1])
-        avg_delay = float(parts[1].split(": ")[1])
-        avg_waiting = float(parts[2].split(": ")[1])
-        avg_queue_length = int(parts[3].split(": ")[1])
-        
-        results[server_id] = (avg_delay, avg_waiting, avg_queue_length)
+        fields = dict(part.split(": ", 1) for part in line.strip().split(", ") if ": " in part)
+        if "Class" in fields:
+            classes[fields["Class"]] = {key: float(value) for key, value in fields.items() if key != "Class"}
+            continue
+        server_id = int(fields["Server ID"])
+        avg_delay = float(fields["Average Delay time"])
+        avg_waiting = float(fields["Average Waiting time"])
+        avg_queue_length = int(fields["Average Queue length"])
+        percentiles = {key: float(value) for key, value in fields.items() if " p" in key}
+
+        results[server_id] = (avg_delay, avg_waiting, avg_queue_length, percentiles)
 
 # Extract data for plotting
 server_ids = list(results.keys())
@@ -29,4 +41,59 @@ plt.ylabel("Metrics")
 plt.title("Servers Performance Metrics")
 plt.xticks([p + 0.3 for p in x], server_ids)
 plt.legend()
+
+# Tail latency: delay and waiting time percentiles per server
+if all("Delay p99" in results[i][3] for i in server_ids):
+    plt.figure()
+    bars = [("Delay p50", 'red'), ("Delay p99", 'darkred'), ("Delay p99.9", 'black'),
+            ("Waiting p50", 'orange'), ("Waiting p99", 'darkorange'), ("Waiting p99.9", 'saddlebrown')]
+    width = 0.8 / len(bars)
+    for n, (key, color) in enumerate(bars):
+        plt.bar([p + n * width for p in x], [results[i][3][key] for i in server_ids], width=width, color=color, label=key)
+    plt.xlabel("Server ID")
+    plt.ylabel("Seconds")
+    plt.title("Tail Latency (p50 / p99 / p99.9)")
+    plt.xticks([p + 0.4 - width / 2 for p in x], server_ids)
+    plt.legend()
+
+# Tail latency per task class, and how many of each class missed its deadline
+if classes:
+    plt.figure()
+    names = list(classes.keys())
+    cx = range(len(names))
+    bars = [("Delay p50", 'red'), ("Delay p99", 'darkred'), ("Delay p99.9", 'black')]
+    width = 0.8 / len(bars)
+    for n, (key, color) in enumerate(bars):
+        plt.bar([p + n * width for p in cx], [classes[name][key] for name in names], width=width, color=color, label=key)
+    labels = ["%s\n%d missed" % (name, classes[name]["Missed deadlines"]) for name in names]
+    plt.xlabel("Task class")
+    plt.ylabel("Seconds")
+    plt.yscale("log")
+    plt.title("Tail Latency per Class")
+    plt.xticks([p + 0.4 - width / 2 for p in cx], labels)
+    plt.legend()
+
+# CDF of end-to-end delay, from the "<server> <metric> <seconds> <fraction>" lines written by the simulation
+cdf_files = [path for path in cdf_files if os.path.exists(path)]
+if cdf_files:
+    plt.figure()
+    for path in cdf_files:
+        curves = {}
+        with open(path, "r") as file:
+            for line in file:
+                server, metric, value, fraction = line.split()
+                if metric == "delay":
+                    curves.setdefault(server, ([], []))
+                    curves[server][0].append(float(value))
+                    curves[server][1].append(float(fraction))
+        for server, (values, fractions) in curves.items():
+            label = "Server " + server if len(cdf_files) == 1 else os.path.basename(path) + " " + server
+            plt.step(values, fractions, where="post", label=label, linewidth=2 if server == "All" else 1)
+    plt.xscale("log")
+    plt.xlabel("End-to-end delay (seconds)")
+    plt.ylabel("Fraction of tasks")
+    plt.title("Delay CDF")
+    plt.grid(True, which="both", alpha=0.3)
+    plt.legend()
+
 plt.show()
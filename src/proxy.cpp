@@ -0,0 +1,230 @@
+// Real TCP load balancing with the simulator's routing policies (Linux only).
+//
+//   g++ -std=c++17 -O2 -pthread proxy.cpp -o proxy
+//   ./proxy serve port=8080 backends=10.0.0.1:9000,10.0.0.2:9000 [weights=15,20] [capacity=64]
+//                 [routingPolicy=LowestUtilization] [workers=N] [seconds=0]
+//   ./proxy backend port=9001 [power=15] [queueSize=10] [cores=1] [averageServiceTime=40] [timeScale=0.001]
+//   ./proxy loadgen target=127.0.0.1:8080 [connections=16] [seconds=5] [reconnect=0]
+//   ./proxy demo [connections=16] [seconds=3] [reconnect=0] [workers=N]
+//
+// serve runs the proxy until killed (or for `seconds`), printing each backend's counters every 5 s.
+// backend runs a BackendServer, the stand-in for a ServerQueue with the same parameters.
+// loadgen measures requests per second and the latency distribution through a proxy or a backend.
+// demo starts the default three servers (power 15, 20, 25; queue 10, 15, 20) as backends on loopback
+// and runs loadgen through the proxy once per routing policy.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include "TcpProxy.h"
+#include "BackendServer.h"
+#include "LoadGenerator.h"
+
+using namespace std;
+
+#if defined(__linux__)
+
+const map<string, RoutingPolicyType> Policies = {
+    {"LowestUtilization", RoutingPolicyType::LowestUtilization}, {"RoundRobin", RoutingPolicyType::RoundRobin},
+    {"WeightedRoundRobin", RoutingPolicyType::WeightedRoundRobin},
+    {"JoinShortestQueue", RoutingPolicyType::JoinShortestQueue},
+    {"PowerOfDChoices", RoutingPolicyType::PowerOfDChoices},
+    {"LeastExpectedWork", RoutingPolicyType::LeastExpectedWork}};
+
+vector<string> splitList(const string& text) {
+    vector<string> items;
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// "host:port"
+bool parseAddress(const string& text, string& host, uint16_t& port) {
+    size_t colon = text.rfind(':');
+    if (colon == string::npos) return false;
+    host = text.substr(0, colon);
+    int value = atoi(text.c_str() + colon + 1);
+    if (value <= 0 || value > 65535) return false;
+    port = static_cast<uint16_t>(value);
+    return true;
+}
+
+void printResult(const string& label, const LoadResult& result) {
+    cout << left << setw(20) << label << right << fixed << setprecision(0) << setw(10) << result.requestsPerSecond()
+         << setprecision(2) << setw(10) << result.latency.percentile(50) * 1e3 << setw(10)
+         << result.latency.percentile(99) * 1e3 << setw(8) << result.busy << setw(8) << result.errors;
+}
+
+void printBackends(const TcpProxy& proxy) {
+    for (size_t i = 0; i < proxy.getBackendCount(); ++i) {
+        BackendSnapshot stats = proxy.getBackendStats(i);
+        cout << "  backend " << i + 1 << ": " << stats.active << " active, " << stats.connections << " connections, "
+             << stats.failures << " failed, " << stats.responses << " responses, latency " << fixed
+             << setprecision(2) << stats.latency * 1e3 << " ms, utilization " << setprecision(3) << stats.utilization
+             << endl;
+    }
+}
+
+int runServe(map<string, string>& options) {
+    vector<BackendEndpoint> backends;
+    for (const string& address : splitList(options["backends"])) {
+        BackendEndpoint backend;
+        if (!parseAddress(address, backend.host, backend.port)) {
+            cerr << "Bad backend address: " << address << endl;
+            return 1;
+        }
+        if (!options["capacity"].empty()) backend.capacity = atoi(options["capacity"].c_str());
+        backends.push_back(backend);
+    }
+    vector<string> weights = splitList(options["weights"]);
+    if (!weights.empty() && weights.size() != backends.size()) {
+        cerr << "Expected " << backends.size() << " weights, got " << weights.size() << endl;
+        return 1;
+    }
+    for (size_t i = 0; i < weights.size(); ++i) backends[i].weight = atof(weights[i].c_str());
+    if (backends.empty()) {
+        cerr << "No backends: backends=host:port,host:port" << endl;
+        return 1;
+    }
+    string policyName = options["routingPolicy"].empty() ? "LowestUtilization" : options["routingPolicy"];
+    if (!Policies.count(policyName)) {
+        cerr << "Unknown routingPolicy: " << policyName << endl;
+        return 1;
+    }
+    TcpProxy proxy(backends, Policies.at(policyName));
+    if (!proxy.start(static_cast<uint16_t>(atoi(options["port"].c_str())), atoi(options["workers"].c_str()))) {
+        cerr << "Cannot start the proxy: " << proxy.getError() << endl;
+        return 1;
+    }
+    cout << "Proxy on port " << proxy.getPort() << " routing by " << policyName << endl;
+    double seconds = atof(options["seconds"].c_str());
+    auto end = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    while (seconds <= 0.0 || chrono::steady_clock::now() < end) {
+        this_thread::sleep_for(chrono::seconds(5));
+        printBackends(proxy);
+    }
+    proxy.stop();
+    return 0;
+}
+
+BackendParameters backendParameters(map<string, string>& options) {
+    BackendParameters parameters;
+    if (!options["power"].empty()) parameters.processingPower = atof(options["power"].c_str());
+    if (!options["queueSize"].empty()) parameters.queueSize = atoi(options["queueSize"].c_str());
+    if (!options["cores"].empty()) parameters.cores = atoi(options["cores"].c_str());
+    if (!options["averageServiceTime"].empty()) parameters.averageServiceTime = atof(options["averageServiceTime"].c_str());
+    if (!options["timeScale"].empty()) parameters.timeScale = atof(options["timeScale"].c_str());
+    return parameters;
+}
+
+int runBackend(map<string, string>& options) {
+    BackendServer backend(backendParameters(options));
+    if (!backend.start(static_cast<uint16_t>(atoi(options["port"].c_str())), "0.0.0.0")) {
+        cerr << "Cannot listen on port " << options["port"] << endl;
+        return 1;
+    }
+    cout << "Backend on port " << backend.getPort() << endl;
+    while (true) {
+        this_thread::sleep_for(chrono::seconds(5));
+        cout << "  served " << backend.getServed() << ", rejected " << backend.getRejected() << endl;
+    }
+}
+
+int runLoadgen(map<string, string>& options) {
+    string host;
+    uint16_t port;
+    if (!parseAddress(options["target"], host, port)) {
+        cerr << "Expected target=host:port" << endl;
+        return 1;
+    }
+    int connections = options["connections"].empty() ? 16 : atoi(options["connections"].c_str());
+    double seconds = options["seconds"].empty() ? 5.0 : atof(options["seconds"].c_str());
+    LoadResult result = LoadGenerator(host, port).run(connections, seconds, options["reconnect"] == "1");
+    cout << left << setw(20) << "target" << right << setw(10) << "req/s" << setw(10) << "p50 ms" << setw(10)
+         << "p99 ms" << setw(8) << "busy" << setw(8) << "errors" << endl;
+    printResult(options["target"], result);
+    cout << endl;
+    return 0;
+}
+
+int runDemo(map<string, string>& options) {
+    int connections = options["connections"].empty() ? 16 : atoi(options["connections"].c_str());
+    double seconds = options["seconds"].empty() ? 3.0 : atof(options["seconds"].c_str());
+    bool reconnect = options["reconnect"] == "1";
+    Logger::instance().setConsoleEcho(false);
+
+    // The default simulation's servers: power basePower + i * powerStep, queue baseQueueSize + i * queueSizeStep
+    vector<unique_ptr<BackendServer>> servers;
+    vector<BackendEndpoint> backends;
+    for (int i = 0; i < 3; ++i) {
+        BackendParameters parameters;
+        parameters.processingPower = 15.0 + i * 5.0;
+        parameters.queueSize = 10 + i * 5;
+        servers.push_back(make_unique<BackendServer>(parameters));
+        if (!servers.back()->start(0)) {
+            cerr << "Cannot start backend " << i + 1 << endl;
+            return 1;
+        }
+        BackendEndpoint backend;
+        backend.port = servers.back()->getPort();
+        backend.weight = parameters.processingPower;
+        backend.capacity = parameters.queueSize + parameters.cores;
+        backends.push_back(backend);
+    }
+
+    cout << connections << " closed-loop connections for " << seconds << " s per policy"
+         << (reconnect ? ", one connection per request" : "") << endl;
+    cout << left << setw(20) << "policy" << right << setw(10) << "req/s" << setw(10) << "p50 ms" << setw(10)
+         << "p99 ms" << setw(8) << "busy" << setw(8) << "errors" << "  responses per backend" << endl;
+    for (const auto& policy : Policies) {
+        TcpProxy proxy(backends, policy.second, 1, "proxy_log.txt");
+        if (!proxy.start(0, atoi(options["workers"].c_str()), "127.0.0.1")) {
+            cerr << "Cannot start the proxy: " << proxy.getError() << endl;
+            return 1;
+        }
+        LoadResult result = LoadGenerator("127.0.0.1", proxy.getPort()).run(connections, seconds, reconnect);
+        printResult(policy.first, result);
+        cout << " ";
+        for (size_t i = 0; i < backends.size(); ++i) cout << " " << proxy.getBackendStats(i).responses;
+        cout << endl;
+    }
+    return 0;
+}
+
+int main(int argc, char const *argv[]) {
+    string mode = argc > 1 ? argv[1] : "";
+    map<string, string> options;
+    for (int i = 2; i < argc; ++i) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (equals == string::npos) {
+            cerr << "Expected name=value, got: " << argument << endl;
+            return 1;
+        }
+        options[argument.substr(0, equals)] = argument.substr(equals + 1);
+    }
+    if (mode == "serve") return runServe(options);
+    if (mode == "backend") return runBackend(options);
+    if (mode == "loadgen") return runLoadgen(options);
+    if (mode == "demo") return runDemo(options);
+    cerr << "Usage: proxy serve|backend|loadgen|demo [name=value ...]" << endl;
+    return 1;
+}
+
+#else
+
+int main() {
+    cerr << "The TCP proxy needs Linux (epoll and splice)" << endl;
+    return 1;
+}
+
+#endif
@@ -0,0 +1,180 @@
+// Run a grid of independent simulations on all cores and collect one results table.
+//
+//   g++ -std=c++17 -O2 -pthread sweep.cpp -o sweep
+//   ./sweep [config=base.ini] numberOfServers=2,3,4 interArrivalTime=1:3:0.5 routingPolicy=RoundRobin,JoinShortestQueue
+//           [jobs=N] [out=sweep] [logs=1]
+//
+// Every other argument is a config key (see ConfigFile.h) with a comma-separated list of values or,
+// for numbers, a from:to:step range; the grid is every combination, the last parameter varying fastest.
+// A key with a single value sets it for every run, over the base config.
+// Each run writes its files to <out>/run_NNNN and one row to <out>/sweep_results.csv.
+// Runs use virtual time and no binary trace unless the config or grid sets virtualTime or binaryTrace;
+// server logs keep only warnings unless logs=1.
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include "ConfigFile.h"
+
+using namespace std;
+
+struct SweepParameter {
+    string name;
+    vector<string> values;
+};
+
+// "1,2,4", "RoundRobin,JoinShortestQueue" or "1:3:0.5" (inclusive)
+bool parseValues(const string& text, vector<string>& values) {
+    size_t colon = text.find(':');
+    if (colon != string::npos && text.find(':', colon + 1) != string::npos) {
+        size_t second = text.find(':', colon + 1);
+        try {
+            double from = stod(text.substr(0, colon));
+            double to = stod(text.substr(colon + 1, second - colon - 1));
+            double step = stod(text.substr(second + 1));
+            if (step <= 0.0 || to < from) return false;
+            int count = static_cast<int>((to - from) / step + 1e-9) + 1;
+            for (int i = 0; i < count; ++i) {
+                ostringstream value;
+                value << from + i * step;
+                values.push_back(value.str());
+            }
+            return true;
+        } catch (const exception&) {
+            return false;
+        }
+    }
+    stringstream list(text);
+    string item;
+    while (getline(list, item, ',')) values.push_back(item);
+    return !values.empty();
+}
+
+string runName(size_t run) {
+    char name[32];
+    snprintf(name, sizeof(name), "run_%04zu", run + 1);
+    return name;
+}
+
+int main(int argc, char const *argv[]) {
+    vector<SweepParameter> grid;
+    SimulationConfig base;
+    base.binaryTrace = false;
+    ConfigLoader loader(base);
+    size_t jobs = max(1u, thread::hardware_concurrency());
+    string outputDir = "sweep";
+    bool keepLogs = false;
+
+    for (int i = 1; i < argc; ++i) {
+        string argument = argv[i];
+        size_t equals = argument.find('=');
+        if (equals == string::npos) {
+            cerr << "Expected name=values, got: " << argument << endl;
+            return 1;
+        }
+        string name = argument.substr(0, equals);
+        string value = argument.substr(equals + 1);
+        if (name == "jobs") {
+            jobs = max(1, atoi(value.c_str()));
+        } else if (name == "out") {
+            outputDir = value;
+        } else if (name == "logs") {
+            keepLogs = value != "0";
+        } else if (name == "config") {
+            loader.loadFile(value);
+        } else if (name == "diurnalProfile") {
+            grid.push_back(SweepParameter{name, {value}});  // Its value is itself a comma-separated list
+        } else {
+            SweepParameter parameter{name, {}};
+            if (!parseValues(value, parameter.values)) {
+                cerr << "Bad values for " << name << ": " << value << endl;
+                return 1;
+            }
+            grid.push_back(parameter);
+        }
+    }
+    if (!loader.ok()) {
+        for (const string& error : loader.getErrors()) {
+            cerr << "Config error: " << error << endl;
+        }
+        return 1;
+    }
+
+    size_t runs = 1;
+    for (const auto& parameter : grid) runs *= parameter.values.size();
+
+    // Run i takes value (i / stride) % size of each parameter, so the last one varies fastest
+    vector<SimulationConfig> configs(runs, base);
+    for (size_t run = 0; run < runs; ++run) {
+        SimulationConfig& config = configs[run];
+        ConfigLoader check(config);
+        size_t stride = runs;
+        for (const auto& parameter : grid) {
+            stride /= parameter.values.size();
+            check.applyOverride(parameter.name + "=" + parameter.values[(run / stride) % parameter.values.size()]);
+        }
+        config.outputDir = outputDir + "/" + runName(run);
+        check.validate();
+        if (!check.ok()) {
+            cerr << runName(run) << ": " << check.getErrors().front() << endl;
+            return 1;
+        }
+    }
+
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(keepLogs ? LogLevel::Info : LogLevel::Warning);
+
+    vector<SimulationResult> results(runs);
+    vector<double> wallSeconds(runs, 0.0);
+    atomic<size_t> finished{0};
+    mutex progressMutex;
+    auto sweepStart = chrono::steady_clock::now();
+    cout << "Running " << runs << " simulations on " << min(jobs, runs) << " threads" << endl;
+
+    parallelFor(runs, jobs, [&](size_t run) {
+        auto start = chrono::steady_clock::now();
+        results[run] = runSimulation(configs[run]);
+        wallSeconds[run] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        size_t done = ++finished;
+        if (done % 100 == 0 || done == runs) {
+            lock_guard<mutex> lock(progressMutex);
+            cout << done << "/" << runs << " runs done" << endl;
+        }
+    });
+
+    string tablePath = outputDir + "/sweep_results.csv";
+    ofstream table(tablePath);
+    if (!table.is_open()) {
+        cerr << "Failed to open " << tablePath << endl;
+        return 1;
+    }
+    table << "run";
+    for (const auto& parameter : grid) table << "," << parameter.name;
+    table << ",completed,throughput,utilization,average_queue_length,wait_mean,delay_mean"
+          << ",delay_p50,delay_p99,delay_p99.9,server_rejections,shed,drop_rate,wall_seconds\n";
+    for (size_t run = 0; run < runs; ++run) {
+        const ServerKpi& all = results[run].kpis.global;
+        const AdmissionStats& admission = results[run].admission;
+        table << runName(run);
+        size_t stride = runs;
+        for (const auto& parameter : grid) {
+            stride /= parameter.values.size();
+            const string& value = parameter.values[(run / stride) % parameter.values.size()];
+            table << "," << (value.find(',') == string::npos ? value : "\"" + value + "\"");
+        }
+        table << "," << all.completed << "," << all.throughput << "," << all.utilization
+              << "," << all.averageQueueLength << "," << all.waitTime.mean << "," << all.delay.mean
+              << "," << all.delayHistogram.percentile(50) << "," << all.delayHistogram.percentile(99)
+              << "," << all.delayHistogram.percentile(99.9) << "," << all.rejected
+              << "," << admission.shed() << "," << admission.dropRate() << "," << wallSeconds[run] << "\n";
+    }
+
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - sweepStart).count();
+    cout << "Finished " << runs << " runs in " << elapsed << " s, results in " << tablePath << endl;
+    return 0;
+}
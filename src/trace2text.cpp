@@ -0,0 +1,160 @@
+// Convert a binary simulation trace back into the human-readable logs.
+//
+//   g++ -std=c++17 -O2 trace2text.cpp -o trace2text
+//   ./trace2text simulation_trace.bin            // every line to stdout, in trace order
+//   ./trace2text simulation_trace.bin outputDir  // task_log.txt, load_balancer_log.txt, serverN_log.txt
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include "TraceFormat.h"
+
+using namespace std;
+
+class TextOutput {
+public:
+    explicit TextOutput(string directory) : outputDir(std::move(directory)) {}
+
+    ~TextOutput() {
+        for (auto& [name, file] : files) {
+            fclose(file);
+        }
+    }
+
+    bool write(const string& name, const char* line) {
+        FILE* file = stdout;
+        if (!outputDir.empty()) {
+            auto it = files.find(name);
+            if (it == files.end()) {
+                FILE* opened = fopen((outputDir + "/" + name).c_str(), "w");
+                if (!opened) {
+                    cerr << "Failed to open " << outputDir << "/" << name << endl;
+                    return false;
+                }
+                it = files.emplace(name, opened).first;
+            }
+            file = it->second;
+        }
+        fputs(line, file);
+        fputc('\n', file);
+        return true;
+    }
+
+private:
+    string outputDir;
+    map<string, FILE*> files;
+};
+
+int main(int argc, char const *argv[]) {
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " <trace file> [output directory]" << endl;
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.open(argv[1])) {
+        cerr << "Not a version " << TraceVersion << " trace file: " << argv[1] << endl;
+        return 1;
+    }
+    TextOutput output(argc > 2 ? argv[2] : "");
+
+    // Server ID -> task ID -> time it joined that server's queue, to rebuild waiting times (a hedged copy keeps
+    // its task's ID, so one ID can join two servers)
+    vector<vector<double>> arrivalTimes;
+    vector<TraceRecord> records;
+    char line[512];
+    while (reader.read(records) > 0) {
+        for (const TraceRecord& r : records) {
+            string serverLog = "server" + to_string(r.serverId) + "_log.txt";
+            switch (r.type) {
+                case TraceEventType::TaskGenerated:
+                    snprintf(line, sizeof(line), "[Time: %.2f] Task ID: %u, Service Time: %.2f seconds",
+                             r.simTime, r.taskId, r.serviceTime);
+                    output.write("task_log.txt", line);
+                    break;
+                case TraceEventType::TaskAssigned:
+                    snprintf(line, sizeof(line), "Task ID: %u, Assigned to Server: %u, Server Current Utilization: %g",
+                             r.taskId, r.serverId, r.utilization);
+                    output.write("load_balancer_log.txt", line);
+                    break;
+                case TraceEventType::TaskAdded: {
+                    if (r.serverId >= arrivalTimes.size()) arrivalTimes.resize(r.serverId + 1);
+                    vector<double>& serverArrivals = arrivalTimes[r.serverId];
+                    if (r.taskId >= serverArrivals.size()) serverArrivals.resize(r.taskId + 1, 0.0);
+                    serverArrivals[r.taskId] = r.simTime;
+                    snprintf(line, sizeof(line), "Server %u added task %u with service time: %f at time: %f secs.",
+                             r.serverId, r.taskId, r.serviceTime, r.simTime);
+                    output.write(serverLog, line);
+                    snprintf(line, sizeof(line), "Server %u current task queue size: %u", r.serverId, r.queueLength);
+                    output.write(serverLog, line);
+                    break;
+                }
+                case TraceEventType::TaskRejected:
+                    snprintf(line, sizeof(line), "Server %u queue full, rejected task %u at time: %f secs.",
+                             r.serverId, r.taskId, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::ServiceStart: {
+                    double arrival = r.simTime;
+                    if (r.serverId < arrivalTimes.size() && r.taskId < arrivalTimes[r.serverId].size()) {
+                        arrival = arrivalTimes[r.serverId][r.taskId];
+                    }
+                    snprintf(line, sizeof(line), "Server %u current task queue size: %u", r.serverId, r.queueLength);
+                    output.write(serverLog, line);
+                    snprintf(line, sizeof(line),
+                             "Server %u is processing task %u with service time: %f seconds, waited: %f seconds at time: %f secs.",
+                             r.serverId, r.taskId, r.serviceTime, r.simTime - arrival, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                }
+                case TraceEventType::TaskFinished:
+                    snprintf(line, sizeof(line), "Task ID: %u Task Finished Time: %f secs.", r.taskId, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::UtilizationUpdate:
+                    snprintf(line, sizeof(line), "Server %u utilization updated: %f%%.", r.serverId, r.utilization * 100.0);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::AverageWaitingTime:
+                    snprintf(line, sizeof(line), "Server %u Average Waiting Time: %f seconds.", r.serverId, r.serviceTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::AverageQueueLength:
+                    snprintf(line, sizeof(line), "Server %u Average Queue Length: %u tasks.", r.serverId, r.queueLength);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::TaskShed:
+                    snprintf(line, sizeof(line), "Task ID: %u, Shed at time: %f secs.", r.taskId, r.simTime);
+                    output.write("load_balancer_log.txt", line);
+                    break;
+                case TraceEventType::TaskCancelled:
+                    snprintf(line, sizeof(line), "Server %u cancelled queued task %u at time: %f secs.",
+                             r.serverId, r.taskId, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::TaskPreempted:
+                    snprintf(line, sizeof(line), "Server %u preempted task %u after %f seconds of service at time: %f secs.",
+                             r.serverId, r.taskId, r.serviceTime, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::TaskSuspended:
+                    snprintf(line, sizeof(line), "Server %u suspended task %u with %f seconds of work left at time: %f secs.",
+                             r.serverId, r.taskId, r.serviceTime, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                case TraceEventType::ServiceResume:
+                    snprintf(line, sizeof(line), "Server %u current task queue size: %u", r.serverId, r.queueLength);
+                    output.write(serverLog, line);
+                    snprintf(line, sizeof(line), "Server %u resumed task %u with %f seconds of work left at time: %f secs.",
+                             r.serverId, r.taskId, r.serviceTime, r.simTime);
+                    output.write(serverLog, line);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    return 0;
+}
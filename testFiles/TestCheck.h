@@ -0,0 +1,44 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <type_traits>
+
+// PASS/FAIL checks shared by the test programs in testFiles. Every check prints one line; finishChecks()
+// prints the verdict and returns main's exit code.
+//   check("completed", server.completed, 2);                  // Integers: exact
+//   check("wait mean", server.waitTime.mean, 1.0);             // Doubles: within 1e-9 of expected
+//   check("poisson rate", rate, 0.5, 0.01);                    // Doubles: within 1% of expected
+
+inline int checkFailures = 0;
+
+inline void reportCheck(const std::string& name, bool ok) {
+    if (!ok) ++checkFailures;
+    std::cout << (ok ? "PASS " : "FAIL ") << name << ": ";
+}
+
+// Counts, IDs, sizes and conditions (pass `cond, 1`)
+template <typename Actual, typename Expected,
+          std::enable_if_t<std::is_integral_v<Actual> && std::is_integral_v<Expected>, int> = 0>
+void check(const std::string& name, Actual actual, Expected expected) {
+    long long got = static_cast<long long>(actual), want = static_cast<long long>(expected);
+    reportCheck(name, got == want);
+    std::cout << got << " (expected " << want << ")" << std::endl;
+}
+
+// Relative tolerance: |actual - expected| <= tolerance * |expected| (so an expected 0 must be exact)
+inline void check(const std::string& name, double actual, double expected, double tolerance = 1e-9) {
+    reportCheck(name, std::fabs(actual - expected) <= tolerance * std::fabs(expected));
+    std::cout << actual << " (expected " << expected;
+    if (tolerance >= 1e-6) std::cout << " within " << tolerance * 100 << "%";
+    std::cout << ")" << std::endl;
+}
+
+inline int finishChecks() {
+    std::cout << (checkFailures == 0 ? "All checks passed" : "Some checks failed") << std::endl;
+    return checkFailures == 0 ? 0 : 1;
+}
+
+#endif // TEST_CHECK_H
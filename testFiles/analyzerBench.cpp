@@ -0,0 +1,120 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <map>
+#include "Analyzer.h"
+
+// Generates task/server logs with about `lines` lines in total (default 10M),
+// then times the previous getline + stringstream + map analyzer against analyzer().
+//   ./analyzerBench [lines]
+
+void legacyAnalyzer(vector<string> serverLogFiles, string taskGeneratorLogFile) {
+    int serverId = 0;
+    map<int, double> taskGenTimes;
+    ifstream generatorLog(taskGeneratorLogFile);
+    string line;
+    while (getline(generatorLog, line)) {
+        if (line.find("Task ID:") != string::npos && line.find("Time:") != string::npos) {
+            int taskId;
+            double genTime;
+            size_t timePos = line.find("Time: ");
+            size_t idPos = line.find("Task ID: ");
+            if (timePos != string::npos) {
+                stringstream ss(line.substr(timePos + 6));
+                ss >> genTime;
+            }
+            if (idPos != string::npos) {
+                stringstream ss(line.substr(idPos + 8));
+                ss >> taskId;
+            }
+            taskGenTimes[taskId] = genTime;
+        }
+    }
+    for (const auto& file : serverLogFiles) {
+        ifstream serverLogFile(file);
+        double totalDelay = 0.0;
+        int taskCount = 0;
+        double avgWaiting = 0.0;
+        int avgQueueLength = 0;
+        while (getline(serverLogFile, line)) {
+            if (line.find("Average Waiting Time") != string::npos) {
+                avgWaiting = extractValue(line, "Average Waiting Time:");
+            }
+            if (line.find("Average Queue Length") != string::npos) {
+                avgQueueLength = static_cast<int>(extractValue(line, "Average Queue Length:"));
+            }
+            if (line.find("Task ID:") != string::npos && line.find("Task Finished Time") != string::npos) {
+                int taskId;
+                double finishTime;
+                size_t timePos = line.find("Time: ");
+                size_t idPos = line.find("Task ID: ");
+                if (timePos != string::npos) {
+                    stringstream ss(line.substr(timePos + 6));
+                    ss >> finishTime;
+                }
+                if (idPos != string::npos) {
+                    stringstream ss(line.substr(idPos + 8));
+                    ss >> taskId;
+                }
+                if (taskGenTimes.find(taskId) != taskGenTimes.end()) {
+                    totalDelay += (finishTime - taskGenTimes[taskId]);
+                    taskCount++;
+                }
+            }
+        }
+        double avgDelay = (taskCount > 0) ? (totalDelay / taskCount) : 0.0;
+        saveResults(serverId, avgDelay, avgWaiting, avgQueueLength);
+        serverId++;
+    }
+}
+
+int main(int argc, char const *argv[]) {
+    long long lines = argc > 1 ? atoll(argv[1]) : 10000000;
+    const int servers = 3;
+    const long long tasks = lines / 6;  // 1 generator line + 5 server lines per task
+
+    mt19937 rng(7);
+    exponential_distribution<double> service(1.0 / 40.0);
+    FILE* taskLog = fopen("bench_task_log.txt", "w");
+    vector<FILE*> serverLogs;
+    vector<string> serverFiles;
+    for (int s = 1; s <= servers; ++s) {
+        serverFiles.push_back("bench_server" + to_string(s) + "_log.txt");
+        serverLogs.push_back(fopen(serverFiles.back().c_str(), "w"));
+    }
+    for (long long id = 1; id <= tasks; ++id) {
+        double now = id * 0.3;
+        double serviceTime = service(rng);
+        FILE* log = serverLogs[id % servers];
+        int server = static_cast<int>(id % servers) + 1;
+        fprintf(taskLog, "[Time: %.2f] Task ID: %lld, Service Time: %.2f seconds\n", now, id, serviceTime);
+        fprintf(log, "Server %d added task %lld with service time: %f at time: %f secs.\n", server, id, serviceTime, now);
+        fprintf(log, "Server %d current task queue size: 1\n", server);
+        fprintf(log, "Server %d is processing task %lld with service time: %f seconds, waited: 0.000000 seconds at time: %f secs.\n",
+                server, id, serviceTime, now);
+        fprintf(log, "Task ID: %lld Task Finished Time: %f secs.\n", id, now + serviceTime / 20.0);
+        fprintf(log, "Server %d utilization updated: 5.000000%%.\n", server);
+    }
+    for (int s = 0; s < servers; ++s) {
+        fprintf(serverLogs[s], "Server %d Average Waiting Time: 0.000000 seconds.\n", s + 1);
+        fprintf(serverLogs[s], "Server %d Average Queue Length: 0 tasks.\n", s + 1);
+        fclose(serverLogs[s]);
+    }
+    fclose(taskLog);
+
+    auto start = chrono::steady_clock::now();
+    legacyAnalyzer(serverFiles, "bench_task_log.txt");
+    chrono::duration<double> legacy = chrono::steady_clock::now() - start;
+
+    start = chrono::steady_clock::now();
+    analyzer(serverFiles, "bench_task_log.txt");
+    chrono::duration<double> fast = chrono::steady_clock::now() - start;
+
+    cout << "Lines: " << tasks * 6 << ", Legacy analyzer: " << legacy.count()
+         << " s, mmap + parallel analyzer: " << fast.count() << " s (" << legacy.count() / fast.count() << "x)" << endl;
+
+    remove("bench_task_log.txt");
+    for (const auto& file : serverFiles) remove(file.c_str());
+    return 0;
+}
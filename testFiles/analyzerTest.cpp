@@ -1,8 +1,69 @@
 #include"Analyzer.h"
+#include "TestCheck.h"
 
-int main(int argc, char const *argv[])
+// A hedged task runs on both servers: the copy on server 2 starts later and is preempted when server 1
+// finishes it. Each server's service time must come from its own start line. On server 3 a task is
+// suspended by a shorter one (ShortestRemainingTime) and resumed; its time out of service is not service.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/analyzerTest.cpp -o analyzerTest
+
+void writeFile(const string& path, const string& text) {
+    ofstream file(path);
+    file << text;
+}
+
+// `field` (such as "Service p50:") of every "Server ID" line in the results file
+vector<double> serverResults(const string& resultsPath, const string& field) {
+    vector<double> values;
+    ifstream results(resultsPath);
+    string line;
+    while (getline(results, line)) {
+        if (line.rfind("Server ID:", 0) == 0) values.push_back(extractValue(line, field));
+    }
+    return values;
+}
+
+int main()
 {
-    vector<string> files = {"server1 log.txt"};
-    analyzer(files, "taskGen log.txt");
-    return 0;
-}
\ No newline at end of file
+    writeFile("analyzer_test_task_log.txt",
+              "[Time: 0.00] Task ID: 1, Service Time: 10.00 seconds\n"
+              "[Time: 1.00] Task ID: 2, Service Time: 3.00 seconds\n"
+              "[Time: 0.00] Task ID: 3, Service Time: 10.00 seconds\n"
+              "[Time: 2.00] Task ID: 4, Service Time: 1.00 seconds\n");
+    writeFile("analyzer_test_server1_log.txt",
+              "Server 1 added task 1 with service time: 10 at time: 0 secs.\n"
+              "Server 1 is processing task 1 with service time: 10 seconds, waited: 0 seconds at time: 0 secs.\n"
+              "Task ID: 1 Task Finished Time: 10 secs.\n");
+    writeFile("analyzer_test_server2_log.txt",
+              "Server 2 added task 2 with service time: 3 at time: 1 secs.\n"
+              "Server 2 is processing task 2 with service time: 3 seconds, waited: 0 seconds at time: 1 secs.\n"
+              "Server 2 added task 1 with service time: 10 at time: 2 secs.\n"
+              "Task ID: 2 Task Finished Time: 4 secs.\n"
+              "Server 2 is processing task 1 with service time: 10 seconds, waited: 2 seconds at time: 4 secs.\n"
+              "Server 2 preempted task 1 after 6 seconds of service at time: 10 secs.\n");
+    writeFile("analyzer_test_server3_log.txt",
+              "Server 3 added task 3 with service time: 10 at time: 0 secs.\n"
+              "Server 3 is processing task 3 with service time: 10 seconds, waited: 0 seconds at time: 0 secs.\n"
+              "Server 3 added task 4 with service time: 1 at time: 2 secs.\n"
+              "Server 3 suspended task 3 with 8 seconds of work left at time: 2 secs.\n"
+              "Server 3 is processing task 4 with service time: 1 seconds, waited: 0 seconds at time: 2 secs.\n"
+              "Task ID: 4 Task Finished Time: 3 secs.\n"
+              "Server 3 resumed task 3 with 8 seconds of work left at time: 3 secs.\n"
+              "Task ID: 3 Task Finished Time: 11 secs.\n");
+    remove("analyzer_test_results.txt");
+    analyzer({"analyzer_test_server1_log.txt", "analyzer_test_server2_log.txt", "analyzer_test_server3_log.txt"},
+             "analyzer_test_task_log.txt", "analyzer_test_results.txt");
+
+    vector<double> medians = serverResults("analyzer_test_results.txt", "Service p50:");
+    vector<double> longest = serverResults("analyzer_test_results.txt", "Service p99:");
+    check("a line per server", medians.size(), 3);
+    if (medians.size() == 3) {
+        check("hedged task: service from server 1's own start", medians[0], 10.0, 0.01);
+        check("server 2: service of its own task", medians[1], 3.0, 0.01);
+        check("suspended task: service without the suspension", longest[2], 10.0, 0.01);
+    }
+    for (const char* file : {"analyzer_test_task_log.txt", "analyzer_test_server1_log.txt", "analyzer_test_server2_log.txt",
+                             "analyzer_test_server3_log.txt", "analyzer_test_results.txt"}) {
+        remove(file);
+    }
+    return finishChecks();
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include "LoadBalancer.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// One slow server with a 2-task queue receives a burst of 20 tasks. The load balancer must hold
+// what the server cannot take, shed the overflow per policy and drain the rest as the queue empties.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/backlogTest.cpp -o backlogTest
+
+AdmissionStats runBurst(size_t capacity, OverflowPolicy policy) {
+    Logger::instance().setConsoleEcho(false);
+    GlobalClock clock(1.0, ClockMode::Virtual);
+    LoadBalancer lb;
+    lb.setBacklog(capacity, policy);
+    lb.setClock(&clock);
+    auto server = make_shared<ServerQueue>(1, 1.0, 2, &clock, [&lb](pair<int, double> utilizationData) {
+        lb.trackUtil(utilizationData.first, utilizationData.second);
+    });
+    lb.setServers({server});
+
+    for (int i = 1; i <= 20; ++i) {
+        Task task = {i, 1.0, 0.0};
+        lb.sendTask(task);
+    }
+    clock.runUntil(1000.0);
+    server->stopProcessing();
+    return lb.getAdmissionStats();
+}
+
+// Round robin over server 1 (1-task queue, kept busy) and an idle server 2: once server 1 is full its
+// turns go to server 2, so nothing waits in the backlog and nothing is rejected
+AdmissionStats runFullTarget(size_t capacity, int& rejectedByServer) {
+    Logger::instance().setConsoleEcho(false);
+    GlobalClock clock(1.0, ClockMode::Virtual);
+    KpiEngine kpis(2);
+    LoadBalancer lb(RoutingPolicyType::RoundRobin);
+    lb.setBacklog(capacity, OverflowPolicy::RejectNew);
+    lb.setClock(&clock);
+    vector<shared_ptr<ServerQueue>> servers;
+    for (int id = 1; id <= 2; ++id) {
+        servers.push_back(make_shared<ServerQueue>(id, 1.0, id == 1 ? 1 : 20, &clock, [&lb](pair<int, double> utilizationData) {
+            lb.trackUtil(utilizationData.first, utilizationData.second);
+        }));
+        servers.back()->setKpiEngine(&kpis);
+    }
+    lb.setServers(servers);
+
+    for (int i = 1; i <= 8; ++i) {
+        Task task = {i, 2.0, 0.0};
+        lb.sendTask(task);
+    }
+    clock.runUntil(1000.0);
+    for (const auto& server : servers) server->stopProcessing();
+    rejectedByServer = static_cast<int>(kpis.snapshot(clock.getCurrentTime()).global.rejected);
+    return lb.getAdmissionStats();
+}
+
+int main() {
+    AdmissionStats reject = runBurst(5, OverflowPolicy::RejectNew);
+    check("reject: received", reject.received, 20);
+    check("reject: nothing left", reject.backlog, 0);
+    check("reject: backlog drained", reject.dispatched, 7);  // 2 fill the server queue, 5 wait in the backlog
+    check("reject: dispatched + shed", reject.dispatched + reject.shed(), 20);
+    check("reject: backlog bounded", reject.maxBacklog <= 5, 1);
+    check("reject: only rejections", reject.rejected, reject.shed());
+
+    AdmissionStats drop = runBurst(5, OverflowPolicy::DropOldest);
+    check("drop: dispatched + shed", drop.dispatched + drop.shed(), 20);
+    check("drop: only head drops", drop.dropped, drop.shed());
+    check("drop: same loss as reject", drop.shed(), reject.shed());
+
+    AdmissionStats none = runBurst(0, OverflowPolicy::RejectNew);
+    check("no backlog: nothing deferred", none.deferred, 0);
+    check("no backlog: dispatched + rejected", none.dispatched + none.rejected, 20);
+
+    int rejectedByServer = 0;
+    AdmissionStats full = runFullTarget(0, rejectedByServer);
+    check("full target, no backlog: all dispatched", full.dispatched, 8);
+    check("full target, no backlog: none rejected", full.rejected, 0);
+    check("full target, no backlog: none refused by a server", rejectedByServer, 0);
+    full = runFullTarget(5, rejectedByServer);
+    check("full target: all dispatched", full.dispatched, 8);
+    check("full target: nothing deferred", full.deferred, 0);
+    check("full target: none refused by a server", rejectedByServer, 0);
+
+    return finishChecks();
+}
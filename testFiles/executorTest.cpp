@@ -0,0 +1,107 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include "SERVERQUEUE.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Runs jobs on the Executor, then the same real-time servers with a thread per core and on a shared
+// executor, then a farm of many servers on the executor, reporting threads and memory per server.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/executorTest.cpp -o executorTest
+//   ./executorTest [servers]
+
+// Field of /proc/self/status, in its own unit (kB for sizes)
+long procStatus(const string& field) {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, field.size() + 1, field + ":") == 0) return atol(line.c_str() + field.size() + 1);
+    }
+    return 0;
+}
+
+// Every server gets `tasks` tasks of 1 simulated second at once; returns the completed count
+int runFarm(int serverCount, int cores, int tasks, Executor* executor, long& threads, long& residentKb) {
+    GlobalClock clock(1000.0, ClockMode::RealTime, chrono::milliseconds(1));  // 1 ms real = 1 simulated second
+    long residentBefore = procStatus("VmRSS");
+    vector<shared_ptr<ServerQueue>> servers;
+    for (int i = 0; i < serverCount; ++i) {
+        servers.push_back(make_shared<ServerQueue>(i + 1, 10.0, tasks, &clock, nullptr, cores, "-", executor));
+    }
+    threads = procStatus("Threads");
+    residentKb = procStatus("VmRSS") - residentBefore;
+    for (auto& server : servers) {
+        for (int task = 0; task < tasks; ++task) server->addTask(task, 10.0);
+    }
+    // Each core serves tasks / cores tasks back to back; give up after a minute
+    int completed = 0;
+    for (int wait = 0; wait < 6000 && completed < serverCount * tasks; ++wait) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+        completed = 0;
+        for (auto& server : servers) completed += server->getCompletedTasks();
+    }
+    for (auto& server : servers) server->stopProcessing();
+    for (auto& server : servers) server.reset();
+    return completed;
+}
+
+int main(int argc, char const *argv[]) {
+    int farmSize = argc > 1 ? atoi(argv[1]) : 100000;
+    Logger::instance().setConsoleEcho(false);
+
+    // Jobs posted from outside and from jobs: every one runs exactly once
+    {
+        atomic<long long> sum{0};
+        {
+            Executor executor(4);
+            vector<thread> posters;
+            for (int p = 0; p < 4; ++p) {
+                posters.emplace_back([&executor, &sum]() {
+                    for (int i = 0; i < 25000; ++i) {
+                        executor.post([&executor, &sum]() {
+                            ++sum;
+                            executor.post([&sum]() { ++sum; });  // Stays on this worker unless stolen
+                        });
+                    }
+                });
+            }
+            for (auto& poster : posters) poster.join();
+            for (int i = 0; i < 2000 && executor.getExecutedJobs() < 200000; ++i) {
+                this_thread::sleep_for(chrono::milliseconds(5));
+            }
+            cout << "Executor: " << executor.getExecutedJobs() << " jobs, " << executor.getStolenJobs() << " stolen" << endl;
+            check("executor: every job ran", executor.getExecutedJobs(), 200000);
+        }
+        check("executor: every job ran once", sum.load(), 200000);
+    }
+
+    // The same servers with a thread per core and on a shared executor
+    long threads, residentKb;
+    int dedicated = runFarm(20, 2, 8, nullptr, threads, residentKb);
+    check("thread per core: every task served", dedicated, 160);
+    long dedicatedThreads = threads;
+    {
+        Executor executor(2);
+        int shared = runFarm(20, 2, 8, &executor, threads, residentKb);
+        check("executor: every task served", shared, 160);
+        cout << "20 servers x 2 cores: " << dedicatedThreads << " threads with a thread per core, " << threads
+             << " on the executor" << endl;
+        check("executor: no thread per server", threads < dedicatedThreads - 30, 1);
+    }
+
+    // A large farm: no threads per server, a few hundred bytes each
+    {
+        Executor executor(0);
+        auto start = chrono::steady_clock::now();
+        int served = runFarm(farmSize, 1, 2, &executor, threads, residentKb);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << farmSize << " servers on " << executor.getThreadCount() << " executor threads: " << threads
+             << " threads in the process, " << residentKb * 1024 / max(1, farmSize) << " bytes resident per server, "
+             << served << " tasks served in " << seconds << " s (" << executor.getStolenJobs() << " steps stolen)" << endl;
+        check("farm: every task served", served, 2LL * farmSize);
+        check("farm: threads independent of servers", threads < 64, 1);
+    }
+
+    return finishChecks();
+}
@@ -0,0 +1,128 @@
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include "Simulation.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Checks cancelling queued and in-service tasks on a ServerQueue, then prints what hedging costs in extra
+// busy time against what it saves in tail delay, for exponential and Pareto service at a low and a high load.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/hedgingTest.cpp -o hedgingTest
+//   ./hedgingTest [hours]
+
+int main(int argc, char const *argv[]) {
+    double hours = argc > 1 ? atof(argv[1]) : 6.0;
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+
+    // One core at power 1, queue of 4, tasks of 10 seconds
+    {
+        GlobalClock clock(1.0, ClockMode::Virtual);
+        KpiEngine kpis(1);
+        vector<int> finished;
+        ServerQueue server(1, 1.0, 4, &clock, nullptr, 1, "-");
+        server.setKpiEngine(&kpis);
+        check("cancellation: enabled in virtual time", server.enableCancellation(), 1);
+        server.setCompletionCallback([&finished](int, int taskId) { finished.push_back(taskId); });
+        for (int task = 1; task <= 4; ++task) server.addTask(task, 10.0);
+
+        clock.runUntil(1.0);
+        check("queued task removed", server.cancelTask(3) == ServerQueue::CancelResult::Dequeued, 1);
+        check("queue length after removal", server.getQueueLength(), 2);
+        clock.runUntil(2.0);
+        check("task in service preempted", server.cancelTask(1) == ServerQueue::CancelResult::Preempted, 1);
+        check("unknown task not found", server.cancelTask(99) == ServerQueue::CancelResult::NotFound, 1);
+        clock.runUntil(30.0);
+        // Task 2 started when task 1 was preempted (2 to 12), task 4 followed (12 to 22)
+        check("finished tasks", finished == vector<int>({2, 4}), 1);
+        check("finished task not cancelled", server.cancelTask(2) == ServerQueue::CancelResult::NotFound, 1);
+        check("preempted service counts as busy", server.getCoreBusyTimes()[0], 22.0);
+
+        KpiSnapshot snapshot = kpis.snapshot(30.0);
+        check("KPI completed", snapshot.global.completed, 2);
+        check("KPI cancelled", snapshot.global.cancelled, 1);
+        check("KPI preempted", snapshot.global.preempted, 1);
+        // Waits: task 2 from 0 to 2, task 3 from 0 to 1 (cancelled), task 4 from 0 to 12
+        check("KPI queue length", fabs(snapshot.global.averageQueueLength - 15.0 / 30.0) < 1e-12, 1);
+        check("KPI busy cores", snapshot.global.averageBusyCores, 22.0 / 30.0);
+
+        // Cancelled tasks hold their ring slots until the queue is full, then make room
+        finished.clear();
+        for (int task = 10; task <= 13; ++task) server.addTask(task, 1.0);
+        server.cancelTask(11);
+        server.cancelTask(12);
+        check("room after cancelling", server.addTask(14, 1.0) && server.addTask(15, 1.0), 1);
+        check("full again", server.addTask(16, 1.0), 0);
+        clock.runUntil(60.0);
+        check("order kept", finished == vector<int>({10, 13, 14, 15}), 1);
+    }
+
+    // Extra busy time against tail delay: 10 servers, Poisson arrivals, round robin (which cannot see a long task
+    // holding up a queue, so hedging has something to fix)
+    const vector<pair<string, ServiceDistributionType>> services = {
+        {"Exponential", ServiceDistributionType::Exponential}, {"Pareto", ServiceDistributionType::Pareto}};
+    struct Variant {
+        string name;
+        HedgingPolicy policy;
+        double delay;
+    };
+    const vector<Variant> variants = {{"None", HedgingPolicy::None, 0.0},     {"Delayed 4 s", HedgingPolicy::Delayed, 4.0},
+                                      {"Delayed 8 s", HedgingPolicy::Delayed, 8.0}, {"Delayed 16 s", HedgingPolicy::Delayed, 16.0},
+                                      {"Immediate", HedgingPolicy::Immediate, 0.0}};
+    for (const auto& [serviceName, service] : services) {
+        for (double load : {0.3, 0.6}) {
+            cout << serviceName << " service (mean 4 s), " << load * 100 << "% load, " << hours << " hours" << endl;
+            cout << setw(14) << "hedging" << setw(10) << "p50" << setw(10) << "p99" << setw(10) << "p99.9"
+                 << setw(12) << "extra busy" << setw(10) << "copies" << setw(10) << "shed" << endl;
+            double baseBusy = 0.0, baseP99 = 0.0;
+            for (const Variant& variant : variants) {
+                SimulationConfig config;
+                config.seed = 5;
+                config.deterministic = true;
+                config.consoleEcho = false;
+                config.binaryTrace = false;
+                config.outputDir = "hedge_test/run";
+                config.numberOfServers = 10;
+                config.basePower = 10.0;
+                config.powerStep = 0.0;
+                config.baseQueueSize = 20;
+                config.queueSizeStep = 0;
+                config.arrivalProcess = ArrivalProcessType::Poisson;
+                config.serviceDistribution = service;
+                config.interArrivalTime = config.averageServiceTime / config.basePower / config.numberOfServers / load;
+                config.simulationDuration = hours * 3600;
+                config.routingPolicy = RoutingPolicyType::RoundRobin;
+                config.hedging = variant.policy;
+                config.hedgeDelay = variant.delay;
+                filesystem::remove_all(config.outputDir);
+                SimulationResult result = runSimulation(config);
+
+                const ServerKpi& all = result.kpis.global;
+                double busy = all.averageBusyCores;
+                double p99 = all.delayHistogram.percentile(99);
+                if (variant.policy == HedgingPolicy::None) {
+                    baseBusy = busy;
+                    baseP99 = p99;
+                }
+                cout << setw(14) << variant.name << fixed << setprecision(2) << setw(10) << all.delayHistogram.percentile(50)
+                     << setw(10) << p99 << setw(10) << all.delayHistogram.percentile(99.9) << setw(11)
+                     << (busy / baseBusy - 1.0) * 100 << "%" << setw(9)
+                     << 100.0 * result.hedging.hedged / max(1LL, result.admission.dispatched) << "%" << setw(9)
+                     << 100.0 * result.admission.dropRate() << "%" << defaultfloat << endl;
+
+                string label = serviceName + " " + to_string(static_cast<int>(load * 100)) + "% " + variant.name;
+                check(label + ": KPIs saw every cancellation", all.cancelled, result.hedging.cancelledQueued);
+                check(label + ": KPIs saw every preemption", all.preempted, result.hedging.preempted);
+                check(label + ": each copy finished, cancelled or still running",
+                      all.arrived - all.completed - all.cancelled - all.preempted <= 10 * 21, 1);
+                if (variant.policy == HedgingPolicy::Delayed && variant.delay == 8.0) {
+                    check(label + ": lower p99 delay", p99 < baseP99, 1);
+                }
+            }
+        }
+    }
+
+    filesystem::remove_all("hedge_test");
+    return finishChecks();
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include "KpiEngine.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Checks KpiEngine and LatencyHistogram against values computed by hand, then merges accumulators from several threads.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/kpiEngineTest.cpp -o kpiEngineTest
+
+int main() {
+    // Server 1: tasks arrive at 0, 1 and 2; each takes 2 seconds, served one after another
+    KpiEngine kpis(1);
+    kpis.taskArrived(1, 0.0);
+    kpis.serviceStarted(1, 0.0, 0.0);
+    kpis.taskArrived(1, 1.0);
+    kpis.taskArrived(1, 2.0);
+    kpis.serviceFinished(1, 0.0, 0.0, 2.0);
+    kpis.serviceStarted(1, 1.0, 2.0);
+    kpis.serviceFinished(1, 1.0, 2.0, 4.0);
+    kpis.serviceStarted(1, 2.0, 4.0);
+    kpis.taskRejected(1);
+
+    // At t = 5: waits 0, 1 and 2 seconds, so the queue-length area is 3; the server was busy throughout
+    KpiSnapshot snapshot = kpis.snapshot(5.0);
+    const ServerKpi& server = snapshot.servers.at(0);
+    check("completed", server.completed, 2);
+    check("rejected", server.rejected, 1);
+    check("wait mean", server.waitTime.mean, 1.0);
+    check("wait variance", server.waitTime.variance(), 1.0);
+    check("wait max", server.waitTime.max, 2.0);
+    check("delay mean", server.delay.mean, 2.5);
+    check("queue length", server.averageQueueLength, 3.0 / 5.0);
+    check("utilization", server.utilization, 1.0);
+    check("throughput", server.throughput, 2.0 / 5.0);
+    check("wait p50", server.waitHistogram.percentile(50), 1.0, 0.01);
+
+    // Histogram percentiles stay within 1% of the exact values: 1 ms .. 10 s in 1 ms steps
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 10000; ++i) {
+        histogram.record(i * 1e-3);
+    }
+    check("histogram p50", histogram.percentile(50), 5.0, 0.01);
+    check("histogram p99", histogram.percentile(99), 9.9, 0.01);
+    check("histogram p99.9", histogram.percentile(99.9), 9.99, 0.01);
+    LatencyHistogram doubled;
+    doubled.merge(histogram);
+    doubled.merge(histogram);
+    check("histogram merge", doubled.count(), 20000);
+    check("histogram merged p99", doubled.percentile(99), 9.9, 0.01);
+
+    // Arrivals, starts and finishes reported from different threads must still add up
+    const int threads = 4, tasks = 100000;
+    KpiEngine shared(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&shared, t]() {
+            for (int i = 0; i < tasks; ++i) {
+                double arrival = i;
+                shared.taskArrived(t + 1, arrival);
+                shared.serviceStarted(t + 1, arrival, arrival + 0.5);
+                shared.serviceFinished(t + 1, arrival, arrival + 0.5, arrival + 1.0);
+            }
+        });
+    }
+    for (int i = 0; i < 10; ++i) {
+        shared.snapshot(tasks);  // Concurrent snapshots must not disturb the writers
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    KpiSnapshot merged = shared.snapshot(tasks);
+    check("merged completed", merged.global.completed, threads * tasks);
+    check("merged wait mean", merged.global.waitTime.mean, 0.5);
+    check("merged queue length", merged.global.averageQueueLength, threads * 0.5);
+    check("merged utilization", merged.global.utilization, 0.5);
+    check("merged delay p50", merged.global.delayHistogram.percentile(50), 1.0, 0.01);
+
+    return finishChecks();
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <string>
+#include "Logger.h"
+
+using namespace std;
+
+// Several "servers" log task lines concurrently.
+// Old path: one global mutex, std::to_string concatenation, file write with std::endl.
+// New path: Logger with per-thread buffers and one batching writer (console echo off).
+int main() {
+    const int recordsPerThread = 200000;
+
+    for (int threads : {1, 4, 8}) {
+        mutex terminalMutex;
+        vector<ofstream> files(threads);
+        for (int t = 0; t < threads; ++t) {
+            files[t].open("bench_old_" + to_string(t) + ".txt", ios::out | ios::trunc);
+        }
+        auto start = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < recordsPerThread; ++i) {
+                    string message = "Server " + to_string(t) + " added task " + to_string(i) +
+                                     " with service time: " + to_string(i * 0.5) + " at time: " + to_string(i * 0.3) + " secs.";
+                    lock_guard<mutex> lock(terminalMutex);
+                    files[t] << message << endl;
+                }
+            });
+        }
+        for (auto& w : workers) w.join();
+        chrono::duration<double> oldElapsed = chrono::steady_clock::now() - start;
+
+        Logger& logger = Logger::instance();
+        logger.setConsoleEcho(false);
+        vector<int> sinks;
+        for (int t = 0; t < threads; ++t) {
+            remove(("bench_new_" + to_string(t) + ".txt").c_str());
+            sinks.push_back(logger.openSink("bench_new_" + to_string(t) + ".txt"));
+        }
+        vector<double> hotPathNanos(threads);
+        start = chrono::steady_clock::now();
+        workers.clear();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                auto hotStart = chrono::steady_clock::now();
+                for (int i = 0; i < recordsPerThread; ++i) {
+                    logger.log(sinks[t], LogLevel::Info, "Server {} added task {} with service time: {} at time: {} secs.",
+                               t, i, i * 0.5, i * 0.3);
+                }
+                hotPathNanos[t] = chrono::duration<double, nano>(chrono::steady_clock::now() - hotStart).count() / recordsPerThread;
+            });
+        }
+        for (auto& w : workers) w.join();
+        logger.flush();
+        chrono::duration<double> newElapsed = chrono::steady_clock::now() - start;
+        for (int t = 0; t < threads; ++t) {
+            logger.closeSink(sinks[t]);
+            files[t].close();
+            remove(("bench_old_" + to_string(t) + ".txt").c_str());
+            remove(("bench_new_" + to_string(t) + ".txt").c_str());
+        }
+
+        double hotPath = 0.0;
+        for (double nanos : hotPathNanos) hotPath += nanos / threads;
+        double total = static_cast<double>(threads) * recordsPerThread;
+        cout << "Threads: " << threads
+             << ", Mutex + endl: " << total / oldElapsed.count() << " records/s"
+             << ", Async logger: " << total / newElapsed.count() << " records/s"
+             << " (" << hotPath << " ns per record on the caller, including waits for a full buffer)" << endl;
+    }
+    // Caller cost alone: bursts that fit in the per-thread buffer, flushed between bursts
+    Logger& logger = Logger::instance();
+    int sink = logger.openSink("bench_burst.txt");
+    const int burst = 4000;
+    double burstNanos = 0.0;
+    for (int round = 0; round < 50; ++round) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < burst; ++i) {
+            logger.log(sink, LogLevel::Info, "Server {} added task {} with service time: {} at time: {} secs.",
+                       1, i, i * 0.5, i * 0.3);
+        }
+        burstNanos += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        logger.flush();
+    }
+    logger.closeSink(sink);
+    remove("bench_burst.txt");
+    cout << "Caller cost without back-pressure: " << burstNanos / (50.0 * burst) << " ns per record" << endl;
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include "Simulation.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Checks the Maglev table's balance and how few keys move when a server joins or leaves (against a full
+// rebuild), then key affinity through the load balancer, then prints what Maglev with and without bounded
+// loads does to the cache hit rate, load imbalance and tail delay under Zipf-distributed keys.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/maglevTest.cpp -o maglevTest
+//   ./maglevTest [hours]
+
+// Most and fewest slots held by one server, as a fraction of the fair share
+pair<double, double> spread(const MaglevTable& table) {
+    size_t most = 0, fewest = table.size();
+    for (int id : table.serverIds()) {
+        most = max(most, table.owned(id));
+        fewest = min(fewest, table.owned(id));
+    }
+    double share = static_cast<double>(table.size()) / table.serverCount();
+    return {most / share, fewest / share};
+}
+
+vector<int> lookups(const MaglevTable& table, int keys) {
+    vector<int> servers;
+    for (int key = 1; key <= keys; ++key) servers.push_back(table.lookup(MaglevTable::hash(key)));
+    return servers;
+}
+
+int main(int argc, char const *argv[]) {
+    double hours = argc > 1 ? atof(argv[1]) : 6.0;
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+    const int keys = 200000;
+
+    // The table on its own: 10 servers, then server 4 leaves, then server 11 joins
+    {
+        MaglevTable table;
+        table.build({1, 2, 3, 4, 5, 6, 7, 8, 9, 10});
+        check("table size is prime", table.size(), 65537);
+        size_t most = 0, fewest = table.size();
+        for (int id : table.serverIds()) {
+            most = max(most, table.owned(id));
+            fewest = min(fewest, table.owned(id));
+        }
+        check("full build: slot counts differ by at most one", most - fewest <= 1, 1);
+        vector<int> before = lookups(table, keys);
+
+        size_t freed = table.owned(4);
+        check("leave moves only the leaver's slots", table.remove(4), freed);
+        vector<int> afterLeave = lookups(table, keys);
+        int moved = 0, wrongly = 0;
+        for (int key = 0; key < keys; ++key) {
+            if (afterLeave[key] == before[key]) continue;
+            ++moved;
+            if (before[key] != 4) ++wrongly;
+        }
+        check("leave: only server 4's keys move", wrongly, 0);
+        auto [high, low] = spread(table);
+        cout << "leave: " << 100.0 * moved / keys << "% of keys moved, slots per server " << low << " to " << high
+             << " of the fair share" << endl;
+        check("leave: balanced within 1%", high < 1.01 && low > 0.99, 1);
+
+        // A full rebuild without server 4 moves more than server 4's keys
+        MaglevTable rebuilt;
+        rebuilt.build({1, 2, 3, 5, 6, 7, 8, 9, 10});
+        vector<int> fromScratch = lookups(rebuilt, keys);
+        int rebuiltMoved = 0;
+        for (int key = 0; key < keys; ++key) rebuiltMoved += fromScratch[key] != before[key];
+        cout << "leave with a full rebuild: " << 100.0 * rebuiltMoved / keys << "% of keys moved" << endl;
+        check("incremental leave moves no more keys than a rebuild", moved <= rebuiltMoved, 1);
+
+        table.add(11);
+        vector<int> afterJoin = lookups(table, keys);
+        moved = 0;
+        wrongly = 0;
+        for (int key = 0; key < keys; ++key) {
+            if (afterJoin[key] == afterLeave[key]) continue;
+            ++moved;
+            if (afterJoin[key] != 11) ++wrongly;
+        }
+        check("join: keys only move to the new server", wrongly, 0);
+        tie(high, low) = spread(table);
+        cout << "join: " << 100.0 * moved / keys << "% of keys moved, slots per server " << low << " to " << high
+             << " of the fair share" << endl;
+        check("join: new server gets about 1/10 of the keys", fabs(moved / (keys / 10.0) - 1.0) < 0.05, 1);
+        check("join: balanced within 1%", high < 1.01 && low > 0.99, 1);
+
+        // Many servers grow the table to keep 100 slots per server
+        MaglevTable large;
+        vector<int> ids;
+        for (int id = 1; id <= 1000; ++id) ids.push_back(id);
+        large.build(ids);
+        check("1000 servers: table grown", large.size() >= 100000, 1);
+        check("1000 servers: balanced within 1%", spread(large).first <= 1.01, 1);
+    }
+
+    // Through the load balancer: 4 servers with room for every task, 100 keys sent 4 times
+    {
+        GlobalClock clock(1.0, ClockMode::Virtual);
+        LoadBalancer lb(RoutingPolicyType::Maglev, "-");
+        lb.setClock(&clock);
+        vector<shared_ptr<ServerQueue>> servers;
+        for (int id = 1; id <= 4; ++id) {
+            servers.push_back(make_shared<ServerQueue>(id, 1.0, 1000, &clock, [&lb](pair<int, double> utilizationData) {
+                lb.trackUtil(utilizationData.first, utilizationData.second);
+            }, 1, "-"));
+        }
+        lb.setServers(servers);
+        int taskId = 0;
+        auto sendKeys = [&]() {
+            for (uint64_t key = 1; key <= 100; ++key) {
+                Task task = {++taskId, 1.0, 0.0};
+                task.key = key;
+                lb.sendTask(task);
+            }
+        };
+        for (int round = 0; round < 4; ++round) sendKeys();
+        AffinityStats stats = lb.getAffinityStats();
+        check("every key returns to its server", stats.sameServer, 300);
+        check("new keys", stats.newKeys, 100);
+
+        const auto& policy = dynamic_cast<const MaglevPolicy&>(lb.getPolicy());
+        auto keysOnServer2 = [&policy]() {
+            int count = 0;
+            for (uint64_t key = 1; key <= 100; ++key) count += policy.getTable().lookup(MaglevTable::hash(key)) == 2;
+            return count;
+        };
+        int onServer2 = keysOnServer2();
+        size_t queued = servers[1]->getQueueLength();
+        lb.removeServer(2);
+        sendKeys();
+        stats = lb.getAffinityStats();
+        check("leave: server 2's keys moved", stats.moved, onServer2);
+        check("leave: the others stayed", stats.sameServer, 300 + 100 - onServer2);
+        check("leave: no task for server 2", servers[1]->getQueueLength(), queued);
+        check("leave counted", policy.getStats().leaves, 1);
+
+        lb.addServer(servers[1]);
+        sendKeys();
+        check("join: only the keys now on server 2 moved", lb.getAffinityStats().moved - stats.moved, keysOnServer2());
+        check("join counted", policy.getStats().joins, 1);
+        long long tasks = 0;
+        for (const auto& server : servers) tasks += server->getTasksInSystem();
+        check("running total of tasks", lb.getServerLoad().tasksInSystem.load(), tasks);
+        check("running total of cores", lb.getServerLoad().cores.load(), 4);
+    }
+
+    // Affinity against load: 10 servers, 70% load, 10,000 keys with Zipf popularity (the hottest key is
+    // about 10% of the tasks at skew 1)
+    struct Variant {
+        string name;
+        RoutingPolicyType policy;
+        double loadBound;
+    };
+    const vector<Variant> variants = {{"LowestUtilization", RoutingPolicyType::LowestUtilization, 0.0},
+                                      {"JoinShortestQueue", RoutingPolicyType::JoinShortestQueue, 0.0},
+                                      {"Maglev", RoutingPolicyType::Maglev, 0.0},
+                                      {"Maglev bound 2", RoutingPolicyType::Maglev, 2.0},
+                                      {"Maglev bound 1.25", RoutingPolicyType::Maglev, 1.25}};
+    for (double skew : {0.0, 1.0}) {
+        cout << "Exponential service (mean 4 s), 70% load, keys Zipf " << skew << ", " << hours << " hours" << endl;
+        cout << setw(18) << "policy" << setw(10) << "hit rate" << setw(11) << "imbalance" << setw(10) << "p50"
+             << setw(10) << "p99" << setw(10) << "p99.9" << setw(10) << "shed" << endl;
+        double maglevP99 = 0.0, maglevImbalance = 0.0;
+        for (const Variant& variant : variants) {
+            SimulationConfig config;
+            config.seed = 3;
+            config.deterministic = true;
+            config.consoleEcho = false;
+            config.binaryTrace = false;
+            config.outputDir = "maglev_test/run";
+            config.numberOfServers = 10;
+            config.basePower = 10.0;
+            config.powerStep = 0.0;
+            config.baseQueueSize = 30;
+            config.queueSizeStep = 0;
+            config.arrivalProcess = ArrivalProcessType::Poisson;
+            config.interArrivalTime = config.averageServiceTime / config.basePower / config.numberOfServers / 0.7;
+            config.simulationDuration = hours * 3600;
+            config.keySpace = 10000;
+            config.keySkew = skew;
+            config.routingPolicy = variant.policy;
+            config.loadBound = variant.loadBound;
+            filesystem::remove_all(config.outputDir);
+            SimulationResult result = runSimulation(config);
+
+            const LatencyHistogram& delay = result.kpis.global.delayHistogram;
+            cout << setw(18) << variant.name << fixed << setprecision(2) << setw(9) << result.affinity.hitRate() * 100 << "%"
+                 << setw(11) << result.affinity.imbalance << setw(10) << delay.percentile(50) << setw(10)
+                 << delay.percentile(99) << setw(10) << delay.percentile(99.9) << setw(9)
+                 << 100.0 * result.admission.dropRate() << "%" << defaultfloat << endl;
+
+            string label = variant.name + " Zipf " + to_string(skew).substr(0, 3);
+            check(label + ": every task keyed", result.affinity.keyed, result.admission.dispatched);
+            check(label + ": no task refused by a full server", result.kpis.global.rejected, 0);
+            if (variant.policy == RoutingPolicyType::Maglev && variant.loadBound == 0.0) {
+                // Keys only move off a full queue, which the hottest key's server has under Zipf keys
+                if (skew == 0.0) check(label + ": keys never move", result.affinity.moved, 0);
+                maglevP99 = delay.percentile(99);
+                maglevImbalance = result.affinity.imbalance;
+            }
+            if (variant.loadBound == 1.25 && skew > 0.0) {
+                check(label + ": more even than plain Maglev", result.affinity.imbalance < maglevImbalance, 1);
+                check(label + ": lower p99 than plain Maglev", delay.percentile(99) < maglevP99, 1);
+            }
+        }
+    }
+
+    filesystem::remove_all("maglev_test");
+    return finishChecks();
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <random>
+#include <cmath>
+#include "SERVERQUEUE.h"
+
+using namespace std;
+
+// Drives one c-core ServerQueue with Poisson arrivals and exponential service in virtual time
+// and compares the measured waiting time and per-core utilization with M/M/c (Erlang C) theory.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/mmcTest.cpp -o mmcTest
+//   ./mmcTest [cores] [utilization]
+
+// Probability that an arrival has to wait (Erlang C), offered load a = lambda / mu
+double erlangC(int c, double a) {
+    double term = 1.0, sum = 1.0;  // a^k / k! for k = 0
+    for (int k = 1; k < c; ++k) {
+        term *= a / k;
+        sum += term;
+    }
+    double last = term * a / c;  // a^c / c!
+    double rho = a / c;
+    return last / (1.0 - rho) / (sum + last / (1.0 - rho));
+}
+
+int main(int argc, char const *argv[]) {
+    int cores = argc > 1 ? atoi(argv[1]) : 4;
+    double rho = argc > 2 ? atof(argv[2]) : 0.8;
+    const double mu = 1.0;  // Service rate per core (service time 1 s at power 1)
+    const double lambda = rho * cores * mu;
+    const double duration = 200000.0;
+
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+    GlobalClock clock(1.0, ClockMode::Virtual);
+    ServerQueue server(1, 1.0, 100000, &clock, nullptr, cores);
+    KpiEngine kpis(1);
+    server.setKpiEngine(&kpis);
+
+    mt19937 rng(12345);
+    exponential_distribution<double> interArrival(lambda);
+    exponential_distribution<double> serviceTime(mu);
+    int nextTaskId = 0;
+    function<void()> arrive = [&]() {
+        server.addTask(++nextTaskId, serviceTime(rng));
+        clock.scheduleEvent(clock.getCurrentTime() + interArrival(rng), GlobalClock::EventType::TaskArrival, arrive);
+    };
+    clock.scheduleEvent(interArrival(rng), GlobalClock::EventType::TaskArrival, arrive);
+    clock.runUntil(duration);
+    server.stopProcessing();
+
+    KpiSnapshot snapshot = kpis.snapshot(duration);
+    const ServerKpi& kpi = snapshot.servers.at(0);
+    double a = lambda / mu;
+    double expectedWait = erlangC(cores, a) / (cores * mu - lambda);
+    double expectedQueue = lambda * expectedWait;
+
+    cout << "M/M/" << cores << " at rho " << rho << ", " << kpi.completed << " tasks" << endl;
+    cout << "Mean wait:         " << kpi.waitTime.mean << " s (theory " << expectedWait << ")" << endl;
+    cout << "Mean queue length: " << kpi.averageQueueLength << " (theory " << expectedQueue << ")" << endl;
+    cout << "Utilization:       " << kpi.utilization << " (theory " << rho << ")" << endl;
+    vector<double> busyTimes = server.getCoreBusyTimes();
+    for (int core = 0; core < cores; ++core) {
+        cout << "Core " << core << " utilization: " << busyTimes[core] / duration << endl;
+    }
+
+    bool ok = fabs(kpi.waitTime.mean - expectedWait) <= 0.1 * expectedWait &&
+              fabs(kpi.utilization - rho) <= 0.02;
+    cout << (ok ? "PASS" : "FAIL") << ": within 10% of the Erlang C wait and 0.02 of the utilization" << endl;
+    return ok ? 0 : 1;
+}
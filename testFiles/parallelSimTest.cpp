@@ -0,0 +1,110 @@
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <filesystem>
+#include "Simulation.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Runs the same seeded scenarios with 1, 2 and 3 partitions under every routing policy and checks the
+// results and traces are bit-identical, then times a large server farm sequentially and with 1 to 8
+// partitions and prints the speedup.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/parallelSimTest.cpp -o parallelSimTest
+//   ./parallelSimTest [servers] [seconds]
+
+SimulationConfig baseConfig(const string& outputDir) {
+    SimulationConfig config;
+    config.seed = 11;
+    config.deterministic = true;
+    config.consoleEcho = false;
+    config.arrivalProcess = ArrivalProcessType::Poisson;
+    config.outputDir = outputDir;
+    return config;
+}
+
+int main(int argc, char const *argv[]) {
+    int farmSize = argc > 1 ? atoi(argv[1]) : 1000;
+    double farmSeconds = argc > 2 ? atof(argv[2]) : 300.0;
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+
+    // 12 mixed servers at about 90% load, so queues fill and the backlog is used
+    const vector<pair<string, RoutingPolicyType>> policies = {
+        {"LowestUtilization", RoutingPolicyType::LowestUtilization}, {"RoundRobin", RoutingPolicyType::RoundRobin},
+        {"WeightedRoundRobin", RoutingPolicyType::WeightedRoundRobin},
+        {"JoinShortestQueue", RoutingPolicyType::JoinShortestQueue},
+        {"PowerOfDChoices", RoutingPolicyType::PowerOfDChoices},
+        {"LeastExpectedWork", RoutingPolicyType::LeastExpectedWork}};
+    for (const auto& [name, policy] : policies) {
+        SimulationResult first;
+        for (int partitions = 1; partitions <= 3; ++partitions) {
+            SimulationConfig config = baseConfig("parallel_test/" + name + to_string(partitions));
+            config.serverPools = {ServerPool{6, 10.0, 5, 1}, ServerPool{4, 20.0, 10, 1}, ServerPool{2, 30.0, 10, 2}};
+            config.interArrivalTime = 0.2;
+            config.simulationDuration = 3600;
+            config.routingPolicy = policy;
+            config.partitions = partitions;
+            SimulationResult result = runSimulation(config);
+            if (partitions == 1) {
+                first = result;
+                cout << name << ": " << result.kpis.global.completed << " completed, " << result.kpis.global.rejected
+                     << " rejected by servers, delay " << result.kpis.global.delay.mean << " s" << endl;
+                continue;
+            }
+            string label = name + ", " + to_string(partitions) + " partitions";
+            check(label + ": same trace", result.traceDigest == first.traceDigest, 1);
+            check(label + ": same completed", result.kpis.global.completed, first.kpis.global.completed);
+            check(label + ": same mean delay", result.kpis.global.delay.mean, first.kpis.global.delay.mean);
+            check(label + ": same p99 delay", result.kpis.global.delayHistogram.percentile(99),
+                  first.kpis.global.delayHistogram.percentile(99));
+            check(label + ": same events", result.events, first.events);
+        }
+    }
+
+    // The delayed reports change the model only a little when the delay is short next to the service times
+    {
+        SimulationConfig sequential = baseConfig("parallel_test/sequential");
+        sequential.simulationDuration = 86400;
+        SimulationConfig partitioned = sequential;
+        partitioned.outputDir = "parallel_test/partitioned";
+        partitioned.partitions = 2;
+        SimulationResult before = runSimulation(sequential), after = runSimulation(partitioned);
+        cout << "Default servers for a day: mean delay " << before.kpis.global.delay.mean << " s sequential, "
+             << after.kpis.global.delay.mean << " s with 10 ms reports" << endl;
+        check("report delay: same tasks completed", fabs(after.kpis.global.completed - before.kpis.global.completed) <= 1, 1);
+        check("report delay: mean delay within 2%",
+              fabs(after.kpis.global.delay.mean / before.kpis.global.delay.mean - 1.0) < 0.02, 1);
+    }
+
+    // Speedup on a large farm at 80% load, power of two choices, no trace
+    {
+        cout << farmSize << " servers for " << farmSeconds << " simulation seconds, " << thread::hardware_concurrency()
+             << " hardware threads" << endl;
+        cout << setw(12) << "partitions" << setw(12) << "seconds" << setw(12) << "speedup" << setw(14) << "events" << endl;
+        double single = 0.0;
+        for (int partitions : {0, 1, 2, 4, 8}) {
+            SimulationConfig config = baseConfig("parallel_test/farm");
+            config.numberOfServers = farmSize;
+            config.powerStep = 0.0;
+            config.queueSizeStep = 0;
+            config.interArrivalTime = config.averageServiceTime / config.basePower / farmSize / 0.8;
+            config.simulationDuration = farmSeconds;
+            config.routingPolicy = RoutingPolicyType::PowerOfDChoices;
+            config.binaryTrace = false;
+            config.partitions = partitions;
+            filesystem::remove_all(config.outputDir);
+            auto start = chrono::steady_clock::now();
+            SimulationResult result = runSimulation(config);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (partitions == 1) single = seconds;
+            cout << setw(12) << (partitions == 0 ? "sequential" : to_string(partitions)) << setw(12) << fixed
+                 << setprecision(2) << seconds << setw(12) << (partitions > 0 ? single / seconds : 0.0) << setw(14)
+                 << result.events << defaultfloat << endl;
+        }
+    }
+
+    filesystem::remove_all("parallel_test");
+    return finishChecks();
+}
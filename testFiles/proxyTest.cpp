@@ -0,0 +1,184 @@
+#include <iostream>
+#include <cmath>
+#include "TcpProxy.h"
+#include "BackendServer.h"
+#include "LoadGenerator.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Starts BackendServers, a TcpProxy and the load generator on loopback (ephemeral ports) and checks that
+// answers come back intact, that the slow backend gets less work, that a dead backend is routed around,
+// and that every connection is closed once the load stops. Prints requests/s and p99 through the proxy.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/proxyTest.cpp -o proxyTest
+//   ./proxyTest [seconds]
+
+// Blocking loopback connection, -1 on failure
+int connectTo(uint16_t port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) return fd;
+    close(fd);
+    return -1;
+}
+
+int main(int argc, char const *argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+    Logger::instance().setConsoleEcho(false);
+
+    // A fast and a slow backend (6x the service time), large queues so nothing is rejected
+    BackendParameters fastParameters;
+    fastParameters.processingPower = 30.0;
+    fastParameters.queueSize = 1000;
+    BackendParameters slowParameters = fastParameters;
+    slowParameters.processingPower = 5.0;
+    BackendServer fast(fastParameters), slow(slowParameters);
+    check("backends started", fast.start(0) && slow.start(0), 1);
+
+    vector<BackendEndpoint> backends(2);
+    backends[0].port = fast.getPort();
+    backends[0].weight = fastParameters.processingPower;
+    backends[1].port = slow.getPort();
+    backends[1].weight = slowParameters.processingPower;
+
+    // Overhead: an instant backend, direct and through the proxy, over persistent connections
+    {
+        BackendParameters instantParameters = fastParameters;
+        instantParameters.timeScale = 0.0;
+        BackendServer instant(instantParameters);
+        instant.start(0);
+        vector<BackendEndpoint> single(1);
+        single[0].port = instant.getPort();
+        TcpProxy proxy(single, RoutingPolicyType::LowestUtilization, 1, "proxy_test_log.txt");
+        proxy.start(0, 1, "127.0.0.1");
+        LoadResult direct = LoadGenerator("127.0.0.1", instant.getPort()).run(4, seconds / 2);
+        LoadResult proxied = LoadGenerator("127.0.0.1", proxy.getPort()).run(4, seconds / 2);
+        cout << "Instant backend, 4 persistent connections: direct " << direct.requestsPerSecond() << " requests/s, p99 "
+             << direct.latency.percentile(99) * 1e3 << " ms; through the proxy " << proxied.requestsPerSecond()
+             << " requests/s, p99 " << proxied.latency.percentile(99) * 1e3 << " ms" << endl;
+        check("overhead: no errors", direct.errors + proxied.errors, 0);
+    }
+
+    {
+        TcpProxy proxy(backends, RoutingPolicyType::LowestUtilization, 1, "proxy_test_log.txt");
+        check("proxy started", proxy.start(0, 2, "127.0.0.1"), 1);
+        LoadResult result = LoadGenerator("127.0.0.1", proxy.getPort()).run(8, seconds, true);
+        cout << "Fast and slow backend, one connection per request: " << result.requestsPerSecond()
+             << " requests/s, p50 " << result.latency.percentile(50) * 1e3 << " ms, p99 "
+             << result.latency.percentile(99) * 1e3 << " ms" << endl;
+        check("proxy: answers intact (no errors)", result.errors, 0);
+        check("proxy: requests answered", result.requests > 100, 1);
+        BackendSnapshot fastStats = proxy.getBackendStats(0), slowStats = proxy.getBackendStats(1);
+        cout << "Responses: fast " << fastStats.responses << ", slow " << slowStats.responses << "; latency: fast "
+             << fastStats.latency * 1e3 << " ms, slow " << slowStats.latency * 1e3 << " ms" << endl;
+        check("proxy: slow backend gets less than a third", slowStats.responses * 3 < fastStats.responses + slowStats.responses, 1);
+        check("proxy: every exchange seen", fastStats.responses + slowStats.responses, result.requests + result.busy);
+
+        // Connections are released asynchronously after the clients close
+        for (int i = 0; i < 100 && proxy.getBackendStats(0).active + proxy.getBackendStats(1).active > 0; ++i) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        check("proxy: no connection left open", proxy.getBackendStats(0).active + proxy.getBackendStats(1).active, 0);
+    }
+
+    // Weighted round robin is shared by the event loops: over 4 loops the connections still split 30:5
+    {
+        TcpProxy proxy(backends, RoutingPolicyType::WeightedRoundRobin, 1, "proxy_test_log.txt");
+        proxy.start(0, 4, "127.0.0.1");
+        LoadResult result = LoadGenerator("127.0.0.1", proxy.getPort()).run(8, seconds / 2, true);
+        long long fastConnections = proxy.getBackendStats(0).connections, slowConnections = proxy.getBackendStats(1).connections;
+        cout << "Weighted round robin over 4 event loops: fast " << fastConnections << ", slow " << slowConnections
+             << " connections" << endl;
+        check("weighted: no errors", result.errors, 0);
+        check("weighted: 30:5 split within one round", llabs(fastConnections * 5 - slowConnections * 30) <= 35, 1);
+    }
+
+    // Large payload in both directions (the splice path, several pipe chunks per request), persistent connections
+    {
+        TcpProxy proxy(backends, RoutingPolicyType::RoundRobin, 1, "proxy_test_log.txt");
+        proxy.start(0, 1, "127.0.0.1");
+        int fd = connectTo(proxy.getPort());
+        check("large: connected", fd >= 0, 1);
+        string line(1 << 20, 'x');
+        line += '\n';
+        thread sender([&]() { send(fd, line.data(), line.size(), MSG_NOSIGNAL); });
+        string answer;
+        char buffer[65536];
+        while (answer.size() < line.size()) {
+            ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+            if (received <= 0) break;
+            answer.append(buffer, static_cast<size_t>(received));
+        }
+        sender.join();
+        close(fd);
+        check("large: 1 MB echoed intact", answer == line, 1);
+    }
+
+    // Half-close: the client sends its request and shuts down writing, the backend reads up to that FIN,
+    // answers 8 MiB and closes. Its FIN hangs up the proxy's backend socket (both directions shut) while
+    // most of the answer is still in the socket and the pipe, and all of it must reach the client.
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+        socklen_t length = sizeof(address);
+        bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        listen(listener, 1);
+        getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length);
+        const size_t answerSize = 8 << 20;
+        thread backend([&]() {
+            int fd = accept(listener, nullptr, nullptr);
+            char buffer[4096];
+            while (recv(fd, buffer, sizeof(buffer), 0) > 0) {}
+            string answer(answerSize, 'y');
+            for (size_t sent = 0; sent < answer.size();) {
+                ssize_t written = send(fd, answer.data() + sent, answer.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) break;
+                sent += static_cast<size_t>(written);
+            }
+            close(fd);
+        });
+        vector<BackendEndpoint> single(1);
+        single[0].port = ntohs(address.sin_port);
+        TcpProxy proxy(single, RoutingPolicyType::RoundRobin, 1, "proxy_test_log.txt");
+        proxy.start(0, 1, "127.0.0.1");
+        int fd = connectTo(proxy.getPort());
+        send(fd, "request\n", 8, MSG_NOSIGNAL);
+        shutdown(fd, SHUT_WR);
+        this_thread::sleep_for(chrono::milliseconds(100));  // Let the backend finish and hang up first
+        size_t received = 0;
+        char buffer[65536];
+        for (ssize_t bytes; (bytes = recv(fd, buffer, sizeof(buffer), 0)) > 0;) received += static_cast<size_t>(bytes);
+        backend.join();
+        close(fd);
+        close(listener);
+        check("half-close: whole answer after the backend hung up", received, answerSize);
+        for (int i = 0; i < 100 && proxy.getBackendStats(0).active > 0; ++i) this_thread::sleep_for(chrono::milliseconds(10));
+        check("half-close: connection released", proxy.getBackendStats(0).active, 0);
+    }
+
+    // A backend that is down: its connects fail and the clients land on the other one
+    {
+        vector<BackendEndpoint> withDead = backends;
+        BackendServer probe(fastParameters);
+        probe.start(0);
+        withDead[1].port = probe.getPort();
+        probe.stop();  // Nothing listens there any more
+        TcpProxy proxy(withDead, RoutingPolicyType::RoundRobin, 1, "proxy_test_log.txt");
+        proxy.start(0, 1, "127.0.0.1");
+        LoadResult result = LoadGenerator("127.0.0.1", proxy.getPort()).run(2, 0.2, true);
+        check("dead backend: no client errors", result.errors, 0);
+        check("dead backend: connects failed over", proxy.getBackendStats(1).failures >= 1, 1);
+        check("dead backend: nothing answered by it", proxy.getBackendStats(1).responses, 0);
+    }
+
+    fast.stop();
+    slow.stop();
+    Logger::instance().flush();
+    remove("proxy_test_log.txt");
+    return finishChecks();
+}
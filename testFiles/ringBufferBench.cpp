@@ -0,0 +1,87 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include <atomic>
+#include "RingBuffer.h"
+
+using namespace std;
+
+struct Task {
+    int taskID;
+    double serviceTime;
+    double arrivalTime;
+    double finishTime;
+};
+
+// Several producers push into one server's intake while a single worker drains it.
+// Compares the old mutex-protected std::queue with the lock-free RingBuffer.
+template <typename Push, typename Pop>
+double run(int producers, int tasksPerProducer, Push push, Pop pop) {
+    atomic<int> consumed{0};
+    int total = producers * tasksPerProducer;
+    auto start = chrono::steady_clock::now();
+
+    thread worker([&]() {
+        Task task;
+        while (consumed < total) {
+            if (pop(task)) {
+                ++consumed;
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+    vector<thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < tasksPerProducer; ++i) {
+                Task task{p * tasksPerProducer + i, 1.0, 0.0, 0.0};
+                while (!push(task)) {
+                    this_thread::yield();  // Queue full, retry
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    worker.join();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    return total / elapsed.count();
+}
+
+int main() {
+    const int queueSize = 1024;
+    const int tasksPerProducer = 200000;
+
+    for (int producers : {1, 2, 4, 8}) {
+        mutex queueMutex;
+        queue<Task> lockedQueue;
+        double locked = run(producers, tasksPerProducer,
+            [&](const Task& task) {
+                lock_guard<mutex> lock(queueMutex);
+                if (lockedQueue.size() >= queueSize) return false;
+                lockedQueue.push(task);
+                return true;
+            },
+            [&](Task& task) {
+                lock_guard<mutex> lock(queueMutex);
+                if (lockedQueue.empty()) return false;
+                task = lockedQueue.front();
+                lockedQueue.pop();
+                return true;
+            });
+
+        RingBuffer<Task> ring(queueSize);
+        double lockFree = run(producers, tasksPerProducer,
+            [&](const Task& task) { return ring.tryPush(task); },
+            [&](Task& task) { return ring.tryPop(task); });
+
+        cout << "Producers: " << producers
+             << ", Mutex queue: " << locked << " tasks/s"
+             << ", Ring buffer: " << lockFree << " tasks/s" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include "Simulation.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Checks the order each scheduling discipline serves a ServerQueue in, and that ShortestRemainingTime
+// suspends and resumes a long task, then prints per-class tail delay and missed deadlines for every
+// discipline on a mix of short interactive and long batch tasks.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/schedulingTest.cpp -o schedulingTest
+//   ./schedulingTest [hours]
+
+// One core at power 1: task 1 starts at once, the others wait and finish in the order the discipline picks
+vector<int> serviceOrder(SchedulingDiscipline discipline) {
+    GlobalClock clock(1.0, ClockMode::Virtual);
+    ServerQueue server(1, 1.0, 8, &clock, nullptr, 1, "-");
+    server.setSchedulingDiscipline(discipline);
+    vector<int> finished;
+    server.setCompletionCallback([&finished](int, int taskId) { finished.push_back(taskId); });
+    // (id, service time, priority, deadline)
+    const vector<tuple<int, double, int, double>> tasks = {
+        {1, 5.0, 9, 100.0}, {2, 4.0, 3, 60.0}, {3, 1.0, 7, 90.0}, {4, 3.0, 1, 70.0}, {5, 2.0, 3, 50.0}};
+    for (const auto& [id, service, priority, deadline] : tasks) {
+        TaskLabel label;
+        label.priority = priority;
+        label.deadline = deadline;
+        server.addTask(id, service, -1.0, label);
+        if (id == 1) clock.runUntil(0.5);
+    }
+    clock.runUntil(100.0);
+    return finished;
+}
+
+int main(int argc, char const *argv[]) {
+    double hours = argc > 1 ? atof(argv[1]) : 6.0;
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+
+    // The queue on its own
+    {
+        TaskScheduler<int> byPriority(SchedulingDiscipline::Priority);
+        byPriority.push(1, 0.0, 4);
+        byPriority.push(2, 0.0, 2);
+        byPriority.push(3, 0.0, 4);
+        byPriority.push(4, 0.0, 99);  // Clamped to the last level
+        vector<int> order;
+        for (int task; byPriority.pop(task);) order.push_back(task);
+        check("bucket queue: priority, then arrival", order == vector<int>({2, 1, 3, 4}), 1);
+
+        TaskScheduler<int> byKey(SchedulingDiscipline::ShortestJobFirst);
+        byKey.push(1, 3.0, 0);
+        byKey.push(2, 1.0, 0);
+        byKey.push(3, 3.0, 0);
+        byKey.push(4, 2.0, 0);
+        order.clear();
+        for (int task; byKey.pop(task);) order.push_back(task);
+        check("heap: smallest key, ties in arrival order", order == vector<int>({2, 4, 1, 3}), 1);
+        check("empty after popping", byKey.empty(), 1);
+    }
+
+    check("Fifo order", serviceOrder(SchedulingDiscipline::Fifo) == vector<int>({1, 2, 3, 4, 5}), 1);
+    check("Priority order", serviceOrder(SchedulingDiscipline::Priority) == vector<int>({1, 4, 2, 5, 3}), 1);
+    check("ShortestJobFirst order", serviceOrder(SchedulingDiscipline::ShortestJobFirst) == vector<int>({1, 3, 5, 4, 2}), 1);
+    check("EarliestDeadlineFirst order", serviceOrder(SchedulingDiscipline::EarliestDeadlineFirst) == vector<int>({1, 5, 2, 4, 3}), 1);
+    {
+        GlobalClock clock(1.0, ClockMode::RealTime);
+        ServerQueue server(1, 1.0, 8, &clock, nullptr, 1, "-");
+        check("real time stays FIFO", server.setSchedulingDiscipline(SchedulingDiscipline::Priority), 0);
+    }
+
+    // ShortestRemainingTime: a 10 s task at 0, a 2 s task at 1. The short one takes the core at 1 and
+    // finishes at 3; the long one resumes with 9 s left and finishes at 12.
+    {
+        GlobalClock clock(1.0, ClockMode::Virtual);
+        KpiEngine kpis(1, {"long", "short"});
+        ServerQueue server(1, 1.0, 4, &clock, nullptr, 1, "-");
+        server.setKpiEngine(&kpis);
+        check("ShortestRemainingTime in virtual time", server.setSchedulingDiscipline(SchedulingDiscipline::ShortestRemainingTime), 1);
+        vector<pair<int, double>> finished;
+        server.setCompletionCallback([&](int, int taskId) { finished.push_back({taskId, clock.getCurrentTime()}); });
+        TaskLabel longTask, shortTask;
+        shortTask.taskClass = 1;
+        server.addTask(1, 10.0, -1.0, longTask);
+        clock.runUntil(1.0);
+        server.addTask(2, 2.0, -1.0, shortTask);
+        clock.runUntil(30.0);
+        check("short task first", finished == vector<pair<int, double>>({{2, 3.0}, {1, 12.0}}), 1);
+        check("one suspension", server.getSuspendedTasks(), 1);
+        check("busy the whole time", server.getCoreBusyTimes()[0], 12.0);
+
+        KpiSnapshot snapshot = kpis.snapshot(30.0);
+        check("KPI suspended", snapshot.global.suspended, 1);
+        check("KPI completed", snapshot.global.completed, 2);
+        check("long task served its full 10 s", snapshot.classes[0].serviceTime.mean, 10.0);
+        check("long task waited once (0 s)", snapshot.classes[0].waitTime.mean, 0.0);
+        check("long task delay", snapshot.classes[0].delay.mean, 12.0);
+        check("short task delay", snapshot.classes[1].delay.mean, 2.0);
+        // Waiting: the long task from 1 to 3 while suspended
+        check("KPI queue length", fabs(snapshot.global.averageQueueLength - 2.0 / 30.0) < 1e-12, 1);
+    }
+
+    // Per-class tails: 90% interactive tasks (a quarter of the mean, deadline 5 s), 10% batch tasks
+    // (7.75 times the mean, no deadline); mean service 4 s at power 10, 10 servers, join shortest queue
+    vector<TaskClass> classes = {{"interactive", 0.9, 0.25, 0, 5.0}, {"batch", 0.1, 7.75, 1, 0.0}};
+    const vector<pair<string, SchedulingDiscipline>> disciplines = {
+        {"Fifo", SchedulingDiscipline::Fifo}, {"Priority", SchedulingDiscipline::Priority},
+        {"ShortestJobFirst", SchedulingDiscipline::ShortestJobFirst},
+        {"ShortestRemaining", SchedulingDiscipline::ShortestRemainingTime},
+        {"EarliestDeadline", SchedulingDiscipline::EarliestDeadlineFirst}};
+    for (double load : {0.7, 0.9}) {
+        cout << "Exponential service (mean 4 s), " << load * 100 << "% load, " << hours << " hours" << endl;
+        cout << setw(18) << "discipline" << setw(14) << "inter. p50" << setw(12) << "inter. p99" << setw(10) << "missed"
+             << setw(12) << "batch p50" << setw(12) << "batch p99" << setw(11) << "all p99" << setw(10) << "shed" << endl;
+        double fifoInteractiveP99 = 0.0;
+        for (const auto& [name, discipline] : disciplines) {
+            SimulationConfig config;
+            config.seed = 11;
+            config.deterministic = true;
+            config.consoleEcho = false;
+            config.binaryTrace = false;
+            config.outputDir = "scheduling_test/run";
+            config.numberOfServers = 10;
+            config.basePower = 10.0;
+            config.powerStep = 0.0;
+            config.baseQueueSize = 30;
+            config.queueSizeStep = 0;
+            config.arrivalProcess = ArrivalProcessType::Poisson;
+            config.interArrivalTime = config.averageServiceTime / config.basePower / config.numberOfServers / load;
+            config.simulationDuration = hours * 3600;
+            config.routingPolicy = RoutingPolicyType::JoinShortestQueue;
+            config.taskClasses = classes;
+            config.scheduling = discipline;
+            filesystem::remove_all(config.outputDir);
+            SimulationResult result = runSimulation(config);
+
+            const ServerKpi& interactive = result.kpis.classes[0];
+            const ServerKpi& batch = result.kpis.classes[1];
+            double interactiveP99 = interactive.delayHistogram.percentile(99);
+            if (discipline == SchedulingDiscipline::Fifo) fifoInteractiveP99 = interactiveP99;
+            cout << setw(18) << name << fixed << setprecision(2) << setw(14) << interactive.delayHistogram.percentile(50)
+                 << setw(12) << interactiveP99 << setw(9) << 100.0 * interactive.missedDeadlines / max(1LL, interactive.completed)
+                 << "%" << setw(12) << batch.delayHistogram.percentile(50) << setw(12) << batch.delayHistogram.percentile(99)
+                 << setw(11) << result.kpis.global.delayHistogram.percentile(99) << setw(9)
+                 << 100.0 * result.admission.dropRate() << "%" << defaultfloat << endl;
+
+            string label = name + " " + to_string(static_cast<int>(load * 100)) + "%";
+            check(label + ": classes add up to the total", interactive.completed + batch.completed, result.kpis.global.completed);
+            check(label + ": batch has no deadline to miss", batch.missedDeadlines, 0);
+            if (discipline == SchedulingDiscipline::Priority || discipline == SchedulingDiscipline::ShortestRemainingTime) {
+                check(label + ": lower interactive p99 than Fifo", interactiveP99 < fifoInteractiveP99, 1);
+            }
+            if (discipline != SchedulingDiscipline::ShortestRemainingTime) check(label + ": nothing suspended", result.kpis.global.suspended, 0);
+
+            // The class lines reach analyzer_results.txt after the server lines
+            ifstream results(outputPath(config, "analyzer_results.txt"));
+            string line, last;
+            int classLines = 0;
+            while (getline(results, line)) {
+                if (line.rfind("Class: ", 0) == 0) ++classLines;
+                last = line;
+            }
+            check(label + ": class lines in analyzer_results.txt", classLines, 2);
+            check(label + ": batch line last", last.rfind("Class: batch, Completed: " + to_string(batch.completed), 0) == 0, 1);
+        }
+    }
+
+    filesystem::remove_all("scheduling_test");
+    return finishChecks();
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+#include "TASKGENERATOR.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Replays small CSV, task_log.txt and binary traces and checks the tasks that come out, then streams
+// a large CSV to measure the replay rate and confirm the resident size stays below the file size.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/traceReplayTest.cpp -o traceReplayTest
+//   ./traceReplayTest [largeRecords]
+
+vector<ReplayTask> readAll(TraceReplay& replay, size_t limit = 1000) {
+    vector<ReplayTask> tasks;
+    ReplayTask task;
+    while (tasks.size() < limit && replay.next(task)) tasks.push_back(task);
+    return tasks;
+}
+
+long peakResidentKb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+int main(int argc, char const *argv[]) {
+    size_t largeRecords = argc > 1 ? strtoull(argv[1], nullptr, 10) : 8000000;
+    Logger::instance().setConsoleEcho(false);
+
+    // CSV with a header, a comment, a key column, CRLF line endings and epoch timestamps
+    ofstream("replay_test.csv") << "timestamp,key,cost\r\n# recorded 2024-01-01\r\n"
+                                << "1700000000.0,user42,2.5\r\n1700000001.5,user7,0.5\r\n\r\n1700000004.0,user42,1.0\r\n";
+    TraceReplay csv("replay_test.csv");
+    vector<ReplayTask> tasks = readAll(csv);
+    check("csv: format", static_cast<int>(csv.getFormat()), static_cast<int>(ReplayFormat::Csv));
+    check("csv: records", tasks.size(), 3);
+    check("csv: skipped header and comment", csv.getSkippedLines(), 2);
+    check("csv: times relative to the first", tasks.size() == 3 ? tasks[2].time : -1.0, 4.0);
+    check("csv: cost", tasks.size() == 3 ? tasks[1].serviceTime : -1.0, 0.5);
+    check("csv: same key, same hash", tasks.size() == 3 && tasks[0].key == tasks[2].key && tasks[0].key != 0, 1);
+    check("csv: different keys", tasks.size() == 3 && tasks[0].key != tasks[1].key, 1);
+
+    // 10x faster and looping: the second pass starts one average gap (2 s) after the first ends
+    TraceReplay fast("replay_test.csv", 10.0, true);
+    tasks = readAll(fast, 7);
+    check("scaled: third arrival", tasks[2].time, 0.4);
+    check("looped: first arrival of pass 2", tasks[3].time, 0.6);
+    check("looped: first arrival of pass 3", tasks[6].time, 1.2);
+    check("looped: completed passes", fast.getLoops(), 2);
+
+    // task_log.txt, including a line that is not a task
+    ofstream("replay_test_log.txt") << "[Time: 0.00] Task ID: 1, Service Time: 3.38 seconds\n"
+                                    << "Trace replay of something else\n"
+                                    << "[Time: 10.00] Task ID: 2, Service Time: 46.16 seconds\n";
+    TraceReplay log("replay_test_log.txt");
+    tasks = readAll(log);
+    check("task log: format", static_cast<int>(log.getFormat()), static_cast<int>(ReplayFormat::TaskLog));
+    check("task log: records", tasks.size(), 2);
+    check("task log: second arrival", tasks.size() == 2 ? tasks[1].time : -1.0, 10.0);
+    check("task log: second service time", tasks.size() == 2 ? tasks[1].serviceTime : -1.0, 46.16);
+    check("task log: no key", tasks.size() == 2 ? tasks[1].key : 1, 0);
+
+    // Binary trace: only TaskGenerated records are tasks
+    {
+        TraceWriter writer("replay_test.bin");
+        writer.record(makeTraceRecord(TraceEventType::TaskGenerated, 5.0, 1, 0, 7.25));
+        writer.record(makeTraceRecord(TraceEventType::TaskAssigned, 5.0, 1, 2));
+        writer.record(makeTraceRecord(TraceEventType::TaskGenerated, 8.0, 2, 0, 1.75));
+    }
+    TraceReplay binary("replay_test.bin");
+    tasks = readAll(binary);
+    check("binary: format", static_cast<int>(binary.getFormat()), static_cast<int>(ReplayFormat::BinaryTrace));
+    check("binary: records", tasks.size(), 2);
+    check("binary: exact service time", tasks.size() == 2 ? tasks[0].serviceTime : -1.0, 7.25);
+    check("binary: second arrival", tasks.size() == 2 ? tasks[1].time : -1.0, 3.0);
+
+    check("missing file", TraceReplay("replay_test_missing.csv").isOpen(), 0);
+
+    // Through TaskGenerator in virtual time: arrivals at the recorded times, then nothing more
+    {
+        GlobalClock clock(1.0, ClockMode::Virtual);
+        TaskGenerator generator(40.0, "replay_test_task_log.txt", &clock);
+        vector<pair<double, double>> arrivals;
+        vector<uint64_t> keys;
+        generator.start(make_unique<TraceReplay>("replay_test.csv"), [&](pair<int, double> task) {
+            arrivals.emplace_back(clock.getCurrentTime(), task.second);
+            keys.push_back(generator.getLastTaskKey());
+        });
+        clock.runUntil(100.0);
+        generator.stop();
+        check("generator: tasks", arrivals.size(), 3);
+        check("generator: last arrival time", arrivals.empty() ? -1.0 : arrivals.back().first, 4.0);
+        check("generator: last service time", arrivals.empty() ? -1.0 : arrivals.back().second, 1.0);
+        check("generator: recorded keys", keys.size() == 3 && keys[0] == keys[2] && keys[0] != keys[1], 1);
+    }
+
+    // Large trace: streamed, not loaded
+    {
+        FILE* file = fopen("replay_test_large.csv", "w");
+        for (size_t i = 0; i < largeRecords; ++i) {
+            fprintf(file, "%.6f,key%zu,%.4f\n", i * 0.01, i % 1000, 0.5 + (i % 7) * 0.1);
+        }
+        fclose(file);
+        size_t fileKb = 0;
+        {
+            ifstream size("replay_test_large.csv", ios::binary | ios::ate);
+            fileKb = static_cast<size_t>(size.tellg()) / 1024;
+        }
+        long before = peakResidentKb();
+        auto start = chrono::steady_clock::now();
+        TraceReplay large("replay_test_large.csv");
+        ReplayTask task;
+        while (large.next(task)) {
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long grown = peakResidentKb() - before;
+        cout << "Streamed " << large.getRecords() << " records (" << fileKb / 1024 << " MB) in " << seconds << " s: "
+             << large.getRecords() / seconds / 1e6 << " M records/s, peak resident size grew by " << grown / 1024
+             << " MB" << endl;
+        check("large: records", large.getRecords(), largeRecords);
+        check("large: resident size below the file size", fileKb < 128 * 1024 || static_cast<size_t>(grown) < fileKb, 1);
+    }
+
+    for (const char* path : {"replay_test.csv", "replay_test_log.txt", "replay_test.bin", "replay_test_task_log.txt",
+                             "replay_test_large.csv"}) {
+        remove(path);
+    }
+    return finishChecks();
+}
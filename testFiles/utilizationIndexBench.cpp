@@ -0,0 +1,54 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <map>
+#include "UtilizationIndex.h"
+
+using namespace std;
+
+// Decisions per second for the old linear map scan vs the indexed heap.
+// Each decision picks the least utilized server and then updates its utilization.
+int main() {
+    mt19937 rng(42);
+    uniform_real_distribution<double> util(0.0, 1.0);
+    const int decisions = 200000;
+
+    for (int servers : {3, 10, 100, 1000, 10000, 100000}) {
+        map<int, double> utilizationMap;
+        UtilizationIndex index;
+        for (int id = 1; id <= servers; ++id) {
+            double u = util(rng);
+            utilizationMap[id] = u;
+            index.update(id, u);
+        }
+
+        int mapDecisions = servers >= 10000 ? decisions / 100 : decisions;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < mapDecisions; ++i) {
+            int bestServer = -1;
+            double minUtilization = 1e9;
+            for (const auto& [serverId, u] : utilizationMap) {
+                if (u < minUtilization) {
+                    minUtilization = u;
+                    bestServer = serverId;
+                }
+            }
+            utilizationMap[bestServer] = minUtilization + util(rng);
+        }
+        chrono::duration<double> mapElapsed = chrono::steady_clock::now() - start;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < decisions; ++i) {
+            int bestServer = -1;
+            double minUtilization = 0.0;
+            index.best(bestServer, minUtilization);
+            index.update(bestServer, minUtilization + util(rng));
+        }
+        chrono::duration<double> heapElapsed = chrono::steady_clock::now() - start;
+
+        cout << "Servers: " << servers
+             << ", Map scan: " << mapDecisions / mapElapsed.count() << " decisions/s"
+             << ", Indexed heap: " << decisions / heapElapsed.count() << " decisions/s" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <random>
+#include <algorithm>
+#include "LoadBalancer.h"
+
+using namespace std;
+
+// Round robin spreads Poisson arrivals evenly over servers of unequal power, so the slow
+// servers queue while the fast ones sit idle. Runs the same seeded arrivals with work stealing
+// off and on and compares end-to-end delay and how evenly the servers are used.
+//   g++ -std=c++17 -O2 -pthread -Isrc testFiles/workStealingBench.cpp -o workStealingBench
+//   ./workStealingBench [utilization]
+
+struct BenchResult {
+    double delayMean, delayP99, waitP99, utilizationSpread;
+    long long completed, stolen;
+};
+
+BenchResult run(bool stealing, double rho) {
+    const double powers[] = {10.0, 20.0, 40.0};
+    const double averageWork = 20.0;  // Service time at power 1
+    const double duration = 50000.0;
+    double totalPower = 0.0;
+    for (double power : powers) totalPower += power;
+    const double lambda = rho * totalPower / averageWork;
+
+    Logger::instance().setConsoleEcho(false);
+    Logger::instance().setLevel(LogLevel::Warning);
+    GlobalClock clock(1.0, ClockMode::Virtual);
+    LoadBalancer lb(RoutingPolicyType::RoundRobin);
+    lb.setClock(&clock);
+    vector<shared_ptr<ServerQueue>> servers;
+    for (int i = 0; i < 3; ++i) {
+        servers.push_back(make_shared<ServerQueue>(i + 1, powers[i], 100000, &clock,
+            [&lb](pair<int, double> utilizationData) {
+                lb.trackUtil(utilizationData.first, utilizationData.second);
+            }));
+    }
+    lb.setServers(servers);
+    KpiEngine kpis(3);
+    for (auto& server : servers) {
+        server->setKpiEngine(&kpis);
+        if (stealing) server->enableWorkStealing(servers);
+    }
+
+    mt19937 rng(2024);
+    exponential_distribution<double> interArrival(lambda);
+    exponential_distribution<double> work(1.0 / averageWork);
+    int nextTaskId = 0;
+    function<void()> arrive = [&]() {
+        Task task = {++nextTaskId, work(rng), clock.getCurrentTime()};
+        lb.sendTask(task);
+        clock.scheduleEvent(clock.getCurrentTime() + interArrival(rng), GlobalClock::EventType::TaskArrival, arrive);
+    };
+    clock.scheduleEvent(interArrival(rng), GlobalClock::EventType::TaskArrival, arrive);
+    clock.runUntil(duration);
+
+    BenchResult result{};
+    for (auto& server : servers) {
+        server->stopProcessing();
+        result.stolen += server->getStolenTasks();
+    }
+    KpiSnapshot snapshot = kpis.snapshot(duration);
+    double lowest = 1.0, highest = 0.0;
+    for (const ServerKpi& kpi : snapshot.servers) {
+        lowest = min(lowest, kpi.utilization);
+        highest = max(highest, kpi.utilization);
+    }
+    result.delayMean = snapshot.global.delay.mean;
+    result.delayP99 = snapshot.global.delayHistogram.percentile(99);
+    result.waitP99 = snapshot.global.waitHistogram.percentile(99);
+    result.utilizationSpread = highest - lowest;
+    result.completed = snapshot.global.completed;
+    return result;
+}
+
+int main(int argc, char const *argv[]) {
+    double rho = argc > 1 ? atof(argv[1]) : 0.6;
+    cout << "Round robin over servers of power 10/20/40 at utilization " << rho << endl;
+    for (bool stealing : {false, true}) {
+        BenchResult r = run(stealing, rho);
+        cout << (stealing ? "Stealing on:  " : "Stealing off: ")
+             << "completed " << r.completed << ", stolen " << r.stolen
+             << ", delay mean " << r.delayMean << " s p99 " << r.delayP99
+             << " s, wait p99 " << r.waitP99
+             << " s, utilization spread " << r.utilizationSpread * 100 << "%" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "Workload.h"
+#include "TestCheck.h"
+
+using namespace std;
+
+// Draws many samples from each arrival process and service distribution and checks the
+// measured rates, means and medians against their closed forms.
+//   g++ -std=c++17 -O2 -Isrc testFiles/workloadTest.cpp -o workloadTest
+
+// Arrivals per second over `duration` simulated seconds
+double measureRate(ArrivalProcess& process, double duration, mt19937& rng) {
+    double now = 0.0;
+    long long arrivals = 0;
+    while (true) {
+        now += process.nextInterArrival(now, rng);
+        if (now > duration) break;
+        ++arrivals;
+    }
+    return arrivals / duration;
+}
+
+double sampleMean(ServiceTimeDistribution& distribution, int samples, mt19937& rng, double* median = nullptr) {
+    vector<double> values(samples);
+    double sum = 0.0;
+    for (double& value : values) {
+        value = distribution.sample(rng);
+        sum += value;
+    }
+    if (median) {
+        nth_element(values.begin(), values.begin() + samples / 2, values.end());
+        *median = values[samples / 2];
+    }
+    return sum / samples;
+}
+
+int main() {
+    mt19937 rng(2024);
+
+    DeterministicArrivals fixed(2.0);
+    check("deterministic rate", measureRate(fixed, 1e5, rng), 0.5, 0.001);
+
+    PoissonArrivals poisson(2.0);
+    check("poisson rate", measureRate(poisson, 1e6, rng), 0.5, 0.01);
+
+    // Bursts at 4x the rate, 100 s long, every 900 s on average: 0.9 * 0.5 + 0.1 * 2.0 = 0.65 per second
+    MmppArrivals mmpp(2.0, 4.0, 100.0, 900.0);
+    check("mmpp average rate (closed form)", mmpp.averageRate(), 0.65, 1e-9);
+    check("mmpp rate", measureRate(mmpp, 2e7, rng), 0.65, 0.02);
+
+    // Rate multiplier 0.5 -> 1.5 -> 0.5 over a 1000 s period averages 1.0
+    DiurnalArrivals diurnal(2.0, 1000.0, {{0.0, 0.5}, {500.0, 1.5}});
+    check("diurnal multiplier at 250 s", diurnal.multiplier(250.0), 1.0, 1e-9);
+    check("diurnal multiplier at 750 s (wraps)", diurnal.multiplier(1750.0), 1.0, 1e-9);
+    check("diurnal rate", measureRate(diurnal, 1e6, rng), 0.5, 0.01);
+    double peakArrivals = 0.0, troughArrivals = 0.0;
+    for (double now = 0.0; now < 1e6;) {
+        now += diurnal.nextInterArrival(now, rng);
+        double phase = fmod(now, 1000.0);
+        if (phase >= 400.0 && phase < 600.0) ++peakArrivals;
+        if (phase < 100.0 || phase >= 900.0) ++troughArrivals;
+    }
+    // Mean multiplier is 1.4 around the peak and 0.6 around the trough
+    check("diurnal peak / trough", peakArrivals / troughArrivals, 1.4 / 0.6, 0.03);
+
+    const int samples = 2000000;
+    ExponentialService exponential(40.0);
+    check("exponential mean", sampleMean(exponential, samples, rng), 40.0, 0.01);
+
+    DeterministicService deterministic(40.0);
+    check("deterministic service", sampleMean(deterministic, 10, rng), 40.0, 1e-12);
+
+    double median = 0.0;
+    ParetoService pareto(40.0, 3.0);
+    check("pareto (shape 3) mean", sampleMean(pareto, samples, rng, &median), 40.0, 0.02);
+    check("pareto (shape 3) median", median, 40.0 * 2.0 / 3.0 * pow(2.0, 1.0 / 3.0), 0.01);
+    ParetoService heavyPareto(40.0, 1.5);
+    sampleMean(heavyPareto, samples, rng, &median);  // Infinite variance: the sample mean converges too slowly to test
+    check("pareto (shape 1.5) median", median, 40.0 / 3.0 * pow(2.0, 1.0 / 1.5), 0.01);
+
+    LogNormalService logNormal(40.0, 1.0);
+    check("lognormal mean", sampleMean(logNormal, samples, rng, &median), 40.0, 0.02);
+    check("lognormal median", median, 40.0 * exp(-0.5), 0.01);
+
+    return finishChecks();
+}